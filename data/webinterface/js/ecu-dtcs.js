@@ -0,0 +1,50 @@
+// Polled while the ECU is read, which takes a few hundred ms in an idle slot of the K-Line
+const DTC_REFRESH_POLL_MS = 500;
+
+function requestDtcs() {
+    if (websocket && websocket.readyState === WebSocket.OPEN) {
+        websocket.send("fetch-dtcs");
+    }
+}
+
+function requestDtcRefresh() {
+    if (websocket && websocket.readyState === WebSocket.OPEN) {
+        websocket.send("refresh-dtcs");
+    }
+}
+
+function responseDtcs(json) {
+    const dtcs = json.dtcs;
+
+    let summary;
+    if (dtcs.ageMs < 0) {
+        summary = dtcs.refreshing ? "Reading..." : "Not read yet"
+    }
+    else {
+        summary = dtcs.count + " fault codes, read " + Math.round(dtcs.ageMs / 1000) + " s ago"
+        if (dtcs.failed) {
+            summary += " (last read failed)"
+        }
+        if (dtcs.refreshing) {
+            summary += ", reading..."
+        }
+    }
+    document.getElementById("dtc-summary").innerText = summary
+
+    const body = document.getElementById("dtc-list");
+    body.innerHTML = ""
+    for (const dtc of dtcs.dtcs) {
+        const row = document.createElement("tr")
+        row.innerHTML = "<td>" + dtc.code + "</td>"
+            + "<td>0x" + dtc.status.toString(16).toUpperCase().padStart(2, "0") + "</td>"
+        body.appendChild(row)
+    }
+
+    if (dtcs.refreshing) {
+        setTimeout(requestDtcs, DTC_REFRESH_POLL_MS)
+    }
+}
+
+window.addEventListener('load', () => {
+    document.getElementById("dtc-refresh-btn").addEventListener('click', requestDtcRefresh)
+});
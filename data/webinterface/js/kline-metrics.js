@@ -0,0 +1,46 @@
+const KLINE_METRICS_INTERVAL_MS = 2000;
+
+function requestKLineMetrics() {
+    if (websocket && websocket.readyState === WebSocket.OPEN) {
+        websocket.send("fetch-kline-metrics");
+    }
+}
+
+function formatLatency(latency) {
+    return (latency.avg / 1000).toFixed(1) + " / " + (latency.p95 / 1000).toFixed(1) + " / "
+        + (latency.max / 1000).toFixed(1) + " ms"
+}
+
+function formatSession(session) {
+    const state = session.active ? "up for " + Math.round(session.uptimeMs / 1000) + " s" : "down"
+    return "Session " + state + ", " + session.drops + " drops, last reconnect "
+        + (session.lastReconnectUs / 1000).toFixed(0) + " ms (max " + (session.maxReconnectUs / 1000).toFixed(0)
+        + " ms), " + session.keepAlives + " keep-alives"
+}
+
+function responseKLineMetrics(json) {
+    const metrics = json.metrics;
+    const total = metrics.total;
+
+    document.getElementById("kline-summary").innerHTML =
+        metrics.responsesPerSecond.toFixed(1) + " responses/s, line " + metrics.lineUtilization.toFixed(1)
+        + " % busy (" + metrics.wireUtilization.toFixed(1) + " % on the wire)<br>"
+        + total.requests + " requests, " + total.timeouts + " timeouts, " + total.negative + " negative, "
+        + metrics.checksumErrors + " checksum errors, " + metrics.droppedFrames + " dropped frames<br>"
+        + "Latency avg / p95 / max: " + formatLatency(total.latencyUs) + "<br>"
+        + formatSession(metrics.session)
+
+    const body = document.getElementById("kline-pids");
+    body.innerHTML = ""
+    for (const pid of metrics.pids) {
+        const row = document.createElement("tr")
+        row.innerHTML = "<td>0x" + pid.pid.toString(16).toUpperCase() + "</td>"
+            + "<td>" + pid.requests + "</td>"
+            + "<td>" + pid.timeouts + "</td>"
+            + "<td>" + pid.negative + "</td>"
+            + "<td>" + formatLatency(pid.latencyUs) + "</td>"
+        body.appendChild(row)
+    }
+}
+
+window.addEventListener('load', () => setInterval(requestKLineMetrics, KLINE_METRICS_INTERVAL_MS));
@@ -1,16 +1,56 @@
 const gateway = `ws://${window.location.hostname}/ws`;
 let websocket;
 
+// Layout of the binary sensor update, see SensorUpdateFrame.hpp
+const WS_BINARY_SENSOR_UPDATE = 0x01;
+const SENSOR_UPDATE_HEADER_LENGTH = 6;
+const SENSOR_UPDATE_SAMPLE_LENGTH = 8;
+const SENSOR_UPDATE_VALUE_SCALE = 1000;
+
+function decodeBinaryMessage(buffer) {
+    const view = new DataView(buffer);
+    if (view.byteLength < SENSOR_UPDATE_HEADER_LENGTH || view.getUint8(0) !== WS_BINARY_SENSOR_UPDATE) {
+        return
+    }
+
+    const receivedAt = new Date().getTime();
+    const count = view.getUint8(1);
+
+    // Plot at the time the ECU answered, not when the update arrived
+    for (let i = 0; i < count; i++) {
+        const offset = SENSOR_UPDATE_HEADER_LENGTH + i * SENSOR_UPDATE_SAMPLE_LENGTH;
+        if (offset + SENSOR_UPDATE_SAMPLE_LENGTH > view.byteLength) {
+            break
+        }
+
+        const series = sensorSeriesMap[view.getUint16(offset, true)];
+        if (series) {
+            const ageMs = view.getUint16(offset + 2, true);
+            series.append(receivedAt - ageMs, view.getInt32(offset + 4, true) / SENSOR_UPDATE_VALUE_SCALE);
+        }
+    }
+}
+
 function initWebSocket() {
     console.log('Trying to establish a connection with the ESP32 using a Websocket...');
 
     websocket = new WebSocket(gateway);
+    websocket.binaryType = "arraybuffer";
     websocket.onopen = (event) => {
         console.log("Websocket connection established")
+
+        // Sensor updates as binary frames, the board keeps sending JSON if it doesn't know the protocol
+        websocket.send("protocol:binary")
         requestFetchSensors()
+        requestDtcs()
     }
 
     websocket.onmessage = (event) => {
+        if (event.data instanceof ArrayBuffer) {
+            decodeBinaryMessage(event.data)
+            return
+        }
+
         console.log('Received message from ESP32: %s', event.data)
         const json = JSON.parse(event.data)
         if(json == null) {
@@ -22,13 +62,30 @@ function initWebSocket() {
             responseFetchSensors(json)
         }
 
+        else if(json.type === "protocol") {
+            console.log("Sensor updates are sent as " + json.protocol)
+        }
+
+        else if(json.type === "kline-metrics") {
+            responseKLineMetrics(json)
+        }
+
+        else if(json.type === "dtcs") {
+            responseDtcs(json)
+        }
+
+        else if(json.type === "error") {
+            console.error("ESP32 reported an error: " + json.message)
+        }
+
         else if(json.type === "update-sensors") {
-            const timestamp = new Date().getTime();
+            const receivedAt = new Date().getTime();
 
+            // Plot at the time the ECU answered, not when the update arrived
             json.sensors.forEach(sensor => {
                 const series = sensorSeriesMap[sensor.id];
                 if (series) {
-                    series.append(timestamp, parseFloat(sensor.value));
+                    series.append(receivedAt - (json.now - sensor.t), parseFloat(sensor.value));
                 }
             });
         }
@@ -3,12 +3,15 @@
 // Project includes
 #include "Can.hpp"
 #include "Config.hpp"
+#include "Driver/AdcManager.hpp"
 #include "Driver/Display.hpp"
+#include "Driver/EcuDtcReader.hpp"
+#include "Driver/EcuPollScheduler.hpp"
+#include "Driver/EcuValueCache.hpp"
+#include "Driver/KLine.hpp"
+#include "Sensor/SignalStore.hpp"
 #include "Wifi.hpp"
 
-// espidf includes
-#include "esp_adc/adc_oneshot.h"
-
 // Circular inclusion
 class WebInterface;
 
@@ -33,7 +36,9 @@ public:
 
 	std::vector<Display>* getDisplays();
 
-	adc_oneshot_unit_handle_t* getAdc();
+	AdcManager* getAdc();
+
+	SignalStore* getSignalStore();
 
 	ArduinoJson::JsonDocument* getConfig() const;
 
@@ -52,6 +57,17 @@ public:
 	 */
 	Can* getCan() const;
 
+	/*
+	 *	ECU related functions
+	 */
+	KLine* getKLine() const;
+
+	EcuPollScheduler* getEcuPollScheduler() const;
+
+	EcuValueCache* getEcuValueCache() const;
+
+	EcuDtcReader* getEcuDtcReader() const;
+
 private:
 	/*
 	 *	Instances
@@ -60,6 +76,14 @@ private:
 
 	Can* can_ = nullptr;
 
+	KLine* kline_ = nullptr;
+
+	EcuPollScheduler* ecuPollScheduler_ = nullptr;
+
+	EcuValueCache* ecuValueCache_ = nullptr;
+
+	EcuDtcReader* ecuDtcReader_ = nullptr;
+
 	Wifi* wifi_ = nullptr;
 
 	WebInterface* webInterface_ = nullptr;
@@ -81,7 +105,9 @@ private:
 		Display(GPIO_DISPLAY3, CAN_MASTER_ID + 3, 2, false),
 	};
 
-	adc_oneshot_unit_handle_t adc1Handle_;
+	AdcManager adc_;
+
+	SignalStore signalStore_;
 
 	Filesystem* filesystem_ = nullptr;
 
@@ -0,0 +1,101 @@
+#pragma once
+
+// C++ includes
+#include <array>
+
+// espidf includes
+#include "driver/gpio.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "esp_adc/adc_oneshot.h"
+
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_ADC_CHANNELS = 16;
+
+/*
+ *	Class
+ */
+// Owns both ADC units. The unit and channel of a sensor are resolved from its GPIO, so moving a sensor to ADC1 is
+// only a change of the GPIO in the config.
+// ADC2 is shared with the Wi-Fi radio which has priority in the arbiter. Conversions that lose the arbitration are
+// retried in short intervals for a bounded time instead of failing silently or blocking the caller.
+class AdcManager
+{
+public:
+	/*
+	 *	Public Struct
+	 */
+	struct ChannelStats
+	{
+		uint32_t reads = 0;
+
+		// Conversions that failed, of which wifiConflicts lost the arbitration against Wi-Fi at least once
+		uint32_t failures = 0;
+		uint32_t wifiConflicts = 0;
+
+		// Duration of a complete read including the retries
+		uint32_t lastLatencyUs = 0;
+		uint32_t maxLatencyUs = 0;
+
+		esp_err_t lastError = ESP_OK;
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	AdcManager() = default;
+
+	~AdcManager();
+
+	bool init();
+
+	// Configures the channel of the GPIO on the unit it belongs to. Returns the id of the channel or -1
+	int8_t addChannel(gpio_num_t gpio, adc_atten_t atten = ADC_ATTEN_DB_12);
+
+	// Averages the successful ones of the conversions and converts the result into mV
+	esp_err_t readMv(int8_t id, uint8_t conversions, int& mv);
+
+	adc_unit_t getUnit(int8_t id) const;
+
+	adc_channel_t getChannel(int8_t id) const;
+
+	gpio_num_t getGpio(int8_t id) const;
+
+	// Only a diagnostic copy, it's not synchronized with the reading task
+	ChannelStats getStats(int8_t id) const;
+
+	uint8_t getChannelCount() const;
+
+	void logStats() const;
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	struct Channel
+	{
+		gpio_num_t gpio = GPIO_NUM_NC;
+		adc_unit_t unit = ADC_UNIT_1;
+		adc_channel_t channel = ADC_CHANNEL_0;
+
+		adc_cali_handle_t calibration = nullptr;
+
+		ChannelStats stats;
+	};
+
+	/*
+	 *	Private Functions
+	 */
+	esp_err_t convert(Channel& channel, int& raw, bool& wifiConflict) const;
+
+	bool isValid(int8_t id) const;
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<adc_oneshot_unit_handle_t, 2> units_ = {};
+
+	std::array<Channel, MAX_ADC_CHANNELS> channels_ = {};
+	uint8_t channelCount_ = 0;
+};
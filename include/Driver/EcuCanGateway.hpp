@@ -0,0 +1,123 @@
+#pragma once
+
+// Project includes
+#include "Can.hpp"
+#include "Driver/EcuDtcReader.hpp"
+#include "Driver/EcuPollScheduler.hpp"
+#include "Driver/EcuSensors.hpp"
+#include "Driver/EcuValueCache.hpp"
+
+// Libraries
+#include "ArduinoJson.h"
+
+// C++ includes
+#include <array>
+
+// espidf includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_GATEWAY_FRAMES = 8;
+constexpr uint8_t MAX_GATEWAY_SIGNALS = 8;
+
+// Fault codes sent in the DTC frame after the count
+constexpr uint8_t MAX_GATEWAY_DTCS = 3;
+
+/*
+ *	Public Struct
+ */
+// Placement of one ECU signal in a CAN frame. The physical value is sent as round(value * factor + offset), clamped
+// to the range of the field and big endian
+struct EcuGatewaySignal
+{
+	const EcuSensor* sensor;
+
+	uint8_t byte;
+	uint8_t length;
+
+	float factor;
+	float offset;
+};
+
+struct EcuGatewayFrame
+{
+	// Function of the frame within the sensor group
+	uint8_t function;
+
+	uint32_t periodUs;
+
+	std::array<EcuGatewaySignal, MAX_GATEWAY_SIGNALS> signals;
+	uint8_t signalCount;
+	uint8_t dataLength;
+};
+
+/*
+ *	Class
+ */
+// Publishes selected ECU signals on the CAN bus, so the displays see them as well. The PIDs are polled through the
+// scheduler with a low priority, so they only use the K-Line while no PID of the web interface is due. Every frame is
+// sent with its own period, built from the cached values, and skipped while one of its values isn't fresh. An optional
+// DTC frame holds the number of cached fault codes followed by the first of them
+class EcuCanGateway
+{
+public:
+	EcuCanGateway() = default;
+
+	~EcuCanGateway();
+
+	// Compiles the "Gateway" section of the config into the frame table
+	void compile(const ArduinoJson::JsonDocument* config);
+
+	// Subscribes the PIDs and starts publishing. Does nothing without frames
+	void start(Can* can, EcuPollScheduler* scheduler, const EcuValueCache* cache,
+	           const EcuDtcReader* dtcReader = nullptr);
+
+	void stop();
+
+	uint8_t getFrameCount() const;
+
+	/*
+	 *	Private Tasks
+	 */
+	void publishTask();
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	bool compileFrame(ArduinoJson::JsonObjectConst entry, EcuGatewayFrame& frame) const;
+
+	// Returns false if a value of the frame isn't fresh
+	bool buildFrame(const EcuGatewayFrame& gatewayFrame, int64_t nowUs, Can::Frame& frame) const;
+
+	// Returns false while the fault codes were never read
+	bool buildDtcFrame(Can::Frame& frame) const;
+
+	void subscribe() const;
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<EcuGatewayFrame, MAX_GATEWAY_FRAMES> frames_ = {};
+	std::array<int64_t, MAX_GATEWAY_FRAMES> nextSendUs_ = {};
+	uint8_t frameCount_ = 0;
+
+	Can* can_ = nullptr;
+
+	EcuPollScheduler* scheduler_ = nullptr;
+
+	const EcuValueCache* cache_ = nullptr;
+
+	// DTC frame, disabled with function 0
+	const EcuDtcReader* dtcReader_ = nullptr;
+	uint8_t dtcFunction_ = 0;
+	uint32_t dtcPeriodUs_ = 0;
+	int64_t nextDtcSendUs_ = 0;
+
+	int8_t subscriber_ = -1;
+
+	TaskHandle_t publishTaskHandle_ = nullptr;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+// Project includes
+#include "Driver/EcuPollScheduler.hpp"
+
+// C++ includes
+#include <array>
+#include <string>
+
+// espidf includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_ECU_DTCS = 16;
+
+// "P0123" and the terminator
+constexpr uint8_t ECU_DTC_STRING_LENGTH = 6;
+
+/*
+ *	Public Struct
+ */
+struct EcuDtc
+{
+	// The upper 2 bits select the system (P, C, B, U), the lower 14 bits are the number
+	uint16_t code;
+
+	uint8_t status;
+};
+
+/*
+ *	Class
+ */
+// Cache of the fault codes stored in the ECU. Reading them takes a slow multi-frame transaction, so it runs as a
+// background job of the poll scheduler and is only repeated on demand
+class EcuDtcReader
+{
+public:
+	/*
+	 *	Public Functions
+	 */
+	explicit EcuDtcReader(EcuPollScheduler* scheduler);
+
+	~EcuDtcReader();
+
+	// Reads the codes in the next idle slot. Returns false if a read is already running
+	bool refresh();
+
+	bool isRefreshing() const;
+
+	// Copies up to maxCount cached codes, returns the number copied. readUs is -1 if they were never read
+	uint8_t getDtcs(EcuDtc* dtcs, uint8_t maxCount, int64_t& readUs) const;
+
+	std::string toJson() const;
+
+	// Formats the code like "P0123"
+	static void formatCode(uint16_t code, char (&buffer)[ECU_DTC_STRING_LENGTH]);
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	void onResponse(const KLine::Response& response);
+
+	static void staticOnResponse(const KLine::Response& response, void* ctx);
+
+	static bool sendRequest(KLine* kline, KLine::Callback callback, void* ctx);
+
+	/*
+	 *	Private Variables
+	 */
+	EcuPollScheduler* scheduler_ = nullptr;
+
+	SemaphoreHandle_t mutex_ = nullptr;
+
+	std::array<EcuDtc, MAX_ECU_DTCS> dtcs_ = {};
+	uint8_t dtcCount_ = 0;
+
+	// Reported by the ECU, can be more than fit into the response or the cache
+	uint8_t reportedCount_ = 0;
+
+	int64_t readUs_ = -1;
+	bool lastReadFailed_ = false;
+	bool refreshing_ = false;
+};
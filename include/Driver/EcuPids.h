@@ -1,38 +1,60 @@
 #pragma once
 
-enum PID // Lower PID Byte
+// C++ includes
+#include <cstdint>
+
+// Addresses read with Read Data By Identifier. The switch addresses are bitfields holding several signals
+enum ECU_ADDRESS : uint16_t
+{
+	ADDR_SWITCHES_1701 = 0x1701,
+	ADDR_SWITCHES_1702 = 0x1702,
+	ADDR_SWITCHES_1711 = 0x1711,
+	ADDR_EGR_ON = 0x1712,
+	ADDR_SWITCHES_1718 = 0x1718,
+	ADDR_COOLANT_C = 0x1729,
+	ADDR_RPM = 0x1738,
+	ADDR_ADVANCING_IGNITION_DEG = 0x1743,
+	ADDR_SPEED_KMH = 0x174A,
+	ADDR_ENGINE_LOAD_P = 0x174C,
+	ADDR_AIR_MASS_GS = 0x1750,
+	ADDR_INJECTION_MS = 0x1762,
+	ADDR_IDLE_BYPASS_MS = 0x1769,
+	ADDR_EGR_VALVE_POSITION = 0x1775,
+	ADDR_THROTTLE_POSITION_V = 0x1780,
+	ADDR_ECU_INPUT_VOLTAGE = 0x1785,
+	ADDR_COOLANT_V = 0x1787,
+	ADDR_AIR_MASS_V = 0x1790,
+	ADDR_PRE_CAT_LAMBDA_V = 0x1795,
+	ADDR_ALTERNATOR_DESIRED_VOLTAGE = 0x17A4,
+	ADDR_ALTERNATOR_LOAD_P = 0x17A5
+};
+
+// Unique id of every signal, several signals can share one address. The switch bitfields hold the cabin fan, brake,
+// rear defroster, left headlight, idle switch, power steering and immobilizer (0x1701), the daytime lights and right
+// headlight (0x1702), the cooling fan speeds and check engine light (0x1711) and the fuel pump, low voltage light and
+// main relay (0x1718). Their bits are unknown yet, so each bitfield is one raw signal until they can be decoded
+enum ECU_SIGNAL : uint16_t
 {
-	ALTERNATOR_LOAD_P = 0x17A5,
-	ALTERNATOR_DESIRED_VOLTAGE = 0x17A4,
-	CABIN_FAN_ON = 0x1701,
-	BRAKE_ON = 0x1701,
-	REAR_DEFROSTER_ON = 0x1701,
-	DAYTIME_LIGHTS_ON = 0x1702,
-	COOLANT_V = 0x1787,
-	COOLANT_C = 0x1729,
-	EGR_ON = 0x1712,
-	FAN_SPEED_SLOW = 0x1711,
-	FAN_SPEED_MEDIUM = 0x1711,
-	FAN_SPEED_FAST = 0x1711,
-	FUEL_PUMP_ON = 0x1718,
-	INJECTION_MS = 0x1762,
-	LOW_VOLTAGE_LIGHT_ON = 0x1718,
-	HEADLIGHT_LEFT_ON = 0x1701,
-	HEADLIGHT_RIGHT_ON = 0x1702,
-	IDLE_BYPASS_MS = 0x1769,
-	IDLE_SWITCH_ON = 0x1701,
-	ENGINE_LOAD_P = 0x174C,
-	AIR_MASS_V = 0x1790,
-	AIR_MASS_GS = 0x1750,
-	MAIN_RELAY_ON = 0x1718,
-	CHECK_ENGINE_LIGHT = 0x1711,
-	PRE_CAT_LAMBDA_V = 0x1795,
-	PRESSURE_SWITCH_POWER_STEERING_ON = 0x1701,
-	RPM = 0x1738,
-	EGR_VALVE_POSITION = 0x1775,
-	ADVANCING_IGNITION_DEG = 0x1743,
-	IMMOBILIZER_ON = 0x1701,
-	THROTTLE_POSITION_V = 0x1780,
-	ECU_INPUT_VOLTAGE = 0x1785,
-	SPEED_KMH = 0x174A
-};
\ No newline at end of file
+	ALTERNATOR_LOAD_P,
+	ALTERNATOR_DESIRED_VOLTAGE,
+	COOLANT_V,
+	COOLANT_C,
+	EGR_ON,
+	INJECTION_MS,
+	IDLE_BYPASS_MS,
+	ENGINE_LOAD_P,
+	AIR_MASS_V,
+	AIR_MASS_GS,
+	PRE_CAT_LAMBDA_V,
+	RPM,
+	EGR_VALVE_POSITION,
+	ADVANCING_IGNITION_DEG,
+	THROTTLE_POSITION_V,
+	ECU_INPUT_VOLTAGE,
+	SPEED_KMH,
+	SWITCHES_1701,
+	SWITCHES_1702,
+	SWITCHES_1711,
+	SWITCHES_1718,
+	AMOUNT_ECU_SIGNALS
+};
@@ -0,0 +1,227 @@
+#pragma once
+
+// Project includes
+#include "Driver/KLine.hpp"
+
+// C++ includes
+#include <array>
+
+// espidf includes
+#include "freertos/semphr.h"
+
+// Circular inclusion
+class EcuValueCache;
+
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_POLLED_PIDS = 32;
+constexpr uint8_t MAX_POLL_SUBSCRIBERS = 16;
+
+/*
+ *	Class
+ */
+// Merges the PID subscriptions of all consumers into one set. Every PID is polled once per period, using the
+// fastest period and the highest priority of its subscribers, and the result is fanned out to all listeners together
+// with the mask of the interested subscribers. Only one request is in flight, the next one is sent as soon as it's
+// answered so the line stays busy back-to-back. PIDs that are due at about the same time are read together with one
+// multi-PID request, which falls back to single reads if the ECU rejects it. Slow requests like reading the fault codes
+// run as a background job in an idle slot between the polls, or after a bounded deferral if the line never idles, so
+// they delay the PIDs by at most one transaction.
+class EcuPollScheduler
+{
+public:
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		PRIORITY_LOW,
+		PRIORITY_NORMAL,
+		PRIORITY_HIGH
+	} PRIORITY;
+
+	/*
+	 *	Public Struct
+	 */
+	struct Result
+	{
+		uint16_t pid = 0;
+		uint16_t rawValue = 0;
+
+		bool valid = false;
+
+		int64_t requestUs = 0;
+		int64_t responseUs = 0;
+	};
+
+	/*
+	 *	Public typedefs
+	 */
+	// Called from the K-Line task, so it must not block
+	typedef void (*Listener)(const Result& result, uint32_t subscribers, void* ctx);
+
+	// Sends the request of a background job with the given callback
+	typedef bool (*BackgroundRequest)(KLine* kline, KLine::Callback callback, void* ctx);
+
+	/*
+	 *	Public Functions
+	 */
+	// PIDs whose cached value is younger than the TTL and their period aren't polled. Up to maxPidsPerRead PIDs are
+	// batched into one request, 1 disables the batching
+	explicit EcuPollScheduler(KLine* kline, const EcuValueCache* cache = nullptr,
+	                          uint8_t maxPidsPerRead = KLINE_MAX_PIDS_PER_READ);
+
+	~EcuPollScheduler();
+
+	// Returns the id of the subscriber or -1 if all are taken
+	int8_t addSubscriber();
+
+	// Also drops all subscriptions of the subscriber
+	void removeSubscriber(int8_t subscriber);
+
+	bool subscribe(int8_t subscriber, uint16_t pid, uint32_t periodMs, PRIORITY priority = PRIORITY_NORMAL);
+
+	void unsubscribe(int8_t subscriber, uint16_t pid);
+
+	bool addListener(Listener listener, void* ctx);
+
+	uint8_t getPolledPidCount() const;
+
+	// Only one job is pending at a time, returns false if another one is. The callback is called once, from the K-Line
+	// task or with RESULT_TIMEOUT from the poll task if the response is too late
+	bool queueBackgroundJob(BackgroundRequest request, KLine::Callback callback, void* ctx);
+
+	/*
+	 *	Private Tasks
+	 */
+	void pollTask();
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	struct Subscription
+	{
+		uint32_t periodUs;
+		PRIORITY priority;
+	};
+
+	struct Entry
+	{
+		uint16_t pid;
+
+		// Length of the value, 0 if unknown. PIDs with an unknown length can't be batched
+		uint8_t length;
+
+		// Bit n is set if subscriber n is interested
+		uint32_t subscribers;
+		std::array<Subscription, MAX_POLL_SUBSCRIBERS> subscriptions;
+
+		// Merged from all subscriptions
+		uint32_t periodUs;
+		PRIORITY priority;
+
+		int64_t nextDueUs;
+
+		// The last poll failed and this one is its retry
+		bool retrying;
+	};
+
+	struct ListenerEntry
+	{
+		Listener listener;
+		void* ctx;
+	};
+
+	struct BackgroundJob
+	{
+		BackgroundRequest request;
+		KLine::Callback callback;
+		void* ctx;
+
+		int64_t queuedUs;
+	};
+
+	/*
+	 *	Private Functions
+	 */
+	void onResponse(const KLine::Response& response);
+
+	static void staticOnResponse(const KLine::Response& response, void* ctx);
+
+	void onBackgroundResponse(const KLine::Response& response);
+
+	static void staticOnBackgroundResponse(const KLine::Response& response, void* ctx);
+
+	// Needs to hold the mutex. Sends the pending job if the line is idle long enough or it waited too long already
+	bool sendBackgroundJob(int64_t nowUs, bool pidDue);
+
+	// Needs to hold the mutex. Counts the response and returns true if it belongs to a request that was given up
+	// already by the in-flight fallback
+	bool isStale();
+
+	// Needs to hold the mutex
+	Entry* findEntry(uint16_t pid);
+
+	Entry* nextDueEntry(int64_t nowUs);
+
+	// Needs to hold the mutex. Restores the configured batch size a while after the fallback to single reads
+	void reprobeBatching(int64_t nowUs);
+
+	// Fills the in-flight batch starting with the given entry, returns the number of PIDs. The PIDs are only
+	// scheduled once the request was sent
+	uint8_t collectBatch(Entry& first, int64_t nowUs);
+
+	// Splits the response into the results of the in-flight PIDs, returns false if it doesn't match the request
+	bool parseResponse(const KLine::Response& response, Result* results) const;
+
+	// Moves the entry to when its cached value goes stale, returns false if the cache has no fresh value within the
+	// TTL and the period of the entry
+	bool deferIfFresh(Entry& entry, int64_t nowUs) const;
+
+	static void scheduleNext(Entry& entry, int64_t nowUs);
+
+	void removeEntry(uint8_t index);
+
+	static void mergeSubscriptions(Entry& entry);
+
+	/*
+	 *	Private Variables
+	 */
+	KLine* kline_ = nullptr;
+
+	const EcuValueCache* cache_ = nullptr;
+
+	SemaphoreHandle_t mutex_ = nullptr;
+
+	TaskHandle_t pollTaskHandle_ = nullptr;
+
+	std::array<Entry, MAX_POLLED_PIDS> entries_ = {};
+	uint8_t entryCount_ = 0;
+
+	uint32_t usedSubscribers_ = 0;
+
+	std::array<ListenerEntry, 4> listeners_ = {};
+	uint8_t listenerCount_ = 0;
+
+	bool inFlight_ = false;
+	std::array<uint16_t, KLINE_MAX_PIDS_PER_READ> inFlightPids_ = {};
+	std::array<uint8_t, KLINE_MAX_PIDS_PER_READ> inFlightLengths_ = {};
+	uint8_t inFlightCount_ = 0;
+
+	uint8_t configuredPidsPerRead_ = 1;
+	uint8_t maxPidsPerRead_ = 1;
+	uint8_t failedBatches_ = 0;
+	int64_t batchingDisabledUs_ = 0;
+
+	BackgroundJob backgroundJob_ = {};
+	bool backgroundPending_ = false;
+	bool inFlightBackground_ = false;
+	BackgroundJob inFlightJob_ = {};
+
+	// Requests taken by the driver and responses received, the in-flight request is the one with inFlightSequence_
+	uint32_t sentSequence_ = 0;
+	uint32_t answeredSequence_ = 0;
+	uint32_t inFlightSequence_ = 0;
+};
@@ -4,10 +4,11 @@
 #include "EcuPids.h"
 
 // C++ includes
-#include <functional>
-#include <string>
-#include <unordered_map>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
+#include <string>
 
 /*
  *	constexpr
@@ -18,191 +19,213 @@ constexpr auto UNIT_CELSIUS = "°C";
 constexpr auto UNIT_MS = "ms";
 constexpr auto UNIT_DEGREE = "°";
 
-constexpr auto BITMASK_FUNCTION = [](const uint32_t raw) { return raw > 0 ? 1.0 : 0.0; };
+/*
+ *	Public enum
+ */
+typedef enum : uint8_t
+{
+	// value = raw * factor + offset
+	LINEAR,
+	// value = raw > 0
+	BOOLEAN
+} ECU_CONVERSION;
 
 /*
  *	Public Struct
  */
+// Constant description of a signal. The catalog lives in flash, only the values are kept in RAM by the cache
 struct EcuSensor
 {
+	// Unique id of the signal and the address it's decoded from
 	uint16_t id;
-	std::string name;
+	uint16_t address;
+	const char* name;
 
 	uint8_t responseByteCount = 1;
-	std::string unit = "";
+	const char* unit = "";
 	uint8_t bitInMask = 0;
 
-	uint16_t rawValue = 0;
-	std::function<double(uint16_t)> convertRawValue;
+	ECU_CONVERSION conversion = LINEAR;
+	float factor = 1.0f;
+	float offset = 0.0f;
 
-	double getConvertedValue() const
+	// Decodes the signal from the raw value of its address. Signals of bitfield addresses only see their bit
+	constexpr double convert(const uint16_t rawValue) const
 	{
-		if (convertRawValue) {
-			return convertRawValue(rawValue);
+		const uint16_t value = bitInMask != 0 ? rawValue & bitInMask : rawValue;
+
+		switch (conversion) {
+			case BOOLEAN:
+				return value > 0 ? 1.0 : 0.0;
+			case LINEAR:
+			default:
+				return static_cast<double>(value) * factor + offset;
 		}
-
-		return 0.0;
 	}
 
+	// Description of the sensor without a value
 	std::string toJson() const
 	{
 		std::stringstream output;
 		output << "{";
 		output << "\"id\":" << "\"" << id << "\",";
 		output << "\"name\":" << "\"" << name << "\",";
-		output << "\"value\":" << "\"" << getConvertedValue() << "\",";
 		output << "\"unit\":" << "\"" << unit << "\"";
 		output << "}";
 		return output.str();
 	}
+
+	// The value was received at timestampMs since boot
+	std::string toJson(const uint16_t rawValue, const int64_t timestampMs) const
+	{
+		std::stringstream output;
+		output << "{";
+		output << "\"id\":" << "\"" << id << "\",";
+		output << "\"name\":" << "\"" << name << "\",";
+		output << "\"value\":" << "\"" << convert(rawValue) << "\",";
+		output << "\"unit\":" << "\"" << unit << "\",";
+		output << "\"t\":" << timestampMs;
+		output << "}";
+		return output.str();
+	}
+
+	// Same as toJson, but written into the buffer. Returns the length it needed like snprintf
+	int writeJson(char* buffer, const size_t size, const uint16_t rawValue, const int64_t timestampMs) const
+	{
+		return snprintf(buffer, size, "{\"id\":\"%u\",\"name\":\"%s\",\"value\":\"%g\",\"unit\":\"%s\",\"t\":%lld}", id,
+		                name, convert(rawValue), unit, static_cast<long long>(timestampMs));
+	}
 };
 
 /*
- *	Public ECU Sensor Map
+ *	Public ECU Sensor Catalog
  */
-// TODO: Find out the bits of the different bitmask entries
-inline std::unordered_map<uint16_t, EcuSensor> ECU_SENSORS{
-	{ALTERNATOR_LOAD_P,
-	 EcuSensor{.id = ALTERNATOR_LOAD_P, .name = "Alternator - Load", .responseByteCount = 1, .unit = UNIT_PERCENT,
-	           .convertRawValue = [](const uint16_t raw) { return raw / 2.55; }}},
-
-	{ALTERNATOR_DESIRED_VOLTAGE,
-	 EcuSensor{.id = ALTERNATOR_DESIRED_VOLTAGE, .name = "Alternator - Desired Voltage", .responseByteCount = 1,
-	           .unit = UNIT_VOLT,
-	           .convertRawValue = [](const uint16_t raw) { return raw / 10; }}},
-
-	{CABIN_FAN_ON,
-	 EcuSensor{.id = CABIN_FAN_ON, .name = "Cabin Fan - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{BRAKE_ON,
-	 EcuSensor{.id = BRAKE_ON, .name = "Brake - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{REAR_DEFROSTER_ON,
-	 EcuSensor{.id = REAR_DEFROSTER_ON, .name = "Rear Window Defroster - On", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{DAYTIME_LIGHTS_ON,
-	 EcuSensor{.id = DAYTIME_LIGHTS_ON, .name = "Daytime Lights - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{COOLANT_V,
-	 EcuSensor{.id = COOLANT_V, .name = "Coolant - Sensor Voltage", .responseByteCount = 2, .unit = UNIT_VOLT,
-	           .convertRawValue = [](const uint16_t raw) { return static_cast<double>(raw) * (5.0 / 1023.0); }}},
-
-	{COOLANT_C,
-	 EcuSensor{.id = COOLANT_C, .name = "Coolant - Degree", .responseByteCount = 1, .unit = UNIT_CELSIUS,
-	           .convertRawValue = [](const uint16_t raw) { return (raw - 32 - 32) / 1.8; }}},
-
-	{EGR_ON,
-	 EcuSensor{.id = EGR_ON, .name = "EGR - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{FAN_SPEED_SLOW,
-	 EcuSensor{.id = FAN_SPEED_SLOW, .name = "Cooling Fan Speed - On, Slow Speed", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{FAN_SPEED_MEDIUM,
-	 EcuSensor{.id = FAN_SPEED_MEDIUM, .name = "Cooling Fan Speed - On, Medium Speed", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{FAN_SPEED_FAST,
-	 EcuSensor{.id = FAN_SPEED_FAST, .name = "Cooling Fan Speed - On, Fast Speed", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{FUEL_PUMP_ON,
-	 EcuSensor{.id = FUEL_PUMP_ON, .name = "Fuel Pump - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
+// Sorted by the signal id without gaps, so the id is the index into the catalog. Signals sharing an address need
+// their own bit, the switches with unknown bits are read as a whole byte until they are known (see EcuPids.h)
+inline constexpr EcuSensor ECU_SENSORS[] = {
+	{.id = ALTERNATOR_LOAD_P, .address = ADDR_ALTERNATOR_LOAD_P, .name = "Alternator - Load", .responseByteCount = 1,
+	 .unit = UNIT_PERCENT, .factor = 1.0f / 2.55f},
 
-	// TODO: Find out the scale of the injection time
-	{INJECTION_MS,
-	 EcuSensor{.id = INJECTION_MS, .name = "Injector - Injection Time", .responseByteCount = 2, .unit = UNIT_MS,
-	           .convertRawValue = [](const uint16_t raw) { return raw / 1000.0; }}},
+	{.id = ALTERNATOR_DESIRED_VOLTAGE, .address = ADDR_ALTERNATOR_DESIRED_VOLTAGE,
+	 .name = "Alternator - Desired Voltage", .responseByteCount = 1, .unit = UNIT_VOLT, .factor = 0.1f},
 
-	{LOW_VOLTAGE_LIGHT_ON,
-	 EcuSensor{.id = LOW_VOLTAGE_LIGHT_ON, .name = "Battery - Low Voltage (Light)", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
+	{.id = COOLANT_V, .address = ADDR_COOLANT_V, .name = "Coolant - Sensor Voltage", .responseByteCount = 2,
+	 .unit = UNIT_VOLT, .factor = 5.0f / 1023.0f},
 
-	{HEADLIGHT_LEFT_ON,
-	 EcuSensor{.id = HEADLIGHT_LEFT_ON, .name = "Headlight Left - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
+	{.id = COOLANT_C, .address = ADDR_COOLANT_C, .name = "Coolant - Degree", .responseByteCount = 1,
+	 .unit = UNIT_CELSIUS, .factor = 1.0f / 1.8f, .offset = -64.0f / 1.8f},
 
-	{HEADLIGHT_RIGHT_ON,
-	 EcuSensor{.id = HEADLIGHT_RIGHT_ON, .name = "Headlight Right - On", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
+	{.id = EGR_ON, .address = ADDR_EGR_ON, .name = "EGR - On", .responseByteCount = 1, .bitInMask = 0b00000001,
+	 .conversion = BOOLEAN},
 
-	{IDLE_BYPASS_MS,
-	 EcuSensor{.id = IDLE_BYPASS_MS, .name = "Idle Bypass - Time", .responseByteCount = 2, .unit = UNIT_MS,
-	           .convertRawValue = [](const uint16_t raw) { return raw * 0.002; }}},
+	// TODO: Find out the scale of the injection time
+	{.id = INJECTION_MS, .address = ADDR_INJECTION_MS, .name = "Injector - Injection Time", .responseByteCount = 2,
+	 .unit = UNIT_MS, .factor = 0.001f},
 
-	{IDLE_SWITCH_ON,
-	 EcuSensor{.id = IDLE_SWITCH_ON, .name = "Idle Switch - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
+	{.id = IDLE_BYPASS_MS, .address = ADDR_IDLE_BYPASS_MS, .name = "Idle Bypass - Time", .responseByteCount = 2,
+	 .unit = UNIT_MS, .factor = 0.002f},
 
-	{ENGINE_LOAD_P,
-	 EcuSensor{.id = ENGINE_LOAD_P, .name = "Engine - Load", .responseByteCount = 2, .unit = UNIT_PERCENT,
-	           .convertRawValue = [](const uint16_t raw) { return raw / 40.96; }}},
+	{.id = ENGINE_LOAD_P, .address = ADDR_ENGINE_LOAD_P, .name = "Engine - Load", .responseByteCount = 2,
+	 .unit = UNIT_PERCENT, .factor = 1.0f / 40.96f},
 
-	{AIR_MASS_V,
-	 EcuSensor{.id = AIR_MASS_V, .name = "Airmass", .responseByteCount = 2, .unit = UNIT_VOLT,
-	           .convertRawValue = [](const uint16_t raw) { return raw * (5 / 1023); }}},
+	{.id = AIR_MASS_V, .address = ADDR_AIR_MASS_V, .name = "Airmass - Voltage", .responseByteCount = 2,
+	 .unit = UNIT_VOLT, .factor = 5.0f / 1023.0f},
 
 	// TODO: Test if "calculation" is correct
-	{AIR_MASS_GS,
-	 EcuSensor{.id = AIR_MASS_GS, .name = "Airmass", .responseByteCount = 2, .unit = "g/s",
-	           .convertRawValue = [](const uint16_t raw) { return raw; }}},
-
-	{MAIN_RELAY_ON,
-	 EcuSensor{.id = MAIN_RELAY_ON, .name = "Main Relais - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{CHECK_ENGINE_LIGHT,
-	 EcuSensor{.id = CHECK_ENGINE_LIGHT, .name = "Engine - Check Engine Light", .responseByteCount = 1,
-	           .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{PRE_CAT_LAMBDA_V,
-	 EcuSensor{.id = PRE_CAT_LAMBDA_V, .name = "Airmass Pre-Cat - Voltage", .responseByteCount = 2, .unit = UNIT_VOLT,
-	           .convertRawValue = [](const uint16_t raw) { return raw * (5 / 1023); }}},
-
-	{PRESSURE_SWITCH_POWER_STEERING_ON,
-	 EcuSensor{.id = PRESSURE_SWITCH_POWER_STEERING_ON, .name = "Power Steering - Pressure Switch On",
-	           .responseByteCount = 1,
-	           .convertRawValue = [](const uint16_t raw) { return raw > 0 ? 1.0 : 0.0; }}},
-
-	{RPM,
-	 EcuSensor{.id = RPM, .name = "RPM", .responseByteCount = 2,
-	           .convertRawValue = [](const uint16_t raw) { return raw; }}},
-
-	{EGR_VALVE_POSITION,
-	 EcuSensor{.id = EGR_VALVE_POSITION, .name = "EGR - Valve Position", .responseByteCount = 1,
-	           .convertRawValue = [](const uint16_t raw) { return raw; }}},
-
-	{ADVANCING_IGNITION_DEG,
-	 EcuSensor{.id = ADVANCING_IGNITION_DEG, .name = "Ignition Timing - Advancing", .responseByteCount = 2,
-	           .unit = UNIT_DEGREE,
-	           .convertRawValue = [](const uint16_t raw) { return (raw - 255) / 12.8; }}},
-
-	{IMMOBILIZER_ON,
-	 EcuSensor{.id = IMMOBILIZER_ON, .name = "Immobilizer - On", .responseByteCount = 1, .bitInMask = 0b00000001,
-	           .convertRawValue = BITMASK_FUNCTION}},
-
-	{THROTTLE_POSITION_V,
-	 EcuSensor{.id = THROTTLE_POSITION_V, .name = "Throttle - Voltage", .responseByteCount = 2, .unit = UNIT_VOLT,
-	           .convertRawValue = [](const uint16_t raw) { return raw * (5 / 1023); }}},
-
-	{ECU_INPUT_VOLTAGE,
-	 EcuSensor{.id = ECU_INPUT_VOLTAGE, .name = "ECU - Input Voltage", .responseByteCount = 1, .unit = UNIT_VOLT,
-	           .convertRawValue = [](const uint16_t raw) { return (raw / 12.8) + 1; }}},
-
-	{SPEED_KMH,
-	 EcuSensor{.id = SPEED_KMH, .name = "Speed", .responseByteCount = 1, .unit = "KMH",
-	           .convertRawValue = [](const uint16_t raw) { return raw; }}},
+	{.id = AIR_MASS_GS, .address = ADDR_AIR_MASS_GS, .name = "Airmass - Flow", .responseByteCount = 2, .unit = "g/s"},
+
+	{.id = PRE_CAT_LAMBDA_V, .address = ADDR_PRE_CAT_LAMBDA_V, .name = "Airmass Pre-Cat - Voltage",
+	 .responseByteCount = 2, .unit = UNIT_VOLT, .factor = 5.0f / 1023.0f},
+
+	{.id = RPM, .address = ADDR_RPM, .name = "RPM", .responseByteCount = 2},
+
+	{.id = EGR_VALVE_POSITION, .address = ADDR_EGR_VALVE_POSITION, .name = "EGR - Valve Position",
+	 .responseByteCount = 1},
+
+	{.id = ADVANCING_IGNITION_DEG, .address = ADDR_ADVANCING_IGNITION_DEG, .name = "Ignition Timing - Advancing",
+	 .responseByteCount = 2, .unit = UNIT_DEGREE, .factor = 1.0f / 12.8f, .offset = -255.0f / 12.8f},
+
+	{.id = THROTTLE_POSITION_V, .address = ADDR_THROTTLE_POSITION_V, .name = "Throttle - Voltage",
+	 .responseByteCount = 2, .unit = UNIT_VOLT, .factor = 5.0f / 1023.0f},
+
+	{.id = ECU_INPUT_VOLTAGE, .address = ADDR_ECU_INPUT_VOLTAGE, .name = "ECU - Input Voltage", .responseByteCount = 1,
+	 .unit = UNIT_VOLT, .factor = 1.0f / 12.8f, .offset = 1.0f},
+
+	{.id = SPEED_KMH, .address = ADDR_SPEED_KMH, .name = "Speed", .responseByteCount = 1, .unit = "KMH"},
+
+	{.id = SWITCHES_1701, .address = ADDR_SWITCHES_1701, .name = "Switches 0x1701", .responseByteCount = 1,
+	 .bitInMask = 0xFF},
+
+	{.id = SWITCHES_1702, .address = ADDR_SWITCHES_1702, .name = "Switches 0x1702", .responseByteCount = 1,
+	 .bitInMask = 0xFF},
+
+	{.id = SWITCHES_1711, .address = ADDR_SWITCHES_1711, .name = "Switches 0x1711", .responseByteCount = 1,
+	 .bitInMask = 0xFF},
+
+	{.id = SWITCHES_1718, .address = ADDR_SWITCHES_1718, .name = "Switches 0x1718", .responseByteCount = 1,
+	 .bitInMask = 0xFF},
 };
+
+/*
+ *	Public Functions
+ */
+// Checks at compile time that every signal has its entry at the index of its id
+constexpr bool isEcuSensorCatalogIndexed()
+{
+	uint16_t index = 0;
+	for (const EcuSensor& sensor : ECU_SENSORS) {
+		if (sensor.id != index++) {
+			return false;
+		}
+	}
+
+	return index == AMOUNT_ECU_SIGNALS;
+}
+
+static_assert(isEcuSensorCatalogIndexed(), "ECU_SENSORS must contain every ECU_SIGNAL sorted by its id");
+
+// Checks at compile time that signals sharing an address are decoded from different bits
+constexpr bool hasEcuSensorCatalogUniqueBits()
+{
+	for (const EcuSensor& a : ECU_SENSORS) {
+		for (const EcuSensor& b : ECU_SENSORS) {
+			if (&a != &b && a.address == b.address && (a.bitInMask == 0 || (a.bitInMask & b.bitInMask) != 0)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static_assert(hasEcuSensorCatalogUniqueBits(), "Signals of the same address need their own bits in bitInMask");
+
+// Returns the catalog entry of the signal or nullptr if the id is unknown
+constexpr const EcuSensor* getEcuSensor(const uint16_t id)
+{
+	return id < AMOUNT_ECU_SIGNALS ? &ECU_SENSORS[id] : nullptr;
+}
+
+// Returns the catalog entry with the given name or nullptr if there is none
+inline const EcuSensor* findEcuSensor(const char* name)
+{
+	for (const EcuSensor& sensor : ECU_SENSORS) {
+		if (name != nullptr && strcmp(sensor.name, name) == 0) {
+			return &sensor;
+		}
+	}
+
+	return nullptr;
+}
+
+// Returns the length of the value of the address or 0 if no signal is decoded from it
+constexpr uint8_t getEcuAddressLength(const uint16_t address)
+{
+	for (const EcuSensor& sensor : ECU_SENSORS) {
+		if (sensor.address == address) {
+			return sensor.responseByteCount;
+		}
+	}
+
+	return 0;
+}
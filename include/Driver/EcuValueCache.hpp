@@ -0,0 +1,79 @@
+#pragma once
+
+// Project includes
+#include "Driver/EcuPollScheduler.hpp"
+
+// C++ includes
+#include <array>
+
+// espidf includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_CACHED_PIDS = 64;
+
+/*
+ *	Class
+ */
+// Latest ECU value of every PID together with the time it was received. Consumers read values that are younger
+// than the TTL from here instead of starting a new K-Line transaction
+class EcuValueCache
+{
+public:
+	/*
+	 *	Public Struct
+	 */
+	struct Value
+	{
+		uint16_t rawValue = 0;
+
+		// Reception of the ECU response
+		int64_t timestampUs = 0;
+
+		// Time between the request and the response
+		uint32_t latencyUs = 0;
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	explicit EcuValueCache(uint32_t ttlMs);
+
+	~EcuValueCache();
+
+	void store(uint16_t pid, const Value& value);
+
+	// Latest value regardless of its age
+	bool get(uint16_t pid, Value& value) const;
+
+	// Only values younger than the TTL
+	bool getFresh(uint16_t pid, int64_t nowUs, Value& value) const;
+
+	uint32_t getTtlMs() const;
+
+	// Listener of the EcuPollScheduler
+	static void staticOnResult(const EcuPollScheduler::Result& result, uint32_t subscribers, void* ctx);
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	struct Entry
+	{
+		uint16_t pid;
+		Value value;
+	};
+
+	/*
+	 *	Private Variables
+	 */
+	uint32_t ttlUs_ = 0;
+
+	SemaphoreHandle_t mutex_ = nullptr;
+
+	std::array<Entry, MAX_CACHED_PIDS> entries_ = {};
+	uint8_t entryCount_ = 0;
+};
@@ -1,39 +1,223 @@
 #pragma once
 
 // Project includes
-#include "EcuSensors.hpp"
+#include "Driver/KLineFrame.hpp"
+#include "Driver/KLineMetrics.hpp"
 
 // C++ includes
-#include <vector>
+#include <string>
 
 // espidf includes
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
+/*
+ *	Public constexpr
+ */
+// SID and 2 bytes per PID have to fit into the payload of one request
+constexpr uint8_t KLINE_MAX_PIDS_PER_READ = (KLINE_MAX_PAYLOAD_LENGTH - 1) / 2;
+
+// Responses spread over multiple frames are joined, up to this many frames
+constexpr uint8_t KLINE_MAX_RESPONSE_FRAMES = 4;
+constexpr uint8_t KLINE_MAX_RESPONSE_LENGTH = 1 + KLINE_MAX_RESPONSE_FRAMES * (KLINE_MAX_PAYLOAD_LENGTH - 1);
+
+// Event driven K-Line driver. Requests are queued without blocking and sent back-to-back by the request task, the
+// RX task assembles the received bytes into frames. The result of a request is delivered to its callback.
+// With the fast init enabled the driver keeps one diagnostic session open: it's started before the first request, kept
+// alive with tester present messages while idle and restarted right away once consecutive timeouts show it dropped.
+// While the ECU doesn't answer the init, requests are sent without a session.
 class KLine
 {
 public:
-	KLine();
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		RESULT_OK,
+		RESULT_NEGATIVE_RESPONSE,
+		RESULT_TIMEOUT,
+		RESULT_SEND_FAILED
+	} RESULT;
+
+	/*
+	 *	Public Struct
+	 */
+	struct Response
+	{
+		RESULT result = RESULT_TIMEOUT;
+
+		// Payload of the response starting with its SID. Of multi-frame responses only the first SID is kept
+		uint8_t payload[KLINE_MAX_RESPONSE_LENGTH] = {};
+		uint8_t payloadLength = 0;
+		uint8_t frames = 0;
+
+		// End of the request transmission and reception of the response
+		int64_t requestUs = 0;
+		int64_t responseUs = 0;
+	};
+
+	// Protocol timing, the names follow ISO 14230
+	struct Timing
+	{
+		uint32_t baudRate = 10400;
+
+		// Max pause between two bytes of a received frame, a longer one ends the frame
+		uint32_t p1MaxUs = 20000;
+
+		// Time the ECU has to answer a request
+		uint32_t p2MaxUs = 100000;
+
+		// Pause between the end of a response and the next request
+		uint32_t p3MinUs = 10000;
+
+		// Pause between two bytes of a sent frame. 0 sends the frame in one burst
+		uint32_t p4MinUs = 0;
+
+		// Narrows P2 & P3 towards the measured response times and backs off on errors
+		bool adaptive = false;
+
+		// Starts a session with a fast init. Without it, or while the ECU doesn't answer the init, requests are sent
+		// right away
+		bool fastInit = false;
+
+		// Idle time before a tester present is sent, 0 disables it. Has to stay below P3 max of the ECU (5 s)
+		uint32_t keepAliveUs = 2000000;
+	};
+
+	struct Stats
+	{
+		uint32_t requests = 0;
+		uint32_t responses = 0;
+		uint32_t timeouts = 0;
+
+		// Frames with a wrong checksum or format and frames cut off by a gap on the line
+		uint32_t invalidFrames = 0;
+		uint32_t droppedFrames = 0;
+
+		// Time between the end of the request and the response
+		uint32_t lastResponseUs = 0;
+		uint32_t minResponseUs = 0;
+		uint32_t maxResponseUs = 0;
+
+		// Longest pause between two bytes of a received frame
+		uint32_t maxInterByteUs = 0;
+
+		// Currently used timing, differs from the configured one while adaptive
+		uint32_t p2MaxUs = 0;
+		uint32_t p3MinUs = 0;
+
+		// PIDs of the answered reads, a read of several PIDs counts each of them
+		uint32_t pidsRead = 0;
+
+		// PIDs read per second over the last report interval
+		float pidsPerSecond = 0.0f;
+	};
+
+	/*
+	 *	Public typedefs
+	 */
+	// Called from the request task, so it must not block
+	typedef void (*Callback)(const Response& response, void* ctx);
+
+	/*
+	 *	Public Functions
+	 */
+	explicit KLine(const Timing& timing);
 
 	~KLine();
 
-	void readEcuId();
+	// Queues the request without blocking. Returns false if the driver isn't initialized or the queue is full.
+	// A multi-frame request collects response frames until the ECU pauses for P2
+	bool request(const uint8_t* payload, uint8_t length, Callback callback, void* ctx, bool multiFrame = false);
+
+	bool readEcuId(Callback callback, void* ctx);
+
+	bool readPid(uint16_t pid, Callback callback, void* ctx);
+
+	// Reads multiple PIDs with one request. The response holds every PID followed by its value, in request order
+	bool readPids(const uint16_t* pids, uint8_t count, Callback callback, void* ctx);
+
+	// All stored fault codes, the response holds the count followed by code (2 bytes) and status of each
+	bool readDtcs(Callback callback, void* ctx);
 
-	void readPid(uint16_t pid);
+	bool isInitialized() const;
 
-	QueueHandle_t getQueue() const;
+	uint32_t getQueuedRequests() const;
 
-	SemaphoreHandle_t getLastMessageMutex() const;
+	Stats getStats() const;
 
-	uint8_t getLastMessageLength() const;
+	void logStats() const;
+
+	// Latency histograms, error counters and line utilization, in total and per PID
+	std::string getMetricsJson() const;
+
+	/*
+	 *	Private Tasks
+	 */
+	void rxTask();
+
+	void requestTask();
 
-	uint8_t* getLastMessage();
 private:
+	/*
+	 *	Private Struct
+	 */
+	struct Request
+	{
+		uint8_t payload[KLINE_MAX_PAYLOAD_LENGTH];
+		uint8_t payloadLength;
+		bool multiFrame;
+
+		Callback callback;
+		void* ctx;
+	};
+
+	struct ReceivedFrame
+	{
+		KLineFrame frame;
+		int64_t timestampUs;
+	};
+
 	/*
 	 *	Private Functions
 	 */
-	void send(uint8_t* data, const uint8_t length, const bool calcChecksum = true);
+	bool transmit(const Request& request);
+
+	// Sends the request and waits for its response
+	void exchange(const Request& request, Response& response);
+
+	// Starts a new session if there's none and it's time to try again. Without one the request is sent anyway
+	void ensureSession(int64_t nowUs);
+
+	void startSession();
+
+	// Fast init wake up pattern, the TX line is pulled low for 25 ms and released for 25 ms
+	static void wakeUp();
+
+	// Tracks the session from the result of a request
+	void updateSession(const Response& response, int64_t nowUs);
+
+	void dropSession(int64_t nowUs, const char* reason);
+
+	static bool isResponseTo(const Request& request, const KLineFrame& frame);
 
-	static uint8_t calculateChecksum(const uint8_t* data, const uint8_t& length);
+	// Appends the following frames of a multi-frame response
+	void collectFrames(const Request& request, Response& response);
+
+	void updateStats(const Request& request, const Response& response);
+
+	// Narrows the timing after a window without errors and restores the configured one on an error
+	void adaptTiming(const Response& response);
+
+	void recordMetrics(const Request& request, const Response& response, int64_t startUs);
+
+	// Closes the metrics window and reports the throughput when due. Returns the time until the next one is due
+	int64_t updatePeriodic(int64_t nowUs);
+
+	static void waitUntil(int64_t timestampUs);
 
 	/*
 	 *	Private Variables
@@ -42,9 +226,47 @@ private:
 
 	QueueHandle_t uartQueueHandle_ = nullptr;
 
+	QueueHandle_t requestQueue_ = nullptr;
+
+	QueueHandle_t frameQueue_ = nullptr;
+
 	TaskHandle_t rxTaskHandle_ = nullptr;
 
-	uint8_t lastMessage_[16] = {0x00};
-	uint8_t lastMessageLength_ = 0;
-	SemaphoreHandle_t lastMessageMutex_ = nullptr;
+	TaskHandle_t requestTaskHandle_ = nullptr;
+
+	KLineFrameAssembler assembler_;
+
+	int64_t lastByteUs_ = 0;
+
+	// Configured timing and the one currently used
+	Timing timing_;
+	uint32_t p2MaxUs_ = 0;
+	uint32_t p3MinUs_ = 0;
+
+	Stats stats_;
+
+	// Written by the RX task
+	uint32_t droppedFrames_ = 0;
+	uint32_t maxInterByteUs_ = 0;
+
+	// Adaptive timing
+	uint32_t cleanResponses_ = 0;
+	uint32_t windowMaxResponseUs_ = 0;
+	uint32_t lastFrameErrors_ = 0;
+
+	// Throughput report
+	int64_t nextReportUs_ = 0;
+	uint32_t reportedPids_ = 0;
+
+	KLineMetrics metrics_;
+	SemaphoreHandle_t metricsMutex_ = nullptr;
+	int64_t nextMetricsWindowUs_ = 0;
+
+	// Session
+	bool sessionActive_ = false;
+	int64_t lastActivityUs_ = 0;
+	int64_t droppedUs_ = -1;
+	int64_t nextInitUs_ = 0;
+	uint8_t consecutiveTimeouts_ = 0;
+	uint8_t failedInits_ = 0;
 };
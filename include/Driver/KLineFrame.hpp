@@ -0,0 +1,76 @@
+#pragma once
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Public constexpr
+ */
+// The upper nibble of the format byte holds the frame length - 1, so a frame has at most 16 bytes
+constexpr uint8_t KLINE_MAX_FRAME_LENGTH = 16;
+constexpr uint8_t KLINE_HEADER_LENGTH = 3;
+constexpr uint8_t KLINE_MIN_FRAME_LENGTH = KLINE_HEADER_LENGTH + 2;
+constexpr uint8_t KLINE_MAX_PAYLOAD_LENGTH = KLINE_MAX_FRAME_LENGTH - KLINE_HEADER_LENGTH - 1;
+
+/*
+ *	Public Struct
+ */
+// Hardware independent K-Line frame: format, target, source, payload (SID + data) and checksum
+struct KLineFrame
+{
+	uint8_t target = 0;
+	uint8_t source = 0;
+
+	uint8_t payload[KLINE_MAX_PAYLOAD_LENGTH] = {};
+	uint8_t payloadLength = 0;
+
+	// Writes the complete frame including format byte and checksum. Returns its length or 0 if it doesn't fit
+	uint8_t encode(uint8_t* buffer, uint8_t size) const;
+
+	// Sum of all bytes modulo 256
+	static uint8_t checksum(const uint8_t* data, uint8_t length);
+
+	// Length of the complete frame announced by the format byte
+	static uint8_t frameLength(uint8_t format);
+};
+
+/*
+ *	Class
+ */
+// Assembles frames from the received byte stream
+class KLineFrameAssembler
+{
+public:
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		INCOMPLETE,
+		COMPLETE,
+		INVALID
+	} RESULT;
+
+	/*
+	 *	Public Functions
+	 */
+	// On COMPLETE the frame holds the received frame, INVALID means a wrong format byte or checksum
+	RESULT push(uint8_t byte, KLineFrame& frame);
+
+	// Drops a partially received frame, e.g. after a gap on the line
+	void reset();
+
+	bool isEmpty() const;
+
+	uint32_t getInvalidFrames() const;
+
+private:
+	/*
+	 *	Private Variables
+	 */
+	uint8_t buffer_[KLINE_MAX_FRAME_LENGTH] = {};
+	uint8_t length_ = 0;
+	uint8_t expectedLength_ = 0;
+
+	uint32_t invalidFrames_ = 0;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+// C++ includes
+#include <array>
+#include <cstdint>
+#include <string>
+
+/*
+ *	Public constexpr
+ */
+// Upper edges of the latency buckets, the last bucket holds everything above
+constexpr std::array<uint32_t, 9> KLINE_LATENCY_BUCKET_EDGES_US = {
+	2000, 5000, 10000, 15000, 20000, 30000, 50000, 75000, 100000
+};
+constexpr uint8_t KLINE_LATENCY_BUCKETS = KLINE_LATENCY_BUCKET_EDGES_US.size() + 1;
+
+// PIDs beyond this are only counted in the aggregate
+constexpr uint8_t MAX_METRIC_PIDS = 32;
+
+/*
+ *	Public Struct
+ */
+struct KLineLatencyHistogram
+{
+	std::array<uint32_t, KLINE_LATENCY_BUCKETS> buckets = {};
+
+	uint32_t count = 0;
+	uint32_t minUs = 0;
+	uint32_t maxUs = 0;
+	uint64_t sumUs = 0;
+
+	void add(uint32_t latencyUs);
+
+	uint32_t getAverageUs() const;
+
+	// Upper edge of the bucket holding the percentile, the maximum if it's in the last bucket
+	uint32_t getPercentileUs(uint8_t percentile) const;
+};
+
+struct KLineTransactionCounters
+{
+	uint32_t requests = 0;
+	uint32_t responses = 0;
+	uint32_t negativeResponses = 0;
+	uint32_t timeouts = 0;
+	uint32_t sendFailures = 0;
+
+	// Of the positive and negative responses
+	KLineLatencyHistogram latency;
+};
+
+struct KLinePidMetrics
+{
+	uint16_t pid = 0;
+
+	KLineTransactionCounters counters;
+};
+
+struct KLineSessionCounters
+{
+	bool active = false;
+	int64_t startUs = 0;
+
+	uint32_t connects = 0;
+	uint32_t failedInits = 0;
+	uint32_t drops = 0;
+	uint32_t keepAlives = 0;
+
+	// Duration of the last init handshake
+	uint32_t lastInitUs = 0;
+
+	// From detecting the drop until the session was back, including failed attempts
+	uint32_t lastReconnectUs = 0;
+	uint32_t maxReconnectUs = 0;
+};
+
+/*
+ *	Class
+ */
+// Hardware independent transaction metrics of the K-Line, kept in fixed memory. Every request is counted in the
+// aggregate and, for PID reads, once per PID it read. The line utilization is measured over windows: the share of time
+// a transaction occupied the line and the share of time bytes were actually on the wire.
+class KLineMetrics
+{
+public:
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		OUTCOME_OK,
+		OUTCOME_NEGATIVE_RESPONSE,
+		OUTCOME_TIMEOUT,
+		OUTCOME_SEND_FAILED
+	} OUTCOME;
+
+	/*
+	 *	Public Functions
+	 */
+	KLineMetrics() = default;
+
+	// transactionUs runs from the start of the request until the response or the timeout, lineBytes counts the bytes
+	// of both frames
+	void record(const uint16_t* pids, uint8_t pidCount, OUTCOME outcome, uint32_t latencyUs, uint32_t transactionUs,
+	            uint16_t lineBytes);
+
+	// Counted by the receiver independent of the transactions
+	void setFrameErrors(uint32_t checksumErrors, uint32_t droppedFrames);
+
+	// Ends the current utilization window. Each byte takes 10 bits on the wire
+	void closeWindow(int64_t nowUs, uint32_t baudRate);
+
+	// reconnectUs is 0 for the first session
+	void recordSessionStart(int64_t nowUs, uint32_t initUs, uint32_t reconnectUs);
+
+	void recordSessionDrop();
+
+	void recordFailedInit();
+
+	void recordKeepAlive();
+
+	const KLineSessionCounters& getSession() const;
+
+	const KLineTransactionCounters& getTotal() const;
+
+	uint8_t getPidCount() const;
+
+	const KLinePidMetrics& getPid(uint8_t index) const;
+
+	// Of the last closed window in percent
+	float getLineUtilization() const;
+	float getWireUtilization() const;
+
+	// Responses per second of the last closed window
+	float getResponsesPerSecond() const;
+
+	// The session uptime is given relative to nowUs
+	std::string toJson(int64_t nowUs) const;
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	KLinePidMetrics* findOrAddPid(uint16_t pid);
+
+	static void count(KLineTransactionCounters& counters, OUTCOME outcome, uint32_t latencyUs);
+
+	/*
+	 *	Private Variables
+	 */
+	KLineTransactionCounters total_;
+
+	std::array<KLinePidMetrics, MAX_METRIC_PIDS> pids_ = {};
+	uint8_t pidCount_ = 0;
+	uint32_t untrackedPids_ = 0;
+
+	uint32_t checksumErrors_ = 0;
+	uint32_t droppedFrames_ = 0;
+
+	KLineSessionCounters session_;
+
+	// Current window
+	int64_t windowStartUs_ = -1;
+	uint64_t windowTransactionUs_ = 0;
+	uint32_t windowLineBytes_ = 0;
+	uint32_t windowResponses_ = 0;
+
+	// Last closed window
+	float lineUtilization_ = 0.0f;
+	float wireUtilization_ = 0.0f;
+	float responsesPerSecond_ = 0.0f;
+};
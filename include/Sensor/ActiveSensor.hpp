@@ -3,23 +3,35 @@
 // espidf includes
 #include "driver/gpio.h"
 #include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// C++ includes
+#include <atomic>
 
 class ActiveSensor
 {
 public:
 	ActiveSensor(gpio_num_t gpio, const gpio_int_type_t& triggeringEdge);
 
+	virtual ~ActiveSensor() = default;
+
 	void enable();
 
 	void disable();
 
 	virtual int get();
 
+	// Notifies the task with every edge until it is cleared with nullptr. The time of the edge is stored in edgeTimeUs
+	void setEdgeNotification(TaskHandle_t task, std::atomic<uint32_t>* edgeTimeUs);
+
 	/*
 	 *	Public Callback functions
 	 */
 	IRAM_ATTR virtual void cb();
 
+	IRAM_ATTR void notifyEdge();
+
 protected:
 	/*
 	 *	Private Variables
@@ -27,4 +39,8 @@ protected:
 	bool enabled_ = false;
 
 	gpio_num_t gpio_ = GPIO_NUM_NC;
+
+	TaskHandle_t volatile notifyTask_ = nullptr;
+
+	std::atomic<uint32_t>* volatile notifyEdgeTimeUs_ = nullptr;
 };
@@ -6,7 +6,7 @@
 class LeftIndicator : public ActiveSensor
 {
 public:
-	LeftIndicator();
+	explicit LeftIndicator(gpio_num_t gpio);
 
 	int get() override;
 
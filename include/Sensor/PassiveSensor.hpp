@@ -1,42 +1,130 @@
 #pragma once
 
+// Project includes
+#include "Driver/AdcManager.hpp"
+#include "Sensor/SignalStore.hpp"
+
 // espidf includes
-#include "esp_adc/adc_oneshot.h"
 #include "driver/gpio.h"
 
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_CURVE_POINTS = 32;
+constexpr uint8_t MAX_MEDIAN_WINDOW = 21;
+
+/*
+ *	Public typedefs
+ */
+typedef struct
+{
+	float x;
+	float y;
+} CurvePoint_t;
+
+/*
+ *	Public Struct
+ */
+struct PassiveSensorConfig
+{
+	typedef enum
+	{
+		VOLTAGE_MV,
+		RESISTANCE_OHM
+	} INPUT;
+
+	typedef enum
+	{
+		CURVE,
+		THRESHOLD,
+		NONE
+	} CONVERSION;
+
+	SignalStore::SIGNAL signal;
+
+	// The ADC unit & channel are resolved from the GPIO
+	gpio_num_t gpio;
+
+	// Input of the conversion. The sensor is R2 of a voltage divider with seriesResistorOhm as R1
+	INPUT input;
+	float seriesResistorOhm;
+
+	// Curve points have to be sorted by x ascending
+	CONVERSION conversion;
+	CurvePoint_t curve[MAX_CURVE_POINTS];
+	uint8_t curvePoints;
+	float threshold;
+
+	// A median window of 1 and a dampener of 1.0 disable the filters
+	uint8_t medianWindow;
+	float dampener;
+
+	float minValue;
+	float maxValue;
+
+	// Electrical fault detection. A voltage at or above openCircuitMv is an open circuit, at or below
+	// shortCircuitMv a short circuit. Inputs further outside of the curve than curveMargin (fraction of the
+	// curve range end) are classified the same way, high inputs as open, low ones as short. 0 disables a check
+	int openCircuitMv;
+	int shortCircuitMv;
+	float curveMargin;
+
+	uint32_t periodUs;
+};
+
+/*
+ *	Class
+ */
 class PassiveSensor
 {
 public:
-	PassiveSensor(gpio_num_t gpio, adc_channel_t adcChannel, adc_oneshot_unit_handle_t* adc, adc_unit_t unit = ADC_UNIT_2);
+	PassiveSensor() = default;
+
+	bool setup(const PassiveSensorConfig& config, AdcManager* adc);
 
 	void read();
 
-	virtual int get();
+	int get() const;
+
+	int getVoltage() const;
 
-protected:
+	SignalStore::STATUS getStatus() const;
+
+	const PassiveSensorConfig& getConfig() const;
+
+private:
 	/*
 	 *	Private Functions
 	 */
-	virtual void specificRead();
+	float convert(float input) const;
+
+	float filter(float value);
 
-	static double calcVoltageDividerR2(int voltageMv, int r1);
+	SignalStore::STATUS classify(float input) const;
+
+	static double calcVoltageDividerR2(int voltageMv, double r1);
 
 	/*
 	 *	Private Variables
 	 */
+	PassiveSensorConfig config_ = {};
+
 	bool setup_ = false;
 
 	int voltage_ = 0;
 
-	adc_oneshot_unit_handle_t* adc_ = nullptr;
+	int value_ = 0;
 
-	adc_unit_t unit_;
+	SignalStore::STATUS status_ = SignalStore::STATUS_OK;
 
-	adc_channel_t channel_ = ADC_CHANNEL_0;
+	float medianValues_[MAX_MEDIAN_WINDOW] = {};
+	uint8_t medianIndex_ = 0;
+	uint8_t medianCount_ = 0;
 
-	adc_oneshot_chan_cfg_t channelConfig_ = {.atten = ADC_ATTEN_DB_12, .bitwidth = ADC_BITWIDTH_DEFAULT};
+	bool smoothed_ = false;
+	float smoothedValue_ = 0.0f;
 
-	adc_cali_handle_t calibrationHandle_;
+	AdcManager* adc_ = nullptr;
 
-	gpio_num_t gpio_ = GPIO_NUM_NC;
+	int8_t adcChannel_ = -1;
 };
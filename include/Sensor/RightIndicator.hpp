@@ -6,7 +6,7 @@
 class RightIndicator : public ActiveSensor
 {
 public:
-	RightIndicator();
+	explicit RightIndicator(gpio_num_t gpio);
 
 	int get() override;
 
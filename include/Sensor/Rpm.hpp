@@ -12,7 +12,7 @@
 class Rpm : public ActiveSensor
 {
 public:
-	Rpm();
+	explicit Rpm(gpio_num_t gpio);
 
 	int get() override;
 
@@ -0,0 +1,78 @@
+#pragma once
+
+// Project includes
+#include "Sensor/ActiveSensor.hpp"
+#include "Sensor/PassiveSensor.hpp"
+#include "Sensor/SignalStore.hpp"
+
+// Libraries
+#include "ArduinoJson.h"
+
+// C++ includes
+#include <array>
+
+/*
+ *	Public constexpr
+ */
+constexpr uint8_t MAX_PASSIVE_SENSORS = 8;
+constexpr uint8_t MAX_ACTIVE_SENSORS = 8;
+
+/*
+ *	Public Struct
+ */
+struct ActiveSensorConfig
+{
+	SignalStore::SIGNAL signal;
+
+	gpio_num_t gpio;
+};
+
+/*
+ *	Class
+ */
+class SensorRegistry
+{
+public:
+	SensorRegistry() = default;
+
+	~SensorRegistry();
+
+	// Compiles the "Sensors" section of the config into the flat tables. Falls back to the built-in wiring
+	void compile(const ArduinoJson::JsonDocument* config);
+
+	void setup(AdcManager* adc);
+
+	void readDuePassiveSensors(SignalStore* store, int64_t nowUs);
+
+	void sampleActiveSensors(SignalStore* store, int64_t nowUs) const;
+
+	PassiveSensor* getPassiveSensor(SignalStore::SIGNAL signal);
+
+	ActiveSensor* getActiveSensor(SignalStore::SIGNAL signal) const;
+
+	void enableActiveSensors() const;
+
+	void disableActiveSensors() const;
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	void compilePassiveSensors(ArduinoJson::JsonArrayConst sensors);
+
+	void compileActiveSensors(ArduinoJson::JsonArrayConst sensors);
+
+	bool isSignalUsed(SignalStore::SIGNAL signal) const;
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<PassiveSensorConfig, MAX_PASSIVE_SENSORS> passiveConfigs_ = {};
+	std::array<PassiveSensor, MAX_PASSIVE_SENSORS> passiveSensors_;
+	std::array<int64_t, MAX_PASSIVE_SENSORS> nextReadUs_ = {};
+	uint8_t passiveCount_ = 0;
+
+	std::array<ActiveSensorConfig, MAX_ACTIVE_SENSORS> activeConfigs_ = {};
+	std::array<ActiveSensor*, MAX_ACTIVE_SENSORS> activeSensors_ = {};
+	uint8_t activeCount_ = 0;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+// C++ includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+ *	Class
+ */
+class SignalStore
+{
+public:
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		FUEL_LEVEL,
+		OIL_PRESSURE,
+		WATER_TEMPERATURE,
+		RPM,
+		SPEED,
+		LEFT_INDICATOR,
+		RIGHT_INDICATOR,
+
+		// Speed in 0.01 km/h, published with SPEED by the speed sensor. Can't be configured as a sensor
+		SPEED_CENTI_KMH,
+		AMOUNT_SIGNALS
+	} SIGNAL;
+
+	typedef enum
+	{
+		STATUS_OK,
+		STATUS_OPEN_CIRCUIT,
+		STATUS_SHORT_CIRCUIT,
+		STATUS_ADC_FAILURE
+	} STATUS;
+
+	/*
+	 *	Public Struct
+	 */
+	struct Sample
+	{
+		int32_t value = 0;
+		int64_t timestampUs = 0;
+		STATUS status = STATUS_OK;
+
+		// Amount of publishes into the slot. 0 means the signal was never published
+		uint32_t generation = 0;
+	};
+
+	typedef std::array<Sample, AMOUNT_SIGNALS> Snapshot;
+
+	/*
+	 *	Public Functions
+	 */
+	static const char* getName(SIGNAL signal);
+
+	// Returns AMOUNT_SIGNALS if the name is unknown
+	static SIGNAL fromName(const char* name);
+
+	// Only one producer per signal is allowed to publish
+	void publish(SIGNAL signal, int32_t value, int64_t timestampUs, STATUS status = STATUS_OK);
+
+	Sample read(SIGNAL signal) const;
+
+	void snapshot(Snapshot& snapshot) const;
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	// Seqlock protected slot. An odd sequence means a write is in progress
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence{0};
+		std::atomic<int32_t> value{0};
+		std::atomic<uint32_t> status{STATUS_OK};
+		std::atomic<uint32_t> timestampLow{0};
+		std::atomic<uint32_t> timestampHigh{0};
+	};
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<Slot, AMOUNT_SIGNALS> slots_;
+};
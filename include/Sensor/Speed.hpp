@@ -2,6 +2,7 @@
 
 // Project includes
 #include "ActiveSensor.hpp"
+#include "SpeedEstimator.hpp"
 
 // espidf includes
 #include "freertos/FreeRTOS.h"
@@ -9,10 +10,13 @@
 class Speed : public ActiveSensor
 {
 public:
-	Speed();
+	explicit Speed(gpio_num_t gpio);
 
 	int get() override;
 
+	// Speed in 0.01 km/h, as of the last get()
+	uint32_t getCentiKmh() const;
+
 	/*
 	 *	Public Callback functions
 	 */
@@ -24,9 +28,9 @@ private:
 	 */
 	volatile int64_t lastFallingEdgeTime_ = 0;
 	volatile int64_t fallingEdgeTime_ = 0;
+	volatile uint32_t pulseCount_ = 0;
 	portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
 
-	double hz_ = 0.0;
-
-	uint8_t kmh_ = 0;
+	SpeedEstimator estimator_;
+	int64_t nextLogUs_ = 0;
 };
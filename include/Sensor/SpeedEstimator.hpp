@@ -0,0 +1,101 @@
+#pragma once
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Class
+ */
+// Hardware independent speed estimation from the edges of the speed sensor.
+// Below the switching threshold the period between the last two edges is used, which reacts with every edge.
+// Above it the edges are counted over a gate, using the edge timestamps at the gate boundaries as time base
+// (reciprocal counting), which averages the jitter of the single periods.
+class SpeedEstimator
+{
+public:
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		PERIOD,
+		PULSE_COUNT
+	} MODE;
+
+	/*
+	 *	Public Struct
+	 */
+	struct Config
+	{
+		// Speed per edge frequency
+		float kmhPerHz = 1.0f;
+
+		// Hysteresis of the mode switching
+		float pulseCountAboveKmh = 30.0f;
+		float periodBelowKmh = 25.0f;
+
+		uint32_t gateUs = 100000;
+
+		// Without an edge for this long the vehicle is standing
+		uint32_t standstillUs = 1500000;
+	};
+
+	// Written by the ISR, passed in as a consistent copy
+	struct Edges
+	{
+		int64_t lastEdgeUs = 0;
+		int64_t previousEdgeUs = 0;
+		uint32_t pulseCount = 0;
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	explicit SpeedEstimator(const Config& config);
+
+	void update(int64_t nowUs, const Edges& edges);
+
+	// Speed in 0.01 km/h
+	uint32_t getCentiKmh() const;
+
+	// Speed rounded to km/h
+	int getKmh() const;
+
+	MODE getMode() const;
+
+	// Age of the measurement the current value is based on, from the middle of its window to the last update
+	uint32_t getLatencyUs() const;
+
+	// Length of the window the current value was measured over
+	uint32_t getWindowUs() const;
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	void updatePeriod(int64_t nowUs, const Edges& edges);
+
+	void updatePulseCount(int64_t nowUs, const Edges& edges);
+
+	void setResult(float kmh, int64_t windowStartUs, int64_t windowEndUs, int64_t nowUs);
+
+	void startGate(int64_t nowUs, const Edges& edges);
+
+	/*
+	 *	Private Variables
+	 */
+	Config config_;
+
+	MODE mode_ = PERIOD;
+
+	float kmh_ = 0.0f;
+
+	uint32_t latencyUs_ = 0;
+
+	uint32_t windowUs_ = 0;
+
+	// Gate of the pulse counting
+	int64_t gateStartUs_ = 0;
+	int64_t gateStartEdgeUs_ = 0;
+	uint32_t gateStartCount_ = 0;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Class
+ */
+// Hardware independent engine-off detection of the operation state.
+// The board goes idle after the engine was off (no RPM and no oil pressure) for a while and leaves it again as soon
+// as the engine runs or an external event (RPM edge, CAN frame) requests a wake up.
+class IdleMonitor
+{
+public:
+	/*
+	 *	Public enum
+	 */
+	typedef enum
+	{
+		ACTIVE,
+		IDLE
+	} STATE;
+
+	typedef enum
+	{
+		WAKE_NONE,
+		WAKE_ENGINE,
+		WAKE_RPM_EDGE,
+		WAKE_CAN_FRAME
+	} WAKE_REASON;
+
+	/*
+	 *	Public Struct
+	 */
+	struct Config
+	{
+		// How long the engine has to be off before going idle
+		int64_t idleAfterUs = 60000000;
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	explicit IdleMonitor(const Config& config);
+
+	// Feeds the latest sensor values. Returns true when the state changed
+	bool update(int64_t nowUs, int32_t rpm, int32_t oilPressure);
+
+	// Wake request caused by an event at eventUs which is handled at nowUs. Returns true when the state changed
+	bool wake(int64_t eventUs, int64_t nowUs, WAKE_REASON reason);
+
+	STATE getState() const;
+
+	bool isIdle() const;
+
+	WAKE_REASON getLastWakeReason() const;
+
+	// Time between the event and leaving the idle state, of the last and the slowest wake up
+	uint32_t getLastWakeLatencyUs() const;
+
+	uint32_t getMaxWakeLatencyUs() const;
+
+	uint32_t getWakeCount() const;
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	void leaveIdle(int64_t eventUs, int64_t nowUs, WAKE_REASON reason);
+
+	/*
+	 *	Private Variables
+	 */
+	Config config_;
+
+	STATE state_ = ACTIVE;
+
+	// Start of the current engine off phase, negative while the engine runs
+	int64_t engineOffSinceUs_ = -1;
+
+	WAKE_REASON lastWakeReason_ = WAKE_NONE;
+
+	uint32_t lastWakeLatencyUs_ = 0;
+
+	uint32_t maxWakeLatencyUs_ = 0;
+
+	uint32_t wakeCount_ = 0;
+};
@@ -1,11 +1,16 @@
 #pragma once
 
 // Project includes
+#include "Driver/EcuCanGateway.hpp"
+#include "State/IdleMonitor.hpp"
 #include "State/State.hpp"
-#include "Sensor/ActiveSensor.hpp"
-#include "Sensor/PassiveSensor.hpp"
+#include "Sensor/SensorRegistry.hpp"
+#include "Sensor/SignalStore.hpp"
 #include "WebInterface/WebInterface.hpp"
 
+// C++ includes
+#include <atomic>
+
 class Operation : public State
 {
 public:
@@ -22,7 +27,9 @@ public:
 	/*
 	 *	Private Tasks
 	 */
-	void readPassiveSensorsTask() const;
+	void readPassiveSensorsTask();
+
+	void sampleSensorsTask();
 
 	void broadcastSensorsTask() const;
 
@@ -32,6 +39,12 @@ private:
 	 */
 	void setupDisplayWifi() const;
 
+	void updateIdleState(int64_t nowUs, bool woken);
+
+	void applyIdleState();
+
+	void configurePowerManagement(bool idle) const;
+
 	/*
 	 *	Private Variables
 	 */
@@ -40,11 +53,28 @@ private:
 
 	TaskHandle_t readPassiveSensorsTaskHandle_;
 
+	TaskHandle_t sampleSensorsTaskHandle_;
+
 	TaskHandle_t broadCastSensorDataTaskHandle_;
 
-	std::vector<PassiveSensor*> passiveSensor_;
+	SensorRegistry sensors_;
 
-	std::vector<ActiveSensor*> activeSensor_;
+	EcuCanGateway ecuCanGateway_;
 
 	ArduinoJson::JsonDocument* config_ = nullptr;
+
+	SignalStore* signalStore_ = nullptr;
+
+	/*
+	 *	Idle mode
+	 */
+	IdleMonitor idleMonitor_{IdleMonitor::Config()};
+
+	std::atomic<bool> idle_ = false;
+
+	// Lower 32 bits of the time of the last wake up event
+	std::atomic<uint32_t> rpmEdgeUs_ = 0;
+	std::atomic<uint32_t> canFrameUs_ = 0;
+
+	std::atomic<bool> canWakePending_ = false;
 };
@@ -0,0 +1,103 @@
+#pragma once
+
+// C++ includes
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// espidf includes
+#include "esp_partition.h"
+
+/*
+ *	Public constexpr
+ */
+// Written by tools/WebAssets/pack_web_assets.py
+constexpr auto ASSET_ARCHIVE_PARTITION = "webassets";
+
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = 0x31534157; // "WAS1"
+
+constexpr uint8_t ASSET_ETAG_LENGTH = 16;
+
+/*
+ *	Class
+ */
+// Read only archive of the web interface, memory mapped from its own partition. Little endian layout:
+//
+//	Header	magic u32, count u32, names offset u32, data offset u32
+//	Index	count entries sorted by path: name offset u32, name length u16, flags u16, data offset u32,
+//			data length u32, ETag char[16]
+//	Names	the paths without terminator
+//	Data	the contents, each 4 byte aligned
+//
+// The offsets count from the start of the archive. Lookups are a binary search over the index and the contents are
+// handed out as pointers into the mapped flash, so nothing is copied or allocated.
+class AssetArchive
+{
+public:
+	/*
+	 *	Public Struct
+	 */
+	struct Asset
+	{
+		const uint8_t* data;
+		uint32_t size;
+
+		bool gzip;
+
+		// Unquoted
+		std::string_view etag;
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	AssetArchive() = default;
+
+	~AssetArchive();
+
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator=(const AssetArchive&) = delete;
+
+	// Maps the whole partition and checks the archive in it
+	bool map(const char* partitionLabel = ASSET_ARCHIVE_PARTITION);
+
+	// Uses an archive already in memory, which has to outlive this
+	bool open(const uint8_t* archive, size_t size);
+
+	// Path relative to the web root without leading slash, e.g. "js/websocket.js"
+	bool find(std::string_view path, Asset& asset) const;
+
+	uint32_t getCount() const;
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	struct IndexEntry
+	{
+		uint32_t nameOffset;
+		uint16_t nameLength;
+		uint16_t flags;
+		uint32_t dataOffset;
+		uint32_t dataLength;
+		char etag[ASSET_ETAG_LENGTH];
+	};
+	static_assert(sizeof(IndexEntry) == 32);
+
+	/*
+	 *	Private Functions
+	 */
+	std::string_view getName(const IndexEntry& entry) const;
+
+	/*
+	 *	Private Variables
+	 */
+	const uint8_t* archive_ = nullptr;
+	size_t size_ = 0;
+
+	const IndexEntry* index_ = nullptr;
+	uint32_t count_ = 0;
+
+	esp_partition_mmap_handle_t mmapHandle_ = 0;
+	bool mapped_ = false;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+// Project includes
+#include "Driver/EcuSensors.hpp"
+
+// C++ includes
+#include <array>
+#include <cstdint>
+#include <iterator>
+
+/*
+ *	Public constexpr
+ */
+// First byte of every binary websocket frame
+constexpr uint8_t WS_BINARY_SENSOR_UPDATE = 0x01;
+
+// Type, sample count and the board time in ms
+constexpr uint8_t SENSOR_UPDATE_HEADER_LENGTH = 6;
+
+// Sensor id, age in ms and the value
+constexpr uint8_t SENSOR_UPDATE_SAMPLE_LENGTH = 8;
+
+// Values are sent as fixed-point with 3 decimals
+constexpr int32_t SENSOR_UPDATE_VALUE_SCALE = 1000;
+
+constexpr uint8_t SENSOR_UPDATE_MAX_SAMPLES = std::size(ECU_SENSORS);
+
+/*
+ *	Class
+ */
+// Binary sensor update for the websocket, decoded by the browser with a DataView. All fields are little endian:
+// type (u8), sample count (u8), board time in ms (u32), then per sample the sensor id (u16), the age of the value
+// relative to the board time in ms (u16, saturated) and the value (i32, fixed-point)
+class SensorUpdateFrame
+{
+public:
+	explicit SensorUpdateFrame(int64_t nowMs);
+
+	// Returns false if the frame is full
+	bool add(uint16_t sensorId, int64_t timestampMs, double value);
+
+	uint8_t getSampleCount() const;
+
+	const uint8_t* getData() const;
+
+	size_t getLength() const;
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	void write16(uint16_t value);
+
+	void write32(uint32_t value);
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<uint8_t, SENSOR_UPDATE_HEADER_LENGTH + SENSOR_UPDATE_MAX_SAMPLES * SENSOR_UPDATE_SAMPLE_LENGTH> data_ = {};
+	size_t length_ = 0;
+
+	int64_t nowMs_ = 0;
+};
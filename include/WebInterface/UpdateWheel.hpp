@@ -0,0 +1,83 @@
+#pragma once
+
+// C++ includes
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ *	Public constexpr
+ */
+// Resolution of the update rates, 20 Hz at most
+constexpr uint32_t UPDATE_WHEEL_TICK_MS = 50;
+
+// One revolution covers 3.2 s, longer periods wait for multiple revolutions
+constexpr uint16_t UPDATE_WHEEL_SLOTS = 64;
+
+/*
+ *	Class
+ */
+// Hashed timer wheel of the websocket sensor subscriptions. Every subscription of a client is sent with its own
+// period: the wheel advances one slot per tick and only the items of that slot are looked at, so a tick costs the
+// number of due items instead of the number of subscriptions.
+class UpdateWheel
+{
+public:
+	/*
+	 *	Public Struct
+	 */
+	struct Item
+	{
+		int client;
+		uint16_t sensorId;
+
+		uint16_t periodTicks;
+
+		// Revolutions left until the item is due
+		uint16_t rounds;
+
+		// Timestamp of the value sent last, so unchanged values aren't sent again
+		int64_t lastTimestampUs;
+	};
+
+	/*
+	 *	Public typedefs
+	 */
+	typedef void (*DueCallback)(Item& item, void* ctx);
+
+	/*
+	 *	Public Functions
+	 */
+	UpdateWheel() = default;
+
+	// Replaces the period of an existing item. A new item is due with the next tick
+	void add(int client, uint16_t sensorId, uint32_t periodMs);
+
+	void remove(int client, uint16_t sensorId);
+
+	void removeClient(int client);
+
+	// Returns 0 if the client doesn't track the sensor
+	uint32_t getPeriodMs(int client, uint16_t sensorId) const;
+
+	// Advances the wheel by one tick and calls the callback for every due item before it's rescheduled
+	void tick(DueCallback callback, void* ctx);
+
+private:
+	/*
+	 *	Private Functions
+	 */
+	// Relative to the slot that was processed last
+	void schedule(const Item& item, uint16_t ticks);
+
+	Item* find(int client, uint16_t sensorId);
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<std::vector<Item>, UPDATE_WHEEL_SLOTS> slots_;
+	uint16_t cursor_ = 0;
+
+	// Kept to not allocate on every tick
+	std::vector<Item> due_;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+// C++ includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+// espidf includes
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+/*
+ *	Public constexpr
+ */
+// A multiple of the SD sector size, so every write but the last one covers whole sectors
+constexpr size_t UPLOAD_BUFFER_B = 16 * 1024;
+
+constexpr uint8_t UPLOAD_BUFFER_COUNT = 2;
+
+constexpr uint8_t UPLOAD_SHA256_LENGTH = 32;
+
+/*
+ *	Class
+ */
+// Streams the body of an upload into a file. While the httpd task receives into one buffer, a writer task writes the
+// other one, so the network and the SD card work at the same time. The SHA-256 of the body is computed on the way.
+class UploadPipeline
+{
+public:
+	/*
+	 *	Public Struct
+	 */
+	struct Result
+	{
+		size_t bytes = 0;
+		uint32_t durationUs = 0;
+
+		// Time the receiver waited for the writer to free a buffer
+		uint32_t writerWaitUs = 0;
+
+		std::array<uint8_t, UPLOAD_SHA256_LENGTH> sha256 = {};
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	UploadPipeline() = default;
+
+	~UploadPipeline();
+
+	UploadPipeline(const UploadPipeline&) = delete;
+	UploadPipeline& operator=(const UploadPipeline&) = delete;
+
+	// Receives the whole body into the file, which is preallocated to the content length. Returns false if receiving
+	// or writing failed, the file is left open either way
+	bool run(httpd_req_t* p_reqst, FILE* file, Result& result);
+
+	/*
+	 *	Private Tasks
+	 */
+	void writerTask();
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	struct Chunk
+	{
+		uint8_t bufferIndex;
+
+		// 0 ends the writer
+		size_t length;
+	};
+
+	/*
+	 *	Private Functions
+	 */
+	bool allocate();
+
+	void release();
+
+	/*
+	 *	Private Variables
+	 */
+	std::array<uint8_t*, UPLOAD_BUFFER_COUNT> buffers_ = {};
+
+	// Filled buffers to the writer and written ones back
+	QueueHandle_t filledQueue_ = nullptr;
+	QueueHandle_t freeQueue_ = nullptr;
+
+	TaskHandle_t writerTaskHandle_ = nullptr;
+	TaskHandle_t receiverTaskHandle_ = nullptr;
+
+	FILE* file_ = nullptr;
+	std::atomic<bool> writeFailed_ = false;
+};
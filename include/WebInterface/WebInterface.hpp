@@ -3,7 +3,14 @@
 // Project includes
 #include "WifiHost.hpp"
 #include "WifiJoin.hpp"
-#include "Driver/KLine.hpp"
+#include "Driver/EcuPollScheduler.hpp"
+#include "WebInterface/UpdateWheel.hpp"
+#include "WebInterface/WebsocketOutbox.hpp"
+
+// C++ includes
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // espidf includes
 #include "esp_http_server.h"
@@ -11,15 +18,36 @@
 class WebInterface
 {
 public:
+	/*
+	 *	Public enum
+	 */
+	// Format of the sensor updates, negotiated by the client right after connecting
+	typedef enum
+	{
+		PROTOCOL_JSON,
+		PROTOCOL_BINARY
+	} PROTOCOL;
+
 	WebInterface();
 
+	// Replies to a request, sent right away since it's called from the httpd task
 	void send(int clientFD, const std::string& data) const;
 
+	// JSON unless the client asked for the binary protocol
+	PROTOCOL getProtocol(int clientFD) const;
+
 	std::unordered_map<int, std::vector<uint16_t>>& getTrackedSensors();
 
 	SemaphoreHandle_t& getSensorsMutex();
 
-	KLine* getKLine();
+	// Poll subscriber of the client, -1 if it doesn't track any sensor
+	int8_t getPollSubscriber(int clientFD) const;
+
+	// Schedule of the sensor updates of all clients, guarded by the sensors mutex
+	UpdateWheel& getUpdateWheel();
+
+	// Queues the sensor updates of the clients
+	WebsocketOutbox& getOutbox();
 
 	/*
 	 *	Private ISRs
@@ -37,6 +65,10 @@ private:
 	 */
 	void sendAllSensors(int clientFD) const;
 
+	// Polls the address with the fastest rate of the client's sensors decoded from it, or stops polling it. Needs
+	// to hold the sensors mutex
+	void resubscribe(int clientFD, uint16_t address);
+
 	/*
 	 *	Private Variables
 	 */
@@ -49,7 +81,10 @@ private:
 	std::unordered_map<int, std::vector<uint16_t>> trackedSensors_;
 	TaskHandle_t updateSensorsDataTask_ = nullptr;
 
-	FILE* displayUpdateFile_ = nullptr;
+	std::unordered_map<int, int8_t> pollSubscribers_;
+	std::unordered_map<int, PROTOCOL> protocols_;
+	UpdateWheel updateWheel_;
+	WebsocketOutbox outbox_;
 
-	KLine kline_;
+	EcuPollScheduler* ecuPollScheduler_ = nullptr;
 };
@@ -0,0 +1,174 @@
+#pragma once
+
+// C++ includes
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// espidf includes
+#include "esp_http_server.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/*
+ *	Public constexpr
+ */
+// A JSON update of every sensor fits into one buffer
+constexpr uint16_t WS_SEND_BUFFER_B = 4096;
+constexpr uint8_t WS_SEND_BUFFER_COUNT = 12;
+
+// More than the httpd accepts sockets
+constexpr uint8_t WS_MAX_CLIENTS = 8;
+
+// Frames waiting per client, the oldest one is dropped for a new one
+constexpr uint8_t WS_CLIENT_QUEUE_DEPTH = 4;
+
+// A client whose socket takes nothing for this long is closed
+constexpr int64_t WS_STALL_TIMEOUT_US = 10000000;
+
+// Stalled clients are checked and leftover bytes are sent with this period, also while there are no updates
+constexpr uint64_t WS_CHECK_PERIOD_US = 500000;
+
+// Bytes the socket didn't take yet, a client with more than this is closed
+constexpr size_t WS_MAX_PENDING_B = 2 * WS_SEND_BUFFER_B;
+
+/*
+ *	Class
+ */
+// Outbound path of the websocket telemetry. The frames are written into buffers of a pool allocated once and shared
+// by every client they are queued for. Each client has a bounded queue, which is drained by the httpd task as long as
+// the socket of the client takes data. A slow client only loses its own oldest updates instead of piling up work and
+// heap for everyone, and one that takes nothing at all is closed.
+// The sockets of the clients are written without blocking, so a full socket never holds up the httpd task. What it
+// doesn't take is kept and sent before anything else.
+class WebsocketOutbox
+{
+public:
+	/*
+	 *	Public Struct
+	 */
+	struct Buffer
+	{
+		uint8_t* data;
+		size_t length;
+		bool binary;
+
+		// Queues holding the buffer, it returns to the pool with the last one
+		uint8_t references;
+	};
+
+	struct ClientMetrics
+	{
+		uint32_t sent = 0;
+		uint32_t dropped = 0;
+		uint32_t failed = 0;
+
+		// From queueing a frame until it was handed to the socket
+		uint32_t lastLagUs = 0;
+		uint32_t maxLagUs = 0;
+
+		// -1 while the socket takes data
+		int64_t stalledSinceUs = -1;
+	};
+
+	/*
+	 *	Public Functions
+	 */
+	WebsocketOutbox() = default;
+
+	~WebsocketOutbox();
+
+	WebsocketOutbox(const WebsocketOutbox&) = delete;
+	WebsocketOutbox& operator=(const WebsocketOutbox&) = delete;
+
+	// Allocates the pool, preferably in the PSRAM
+	bool init(httpd_handle_t httpdHandle);
+
+	// Returns nullptr while every buffer is queued
+	Buffer* acquire();
+
+	// Returns a buffer that wasn't queued
+	void release(Buffer* buffer);
+
+	// Queues the buffer for every client, or releases it if none takes it
+	void enqueue(const std::vector<int>& clientFDs, Buffer* buffer);
+
+	void removeClient(int clientFD);
+
+	std::string toJson(int64_t nowUs) const;
+
+	/*
+	 *	Private Tasks
+	 */
+	// Runs in the httpd task
+	void drain();
+
+	// Runs in the esp_timer task
+	void check();
+
+private:
+	/*
+	 *	Private Struct
+	 */
+	struct Entry
+	{
+		Buffer* buffer;
+		int64_t queuedUs;
+	};
+
+	struct Client
+	{
+		int fd = -1;
+
+		// Ring buffer
+		std::array<Entry, WS_CLIENT_QUEUE_DEPTH> queue = {};
+		uint8_t head = 0;
+		uint8_t count = 0;
+
+		// Replaces the blocking send of the httpd for the socket
+		bool sendOverridden = false;
+
+		// Bytes of earlier frames the socket didn't take yet
+		std::vector<uint8_t> pending;
+
+		ClientMetrics metrics;
+	};
+
+	/*
+	 *	Private Functions
+	 */
+	// Need to hold the mutex
+	Client* findClient(int clientFD, bool add);
+	void unreference(Buffer* buffer);
+
+	// Queues a drain unless one is queued already
+	void queueDrain();
+
+	// Need to hold the mutex. Sends as much of the pending bytes as the socket takes, returns false if some are left
+	static bool flushPending(Client& client, int64_t nowUs);
+
+	// Send function of the httpd for the sockets of the clients
+	int sendWithoutBlocking(int clientFD, const char* data, size_t length);
+
+	static int staticSend(httpd_handle_t httpdHandle, int clientFD, const char* data, size_t length, int flags);
+
+	/*
+	 *	Private Variables
+	 */
+	httpd_handle_t httpdHandle_ = nullptr;
+
+	SemaphoreHandle_t mutex_ = nullptr;
+	esp_timer_handle_t checkTimer_ = nullptr;
+
+	uint8_t* memory_ = nullptr;
+	std::array<Buffer, WS_SEND_BUFFER_COUNT> buffers_ = {};
+	uint8_t freeBuffers_ = 0;
+	uint32_t poolExhausted_ = 0;
+
+	std::array<Client, WS_MAX_CLIENTS> clients_ = {};
+
+	// At most one drain is queued in the httpd task
+	bool drainQueued_ = false;
+};
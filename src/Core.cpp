@@ -17,7 +17,51 @@ constexpr auto CONFIG_NAME = "config.json";
 constexpr gpio_num_t GPIO_CAN_RX = GPIO_NUM_41;
 constexpr gpio_num_t GPIO_CAN_TX = GPIO_NUM_40;
 
-constexpr adc_oneshot_unit_init_cfg_t adc1UnitConfig_ = {.unit_id = ADC_UNIT_1, .ulp_mode = ADC_ULP_MODE_DISABLE};
+constexpr uint32_t DEFAULT_ECU_CACHE_TTL_MS = 1000;
+
+/*
+ *	Private Static Functions
+ */
+static void onEcuIdResponse(const KLine::Response& response, void* ctx)
+{
+	// SID, address and 4 ASCII chars
+	if (response.result != KLine::RESULT_OK || response.payloadLength < 7) {
+		ESP_LOGW(TAG, "Failed to read the ECU ID");
+		return;
+	}
+
+	const std::string id(reinterpret_cast<const char*>(response.payload + 3), 4);
+	ESP_LOGI(TAG, "ECU ID: %s", id.c_str());
+}
+
+// Reads the "KLine" section of the config, missing entries keep their default. Times are given in ms
+static KLine::Timing readKLineTiming(const ArduinoJson::JsonDocument* config)
+{
+	KLine::Timing timing;
+	if (config == nullptr) {
+		return timing;
+	}
+
+	const ArduinoJson::JsonVariantConst kline = (*config)["KLine"];
+	const auto readUs = [&kline](const char* key, uint32_t& value) {
+		if (kline[key].is<float>()) {
+			value = static_cast<uint32_t>(kline[key].as<float>() * 1000.0f);
+		}
+	};
+
+	if (kline["baudRate"].is<uint32_t>()) {
+		timing.baudRate = kline["baudRate"].as<uint32_t>();
+	}
+	readUs("p1MaxMs", timing.p1MaxUs);
+	readUs("p2MaxMs", timing.p2MaxUs);
+	readUs("p3MinMs", timing.p3MinUs);
+	readUs("p4MinMs", timing.p4MinUs);
+	timing.adaptive = kline["adaptive"] | timing.adaptive;
+	timing.fastInit = kline["fastInit"] | timing.fastInit;
+	readUs("keepAliveMs", timing.keepAliveUs);
+
+	return timing;
+}
 
 /*
  *	Static Variable Initializations
@@ -51,9 +95,14 @@ std::vector<Display>* Core::getDisplays()
 	return &displays_;
 }
 
-adc_oneshot_unit_handle_t* Core::getAdc()
+AdcManager* Core::getAdc()
+{
+	return &adc_;
+}
+
+SignalStore* Core::getSignalStore()
 {
-	return &adc1Handle_;
+	return &signalStore_;
 }
 
 ArduinoJson::JsonDocument* Core::getConfig() const {
@@ -89,6 +138,26 @@ Can* Core::getCan() const
 	return can_;
 }
 
+KLine* Core::getKLine() const
+{
+	return kline_;
+}
+
+EcuPollScheduler* Core::getEcuPollScheduler() const
+{
+	return ecuPollScheduler_;
+}
+
+EcuValueCache* Core::getEcuValueCache() const
+{
+	return ecuValueCache_;
+}
+
+EcuDtcReader* Core::getEcuDtcReader() const
+{
+	return ecuDtcReader_;
+}
+
 /*
  *	Private Function Implementations
  */
@@ -100,8 +169,8 @@ Core::Core()
 	can_->enable();
 
 	// Sensors
-	if (adc_oneshot_new_unit(&adc1UnitConfig_, &adc1Handle_) != ESP_OK) {
-		ESP_LOGE(TAG, "Failed to initialize ADC1");
+	if (!adc_.init()) {
+		ESP_LOGE(TAG, "Failed to initialize the ADCs");
 	}
 
 	// Create default config, if config doesnt exist
@@ -128,4 +197,26 @@ Core::Core()
 		serializeJsonPretty(*jsonConfig_, str);
 		ESP_LOGI(TAG, "%s", str.c_str());
 	}
+
+	// ECU
+	uint32_t ecuCacheTtlMs = DEFAULT_ECU_CACHE_TTL_MS;
+	if (jsonConfig_ != nullptr && (*jsonConfig_)["Ecu"]["cacheTtlMs"].is<uint32_t>()) {
+		ecuCacheTtlMs = (*jsonConfig_)["Ecu"]["cacheTtlMs"].as<uint32_t>();
+	}
+	uint8_t maxPidsPerRead = KLINE_MAX_PIDS_PER_READ;
+	if (jsonConfig_ != nullptr && (*jsonConfig_)["Ecu"]["maxPidsPerRead"].is<uint8_t>()) {
+		maxPidsPerRead = (*jsonConfig_)["Ecu"]["maxPidsPerRead"].as<uint8_t>();
+	}
+
+	kline_ = new KLine(readKLineTiming(jsonConfig_));
+	kline_->readEcuId(onEcuIdResponse, nullptr);
+	ecuValueCache_ = new EcuValueCache(ecuCacheTtlMs);
+	ecuPollScheduler_ = new EcuPollScheduler(kline_, ecuValueCache_, maxPidsPerRead);
+
+	// The cache is the first listener, so every other one already finds the new value in it
+	ecuPollScheduler_->addListener(EcuValueCache::staticOnResult, ecuValueCache_);
+
+	// Initial read of the fault codes, afterwards only on demand
+	ecuDtcReader_ = new EcuDtcReader(ecuPollScheduler_);
+	ecuDtcReader_->refresh();
 }
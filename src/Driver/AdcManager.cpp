@@ -0,0 +1,217 @@
+#include "Driver/AdcManager.hpp"
+
+// espidf includes
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "AdcManager";
+
+// Wi-Fi blocks ADC2 only for short bursts, so the conversion is retried a few times with a small gap
+constexpr uint8_t ADC2_MAX_ATTEMPTS = 5;
+constexpr uint32_t ADC2_RETRY_DELAY_US = 100;
+
+/*
+ *	Public Function Implementations
+ */
+AdcManager::~AdcManager()
+{
+	for (uint8_t i = 0; i < channelCount_; i++) {
+		if (channels_[i].calibration != nullptr) {
+			adc_cali_delete_scheme_curve_fitting(channels_[i].calibration);
+		}
+	}
+
+	for (const adc_oneshot_unit_handle_t unit : units_) {
+		if (unit != nullptr) {
+			adc_oneshot_del_unit(unit);
+		}
+	}
+}
+
+bool AdcManager::init()
+{
+	bool success = true;
+
+	for (uint8_t i = 0; i < units_.size(); i++) {
+		const adc_oneshot_unit_init_cfg_t unitConfig = {
+			.unit_id = static_cast<adc_unit_t>(ADC_UNIT_1 + i),
+			.ulp_mode = ADC_ULP_MODE_DISABLE,
+		};
+
+		if (adc_oneshot_new_unit(&unitConfig, &units_[i]) != ESP_OK) {
+			ESP_LOGE(TAG, "Failed to initialize ADC%d", i + 1);
+			units_[i] = nullptr;
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+int8_t AdcManager::addChannel(const gpio_num_t gpio, const adc_atten_t atten)
+{
+	if (channelCount_ >= MAX_ADC_CHANNELS) {
+		ESP_LOGE(TAG, "No ADC channel left for GPIO %d", gpio);
+		return -1;
+	}
+
+	Channel& channel = channels_[channelCount_];
+	channel = {};
+	channel.gpio = gpio;
+
+	// Resolve the unit & channel
+	if (adc_oneshot_io_to_channel(gpio, &channel.unit, &channel.channel) != ESP_OK) {
+		ESP_LOGE(TAG, "GPIO %d is not connected to an ADC", gpio);
+		return -1;
+	}
+
+	const adc_oneshot_unit_handle_t unit = units_[channel.unit - ADC_UNIT_1];
+	if (unit == nullptr) {
+		ESP_LOGE(TAG, "ADC%d of GPIO %d isn't initialized", channel.unit + 1, gpio);
+		return -1;
+	}
+
+	// Configure the channel
+	const adc_oneshot_chan_cfg_t channelConfig = {.atten = atten, .bitwidth = ADC_BITWIDTH_DEFAULT};
+	if (adc_oneshot_config_channel(unit, channel.channel, &channelConfig) != ESP_OK) {
+		ESP_LOGE(TAG, "Couldn't configure ADC%d channel %d", channel.unit + 1, channel.channel);
+		return -1;
+	}
+
+	// Calibrate
+	const adc_cali_curve_fitting_config_t calibrationConfig = {
+		.unit_id = channel.unit,
+		.chan = channel.channel,
+		.atten = atten,
+		.bitwidth = ADC_BITWIDTH_DEFAULT,
+	};
+	if (adc_cali_create_scheme_curve_fitting(&calibrationConfig, &channel.calibration) != ESP_OK) {
+		ESP_LOGE(TAG, "Couldn't calibrate ADC%d channel %d", channel.unit + 1, channel.channel);
+		return -1;
+	}
+
+	if (channel.unit == ADC_UNIT_2) {
+		ESP_LOGW(TAG, "GPIO %d is on ADC2 which is shared with Wi-Fi. Prefer a GPIO of ADC1", gpio);
+	}
+
+	ESP_LOGI(TAG, "GPIO %d uses ADC%d channel %d", gpio, channel.unit + 1, channel.channel);
+
+	return static_cast<int8_t>(channelCount_++);
+}
+
+esp_err_t AdcManager::readMv(const int8_t id, const uint8_t conversions, int& mv)
+{
+	if (!isValid(id)) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	Channel& channel = channels_[id];
+	ChannelStats& stats = channel.stats;
+
+	const int64_t startUs = esp_timer_get_time();
+
+	int raw = 0;
+	uint8_t successfulConversions = 0;
+	uint32_t rawSum = 0;
+	esp_err_t result = ESP_OK;
+	for (uint8_t i = 0; i < conversions; i++) {
+		bool wifiConflict = false;
+		const esp_err_t conversionResult = convert(channel, raw, wifiConflict);
+
+		stats.reads++;
+		stats.wifiConflicts += wifiConflict;
+		if (conversionResult != ESP_OK) {
+			stats.failures++;
+			result = conversionResult;
+			continue;
+		}
+
+		successfulConversions++;
+		rawSum += raw;
+	}
+
+	stats.lastLatencyUs = static_cast<uint32_t>(esp_timer_get_time() - startUs);
+	if (stats.lastLatencyUs > stats.maxLatencyUs) {
+		stats.maxLatencyUs = stats.lastLatencyUs;
+	}
+
+	if (successfulConversions == 0) {
+		stats.lastError = result == ESP_OK ? ESP_FAIL : result;
+		return stats.lastError;
+	}
+
+	stats.lastError = adc_cali_raw_to_voltage(channel.calibration, rawSum / successfulConversions, &mv);
+	return stats.lastError;
+}
+
+adc_unit_t AdcManager::getUnit(const int8_t id) const
+{
+	return isValid(id) ? channels_[id].unit : ADC_UNIT_1;
+}
+
+adc_channel_t AdcManager::getChannel(const int8_t id) const
+{
+	return isValid(id) ? channels_[id].channel : ADC_CHANNEL_0;
+}
+
+gpio_num_t AdcManager::getGpio(const int8_t id) const
+{
+	return isValid(id) ? channels_[id].gpio : GPIO_NUM_NC;
+}
+
+AdcManager::ChannelStats AdcManager::getStats(const int8_t id) const
+{
+	return isValid(id) ? channels_[id].stats : ChannelStats();
+}
+
+uint8_t AdcManager::getChannelCount() const
+{
+	return channelCount_;
+}
+
+void AdcManager::logStats() const
+{
+	for (uint8_t i = 0; i < channelCount_; i++) {
+		const Channel& channel = channels_[i];
+		const ChannelStats& stats = channel.stats;
+
+		ESP_LOGI(TAG, "GPIO %d (ADC%d/%d): %lu reads, %lu failed, %lu wifi conflicts, latency %lu us (max %lu us), %s",
+		         channel.gpio, channel.unit + 1, channel.channel, stats.reads, stats.failures, stats.wifiConflicts,
+		         stats.lastLatencyUs, stats.maxLatencyUs, esp_err_to_name(stats.lastError));
+	}
+}
+
+/*
+ *	Private Function Implementations
+ */
+esp_err_t AdcManager::convert(Channel& channel, int& raw, bool& wifiConflict) const
+{
+	const adc_oneshot_unit_handle_t unit = units_[channel.unit - ADC_UNIT_1];
+
+	// ADC1 isn't shared, so only one attempt is needed
+	const uint8_t attempts = channel.unit == ADC_UNIT_2 ? ADC2_MAX_ATTEMPTS : 1;
+
+	esp_err_t result = ESP_FAIL;
+	for (uint8_t attempt = 0; attempt < attempts; attempt++) {
+		result = adc_oneshot_read(unit, channel.channel, &raw);
+
+		// Lost the arbitration against Wi-Fi
+		if (result != ESP_ERR_TIMEOUT) {
+			break;
+		}
+
+		wifiConflict = true;
+		esp_rom_delay_us(ADC2_RETRY_DELAY_US);
+	}
+
+	return result;
+}
+
+bool AdcManager::isValid(const int8_t id) const
+{
+	return id >= 0 && id < channelCount_;
+}
@@ -0,0 +1,307 @@
+#include "Driver/EcuCanGateway.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+
+// espidf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "EcuCanGateway";
+
+constexpr auto JSON_GATEWAY = "Gateway";
+constexpr auto JSON_FRAMES = "Frames";
+constexpr auto JSON_DTC = "Dtc";
+
+// Keeps the gateway from flooding the K-Line and the bus
+constexpr uint32_t MIN_PERIOD_MS = 50;
+constexpr uint32_t DEFAULT_PERIOD_MS = 100;
+
+// The fault codes rarely change
+constexpr uint32_t DEFAULT_DTC_PERIOD_MS = 1000;
+
+constexpr uint8_t CAN_DATA_LENGTH = 8;
+
+/*
+ *	Private Static Tasks
+ */
+static void staticPublishTask(void* param)
+{
+	if (param == nullptr) {
+		vTaskDelete(nullptr);
+	}
+
+	static_cast<EcuCanGateway*>(param)->publishTask();
+}
+
+/*
+ *	Public Function Implementations
+ */
+EcuCanGateway::~EcuCanGateway()
+{
+	stop();
+}
+
+void EcuCanGateway::compile(const ArduinoJson::JsonDocument* config)
+{
+	frameCount_ = 0;
+	dtcFunction_ = 0;
+
+	if (config == nullptr) {
+		return;
+	}
+
+	const ArduinoJson::JsonVariantConst dtc = (*config)[JSON_GATEWAY][JSON_DTC];
+	if (dtc["function"].is<uint8_t>() && dtc["function"].as<uint8_t>() != CanFrame::SENSOR::BROADCAST_DATA) {
+		dtcFunction_ = dtc["function"].as<uint8_t>();
+		dtcPeriodUs_ = std::max<uint32_t>(dtc["periodMs"] | DEFAULT_DTC_PERIOD_MS, MIN_PERIOD_MS) * 1000;
+	}
+
+	if (!(*config)[JSON_GATEWAY][JSON_FRAMES].is<ArduinoJson::JsonArrayConst>()) {
+		return;
+	}
+
+	for (const ArduinoJson::JsonObjectConst entry :
+	     (*config)[JSON_GATEWAY][JSON_FRAMES].as<ArduinoJson::JsonArrayConst>()) {
+		if (frameCount_ >= MAX_GATEWAY_FRAMES) {
+			ESP_LOGW(TAG, "Too many frames. Only %d are supported", MAX_GATEWAY_FRAMES);
+			break;
+		}
+
+		EcuGatewayFrame& frame = frames_[frameCount_];
+		frame = {};
+		if (compileFrame(entry, frame)) {
+			frameCount_++;
+		}
+	}
+
+	ESP_LOGI(TAG, "Compiled %d frames", frameCount_);
+}
+
+void EcuCanGateway::start(Can* can, EcuPollScheduler* scheduler, const EcuValueCache* cache,
+                          const EcuDtcReader* dtcReader)
+{
+	if (dtcReader == nullptr) {
+		dtcFunction_ = 0;
+	}
+
+	if ((frameCount_ == 0 && dtcFunction_ == 0) || publishTaskHandle_ != nullptr || can == nullptr ||
+	    scheduler == nullptr || cache == nullptr) {
+		return;
+	}
+
+	can_ = can;
+	scheduler_ = scheduler;
+	cache_ = cache;
+	dtcReader_ = dtcReader;
+
+	subscriber_ = scheduler_->addSubscriber();
+	if (subscriber_ < 0) {
+		ESP_LOGE(TAG, "No poll subscriber left");
+		return;
+	}
+	subscribe();
+
+	const int64_t nowUs = esp_timer_get_time();
+	for (uint8_t i = 0; i < frameCount_; i++) {
+		nextSendUs_[i] = nowUs + frames_[i].periodUs;
+	}
+	nextDtcSendUs_ = nowUs + dtcPeriodUs_;
+
+	if (xTaskCreate(staticPublishTask, "EcuCanGatewayTask", 2048 * 2, this, 2, &publishTaskHandle_) != pdPASS) {
+		ESP_LOGE(TAG, "Failed to create the publish task");
+		publishTaskHandle_ = nullptr;
+	}
+}
+
+void EcuCanGateway::stop()
+{
+	if (publishTaskHandle_ != nullptr) {
+		vTaskDelete(publishTaskHandle_);
+		publishTaskHandle_ = nullptr;
+	}
+
+	if (scheduler_ != nullptr && subscriber_ >= 0) {
+		scheduler_->removeSubscriber(subscriber_);
+		subscriber_ = -1;
+	}
+}
+
+uint8_t EcuCanGateway::getFrameCount() const
+{
+	return frameCount_;
+}
+
+void EcuCanGateway::publishTask()
+{
+	Can::Frame frame;
+
+	while (true) {
+		const int64_t nowUs = esp_timer_get_time();
+		int64_t nextUs = nowUs + DEFAULT_PERIOD_MS * 1000;
+
+		for (uint8_t i = 0; i < frameCount_; i++) {
+			if (nowUs >= nextSendUs_[i]) {
+				if (buildFrame(frames_[i], nowUs, frame)) {
+					can_->queueFrame(frame);
+				}
+
+				// Keep the phase, but don't try to catch up on missed periods
+				nextSendUs_[i] = std::max<int64_t>(nextSendUs_[i] + frames_[i].periodUs, nowUs);
+			}
+
+			nextUs = std::min(nextUs, nextSendUs_[i]);
+		}
+
+		if (dtcFunction_ != 0) {
+			if (nowUs >= nextDtcSendUs_) {
+				if (buildDtcFrame(frame)) {
+					can_->queueFrame(frame);
+				}
+
+				nextDtcSendUs_ = std::max<int64_t>(nextDtcSendUs_ + dtcPeriodUs_, nowUs);
+			}
+
+			nextUs = std::min(nextUs, nextDtcSendUs_);
+		}
+
+		vTaskDelay(std::max<TickType_t>(pdMS_TO_TICKS((nextUs - nowUs) / 1000), 1));
+	}
+}
+
+/*
+ *	Private Function Implementations
+ */
+bool EcuCanGateway::compileFrame(const ArduinoJson::JsonObjectConst entry, EcuGatewayFrame& frame) const
+{
+	if (!entry["function"].is<uint8_t>() || entry["function"].as<uint8_t>() == CanFrame::SENSOR::BROADCAST_DATA) {
+		ESP_LOGW(TAG, "Ignoring frame without a function or with the one of the sensor broadcast");
+		return false;
+	}
+
+	frame.function = entry["function"].as<uint8_t>();
+	frame.periodUs = std::max<uint32_t>(entry["periodMs"] | DEFAULT_PERIOD_MS, MIN_PERIOD_MS) * 1000;
+
+	// Bit n is set if byte n is taken
+	uint8_t usedBytes = 0;
+
+	for (const ArduinoJson::JsonObjectConst signal : entry["signals"].as<ArduinoJson::JsonArrayConst>()) {
+		if (frame.signalCount >= MAX_GATEWAY_SIGNALS) {
+			ESP_LOGW(TAG, "Too many signals in frame %d", frame.function);
+			break;
+		}
+
+		const char* name = signal["signal"] | "";
+		const EcuSensor* sensor = findEcuSensor(name);
+		const uint8_t byte = signal["byte"] | CAN_DATA_LENGTH;
+		const uint8_t length = signal["length"] | 1;
+		if (sensor == nullptr || (length != 1 && length != 2) || byte + length > CAN_DATA_LENGTH) {
+			ESP_LOGW(TAG, "Ignoring unknown or misplaced signal %s in frame %d", name, frame.function);
+			continue;
+		}
+
+		// Only in range after the check above
+		const uint8_t bytes = static_cast<uint8_t>(((1u << length) - 1) << byte);
+		if ((usedBytes & bytes) != 0) {
+			ESP_LOGW(TAG, "Ignoring signal %s overlapping another one in frame %d", name, frame.function);
+			continue;
+		}
+		usedBytes |= bytes;
+
+		frame.signals[frame.signalCount++] = {
+			.sensor = sensor,
+			.byte = byte,
+			.length = length,
+			.factor = signal["factor"] | 1.0f,
+			.offset = signal["offset"] | 0.0f,
+		};
+		frame.dataLength = std::max<uint8_t>(frame.dataLength, byte + length);
+	}
+
+	return frame.signalCount > 0;
+}
+
+bool EcuCanGateway::buildFrame(const EcuGatewayFrame& gatewayFrame, const int64_t nowUs, Can::Frame& frame) const
+{
+	frame = {};
+	frame.sender = CAN_MASTER_ID;
+	frame.target = CAN_BROADCAST_ID;
+	frame.group = CanFrame::GROUP::SENSOR;
+	frame.function = gatewayFrame.function;
+	frame.dataLengthCode = gatewayFrame.dataLength;
+	frame.answer = false;
+
+	EcuValueCache::Value value;
+	for (uint8_t i = 0; i < gatewayFrame.signalCount; i++) {
+		const EcuGatewaySignal& signal = gatewayFrame.signals[i];
+		if (!cache_->getFresh(signal.sensor->address, nowUs, value)) {
+			return false;
+		}
+
+		const double encoded = std::round(signal.sensor->convert(value.rawValue) * signal.factor + signal.offset);
+		const double max = signal.length == 1 ? UINT8_MAX : UINT16_MAX;
+		const auto field = static_cast<uint16_t>(std::clamp(encoded, 0.0, max));
+
+		if (signal.length == 1) {
+			frame.data[signal.byte] = field;
+		}
+		else {
+			frame.data[signal.byte] = field >> 8;
+			frame.data[signal.byte + 1] = field & 0xFF;
+		}
+	}
+
+	return true;
+}
+
+bool EcuCanGateway::buildDtcFrame(Can::Frame& frame) const
+{
+	EcuDtc dtcs[MAX_ECU_DTCS];
+	int64_t readUs;
+	const uint8_t count = dtcReader_->getDtcs(dtcs, MAX_ECU_DTCS, readUs);
+	if (readUs < 0) {
+		return false;
+	}
+
+	frame = {};
+	frame.sender = CAN_MASTER_ID;
+	frame.target = CAN_BROADCAST_ID;
+	frame.group = CanFrame::GROUP::SENSOR;
+	frame.function = dtcFunction_;
+	frame.dataLengthCode = 1 + 2 * MAX_GATEWAY_DTCS;
+	frame.answer = false;
+
+	// Count, then the codes big endian. Unused ones stay 0
+	frame.data[0] = count;
+	for (uint8_t i = 0; i < count && i < MAX_GATEWAY_DTCS; i++) {
+		frame.data[1 + 2 * i] = dtcs[i].code >> 8;
+		frame.data[2 + 2 * i] = dtcs[i].code & 0xFF;
+	}
+
+	return true;
+}
+
+void EcuCanGateway::subscribe() const
+{
+	// Signals of multiple frames share one subscription, polled with the fastest period
+	for (uint8_t i = 0; i < frameCount_; i++) {
+		for (uint8_t j = 0; j < frames_[i].signalCount; j++) {
+			const uint16_t address = frames_[i].signals[j].sensor->address;
+
+			uint32_t periodUs = frames_[i].periodUs;
+			for (uint8_t k = 0; k < frameCount_; k++) {
+				for (uint8_t l = 0; l < frames_[k].signalCount; l++) {
+					if (frames_[k].signals[l].sensor->address == address) {
+						periodUs = std::min(periodUs, frames_[k].periodUs);
+					}
+				}
+			}
+
+			scheduler_->subscribe(subscriber_, address, periodUs / 1000, EcuPollScheduler::PRIORITY_LOW);
+		}
+	}
+}
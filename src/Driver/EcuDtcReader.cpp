@@ -0,0 +1,177 @@
+#include "Driver/EcuDtcReader.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+// espidf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "EcuDtcReader";
+
+constexpr uint8_t SID_READ_DTC_BY_STATUS_RESPONSE = 0x58;
+
+// Code (2 bytes) and status per fault code
+constexpr uint8_t DTC_LENGTH = 3;
+
+constexpr char DTC_SYSTEMS[] = {'P', 'C', 'B', 'U'};
+
+/*
+ *	Public Function Implementations
+ */
+EcuDtcReader::EcuDtcReader(EcuPollScheduler* scheduler) : scheduler_(scheduler)
+{
+	mutex_ = xSemaphoreCreateMutex();
+	if (mutex_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to create the mutex");
+	}
+}
+
+EcuDtcReader::~EcuDtcReader()
+{
+	if (mutex_ != nullptr) {
+		vSemaphoreDelete(mutex_);
+	}
+}
+
+bool EcuDtcReader::refresh()
+{
+	if (scheduler_ == nullptr) {
+		return false;
+	}
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	const bool alreadyRefreshing = refreshing_;
+	refreshing_ = true;
+	xSemaphoreGive(mutex_);
+
+	if (alreadyRefreshing) {
+		return false;
+	}
+
+	if (!scheduler_->queueBackgroundJob(sendRequest, staticOnResponse, this)) {
+		ESP_LOGW(TAG, "Another background job is pending");
+
+		xSemaphoreTake(mutex_, portMAX_DELAY);
+		refreshing_ = false;
+		xSemaphoreGive(mutex_);
+		return false;
+	}
+
+	return true;
+}
+
+bool EcuDtcReader::isRefreshing() const
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	const bool refreshing = refreshing_;
+	xSemaphoreGive(mutex_);
+
+	return refreshing;
+}
+
+uint8_t EcuDtcReader::getDtcs(EcuDtc* dtcs, const uint8_t maxCount, int64_t& readUs) const
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	const uint8_t count = std::min(dtcCount_, maxCount);
+	std::copy_n(dtcs_.begin(), count, dtcs);
+	readUs = readUs_;
+	xSemaphoreGive(mutex_);
+
+	return count;
+}
+
+std::string EcuDtcReader::toJson() const
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	const auto dtcs = dtcs_;
+	const uint8_t dtcCount = dtcCount_;
+	const uint8_t reportedCount = reportedCount_;
+	const int64_t readUs = readUs_;
+	const bool lastReadFailed = lastReadFailed_;
+	const bool refreshing = refreshing_;
+	xSemaphoreGive(mutex_);
+
+	std::stringstream output;
+	output << "{";
+	output << "\"refreshing\":" << (refreshing ? "true" : "false") << ",";
+	output << "\"failed\":" << (lastReadFailed ? "true" : "false") << ",";
+	output << "\"ageMs\":" << (readUs < 0 ? -1 : (esp_timer_get_time() - readUs) / 1000) << ",";
+	output << "\"count\":" << static_cast<uint32_t>(reportedCount) << ",";
+	output << "\"dtcs\":[";
+	for (uint8_t i = 0; i < dtcCount; i++) {
+		char code[ECU_DTC_STRING_LENGTH];
+		formatCode(dtcs[i].code, code);
+		output << (i == 0 ? "" : ",") << "{\"code\":\"" << code << "\",\"status\":" << static_cast<uint32_t>(dtcs[i].status)
+		       << "}";
+	}
+	output << "]";
+	output << "}";
+
+	return output.str();
+}
+
+void EcuDtcReader::formatCode(const uint16_t code, char (&buffer)[ECU_DTC_STRING_LENGTH])
+{
+	snprintf(buffer, sizeof(buffer), "%c%04X", DTC_SYSTEMS[code >> 14], code & 0x3FFF);
+}
+
+/*
+ *	Private Function Implementations
+ */
+void EcuDtcReader::onResponse(const KLine::Response& response)
+{
+	// Response SID, number of codes, then code and status of each
+	const bool valid = response.result == KLine::RESULT_OK && response.payloadLength >= 2 &&
+	                   response.payload[0] == SID_READ_DTC_BY_STATUS_RESPONSE;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	refreshing_ = false;
+	lastReadFailed_ = !valid;
+
+	if (valid) {
+		reportedCount_ = response.payload[1];
+		dtcCount_ = 0;
+
+		for (uint8_t offset = 2; offset + DTC_LENGTH <= response.payloadLength && dtcCount_ < MAX_ECU_DTCS &&
+		                         dtcCount_ < reportedCount_;
+		     offset += DTC_LENGTH) {
+			const uint8_t* data = &response.payload[offset];
+			dtcs_[dtcCount_++] = {.code = static_cast<uint16_t>((data[0] << 8) + data[1]), .status = data[2]};
+		}
+
+		readUs_ = response.responseUs;
+	}
+	const uint8_t dtcCount = dtcCount_;
+	const uint8_t reportedCount = reportedCount_;
+	xSemaphoreGive(mutex_);
+
+	if (!valid) {
+		ESP_LOGW(TAG, "Failed to read the fault codes (result %d)", response.result);
+		return;
+	}
+
+	if (dtcCount < reportedCount) {
+		ESP_LOGW(TAG, "Only %d of %d fault codes were read", dtcCount, reportedCount);
+	}
+	ESP_LOGI(TAG, "Read %d fault codes", dtcCount);
+}
+
+void EcuDtcReader::staticOnResponse(const KLine::Response& response, void* ctx)
+{
+	if (ctx == nullptr) {
+		return;
+	}
+
+	static_cast<EcuDtcReader*>(ctx)->onResponse(response);
+}
+
+bool EcuDtcReader::sendRequest(KLine* kline, const KLine::Callback callback, void* ctx)
+{
+	return kline != nullptr && kline->readDtcs(callback, ctx);
+}
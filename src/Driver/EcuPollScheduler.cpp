@@ -0,0 +1,596 @@
+#include "Driver/EcuPollScheduler.hpp"
+
+// Project includes
+#include "Driver/EcuSensors.hpp"
+#include "Driver/EcuValueCache.hpp"
+
+// C++ includes
+#include <algorithm>
+
+// espidf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "EcuPollScheduler";
+
+// Upper bound of the idle wait, so changed subscriptions are picked up quickly
+constexpr uint32_t MAX_IDLE_WAIT_MS = 100;
+
+// Fallback in case the K-Line driver never answers a request
+constexpr uint32_t MAX_IN_FLIGHT_WAIT_MS = 1000;
+
+// PIDs due within this fraction of their period are read early together with the PID that is due now
+constexpr uint32_t BATCH_EARLY_PERIOD_DIVISOR = 4;
+
+// Batches failing in a row before the ECU is considered to not support multi-PID reads
+constexpr uint8_t MAX_FAILED_BATCHES = 3;
+
+// Multi-PID reads are tried again after this long, e.g. if they only failed during a noisy phase of the line
+constexpr int64_t BATCH_REPROBE_US = 10 * 1000 * 1000;
+
+constexpr uint8_t SID_RDBI_RESPONSE = 0x62;
+
+// A background job is only sent if no PID is due for this long, about one multi-frame transaction
+constexpr int64_t BACKGROUND_SLOT_US = 150 * 1000;
+
+// Jobs are sent anyway after this long, so they don't starve on a saturated line
+constexpr int64_t MAX_BACKGROUND_DEFER_US = 5 * 1000 * 1000;
+
+/*
+ *	Private Static Tasks
+ */
+static void staticPollTask(void* param)
+{
+	if (param == nullptr) {
+		vTaskDelete(nullptr);
+	}
+
+	static_cast<EcuPollScheduler*>(param)->pollTask();
+}
+
+/*
+ *	Public Function Implementations
+ */
+EcuPollScheduler::EcuPollScheduler(KLine* kline, const EcuValueCache* cache, const uint8_t maxPidsPerRead)
+	: kline_(kline), cache_(cache),
+	  configuredPidsPerRead_(std::clamp<uint8_t>(maxPidsPerRead, 1, KLINE_MAX_PIDS_PER_READ)),
+	  maxPidsPerRead_(configuredPidsPerRead_)
+{
+	mutex_ = xSemaphoreCreateMutex();
+	if (mutex_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to create the mutex");
+		return;
+	}
+
+	if (xTaskCreate(staticPollTask, "EcuPollSchedulerTask", 2048 * 2, this, 2, &pollTaskHandle_) != pdPASS) {
+		ESP_LOGE(TAG, "Failed to create the poll task");
+	}
+}
+
+EcuPollScheduler::~EcuPollScheduler()
+{
+	if (pollTaskHandle_ != nullptr) {
+		vTaskDelete(pollTaskHandle_);
+	}
+
+	if (mutex_ != nullptr) {
+		vSemaphoreDelete(mutex_);
+	}
+}
+
+int8_t EcuPollScheduler::addSubscriber()
+{
+	int8_t subscriber = -1;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (uint8_t i = 0; i < MAX_POLL_SUBSCRIBERS; i++) {
+		if ((usedSubscribers_ & (1u << i)) == 0) {
+			usedSubscribers_ |= 1u << i;
+			subscriber = static_cast<int8_t>(i);
+			break;
+		}
+	}
+	xSemaphoreGive(mutex_);
+
+	if (subscriber < 0) {
+		ESP_LOGW(TAG, "No subscriber left");
+	}
+
+	return subscriber;
+}
+
+void EcuPollScheduler::removeSubscriber(const int8_t subscriber)
+{
+	if (subscriber < 0 || subscriber >= MAX_POLL_SUBSCRIBERS) {
+		return;
+	}
+
+	const uint32_t bit = 1u << subscriber;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (uint8_t i = entryCount_; i > 0; i--) {
+		Entry& entry = entries_[i - 1];
+		if ((entry.subscribers & bit) == 0) {
+			continue;
+		}
+
+		entry.subscribers &= ~bit;
+		if (entry.subscribers == 0) {
+			removeEntry(i - 1);
+		}
+		else {
+			mergeSubscriptions(entry);
+		}
+	}
+	usedSubscribers_ &= ~bit;
+	xSemaphoreGive(mutex_);
+}
+
+bool EcuPollScheduler::subscribe(const int8_t subscriber, const uint16_t pid, const uint32_t periodMs,
+                                 const PRIORITY priority)
+{
+	if (subscriber < 0 || subscriber >= MAX_POLL_SUBSCRIBERS || periodMs == 0) {
+		return false;
+	}
+
+	bool success = true;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	Entry* entry = findEntry(pid);
+
+	// First subscription of this PID, it's due right away. A fresh value in the cache defers it when it's picked
+	if (entry == nullptr && entryCount_ < MAX_POLLED_PIDS) {
+		entry = &entries_[entryCount_++];
+		*entry = {};
+		entry->pid = pid;
+		entry->length = getEcuAddressLength(pid);
+		entry->nextDueUs = esp_timer_get_time();
+	}
+
+	if (entry != nullptr) {
+		entry->subscribers |= 1u << subscriber;
+		entry->subscriptions[subscriber] = {.periodUs = periodMs * 1000, .priority = priority};
+		mergeSubscriptions(*entry);
+	}
+	else {
+		ESP_LOGW(TAG, "Can't poll more than %d PIDs", MAX_POLLED_PIDS);
+		success = false;
+	}
+	xSemaphoreGive(mutex_);
+
+	// Wake up the task for the new PID
+	if (pollTaskHandle_ != nullptr) {
+		xTaskNotifyGive(pollTaskHandle_);
+	}
+
+	return success;
+}
+
+void EcuPollScheduler::unsubscribe(const int8_t subscriber, const uint16_t pid)
+{
+	if (subscriber < 0 || subscriber >= MAX_POLL_SUBSCRIBERS) {
+		return;
+	}
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	Entry* entry = findEntry(pid);
+	if (entry != nullptr) {
+		entry->subscribers &= ~(1u << subscriber);
+
+		if (entry->subscribers == 0) {
+			removeEntry(entry - entries_.data());
+		}
+		else {
+			mergeSubscriptions(*entry);
+		}
+	}
+	xSemaphoreGive(mutex_);
+}
+
+bool EcuPollScheduler::addListener(const Listener listener, void* ctx)
+{
+	if (listener == nullptr || listenerCount_ >= listeners_.size()) {
+		return false;
+	}
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	listeners_[listenerCount_++] = {.listener = listener, .ctx = ctx};
+	xSemaphoreGive(mutex_);
+
+	return true;
+}
+
+uint8_t EcuPollScheduler::getPolledPidCount() const
+{
+	return entryCount_;
+}
+
+bool EcuPollScheduler::queueBackgroundJob(const BackgroundRequest request, const KLine::Callback callback, void* ctx)
+{
+	if (request == nullptr) {
+		return false;
+	}
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	const bool queued = !backgroundPending_;
+	if (queued) {
+		backgroundJob_ = {.request = request, .callback = callback, .ctx = ctx, .queuedUs = esp_timer_get_time()};
+		backgroundPending_ = true;
+	}
+	xSemaphoreGive(mutex_);
+
+	if (queued && pollTaskHandle_ != nullptr) {
+		xTaskNotifyGive(pollTaskHandle_);
+	}
+
+	return queued;
+}
+
+void EcuPollScheduler::pollTask()
+{
+	while (true) {
+		const int64_t nowUs = esp_timer_get_time();
+		uint32_t waitMs = MAX_IDLE_WAIT_MS;
+
+		xSemaphoreTake(mutex_, portMAX_DELAY);
+		if (!inFlight_) {
+			Entry* entry = nextDueEntry(nowUs);
+
+			if (backgroundPending_ && sendBackgroundJob(nowUs, entry != nullptr)) {
+				inFlight_ = true;
+				inFlightBackground_ = true;
+				inFlightSequence_ = ++sentSequence_;
+			}
+			else if (entry != nullptr) {
+				reprobeBatching(nowUs);
+				inFlightCount_ = collectBatch(*entry, nowUs);
+				inFlight_ = kline_->readPids(inFlightPids_.data(), inFlightCount_, staticOnResponse, this);
+
+				// A request the driver didn't take stays due and is sent in the next slot
+				for (uint8_t i = 0; i < inFlightCount_ && inFlight_; i++) {
+					scheduleNext(*findEntry(inFlightPids_[i]), nowUs);
+				}
+
+				if (inFlight_) {
+					inFlightSequence_ = ++sentSequence_;
+				}
+			}
+
+			// Sleep until the next PID is due
+			for (uint8_t i = 0; i < entryCount_ && !inFlight_; i++) {
+				const int64_t untilDueMs = (entries_[i].nextDueUs - nowUs) / 1000;
+				waitMs = std::clamp<int64_t>(untilDueMs, 1, waitMs);
+			}
+
+			// Or until a deferred job is forced
+			if (backgroundPending_ && !inFlight_) {
+				const int64_t untilForcedMs = (backgroundJob_.queuedUs + MAX_BACKGROUND_DEFER_US - nowUs) / 1000;
+				waitMs = std::clamp<int64_t>(untilForcedMs, 1, waitMs);
+			}
+		}
+
+		const bool waitingForResponse = inFlight_;
+		if (waitingForResponse) {
+			waitMs = MAX_IN_FLIGHT_WAIT_MS;
+		}
+		xSemaphoreGive(mutex_);
+
+		// Woken up early by a response or a new subscription
+		if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs) + 1) > 0 || !waitingForResponse) {
+			continue;
+		}
+
+		// The late response is ignored, so the owner of a background job learns about the timeout from here
+		BackgroundJob abandonedJob = {};
+
+		xSemaphoreTake(mutex_, portMAX_DELAY);
+		if (inFlight_ && inFlightBackground_) {
+			ESP_LOGW(TAG, "No answer for the background job");
+			inFlight_ = false;
+			inFlightBackground_ = false;
+			abandonedJob = inFlightJob_;
+		}
+		else if (inFlight_) {
+			ESP_LOGW(TAG, "No answer for PID 0x%04X (%d PIDs)", inFlightPids_[0], inFlightCount_);
+			inFlight_ = false;
+		}
+		xSemaphoreGive(mutex_);
+
+		if (abandonedJob.callback != nullptr) {
+			const KLine::Response timeout = {.result = KLine::RESULT_TIMEOUT};
+			abandonedJob.callback(timeout, abandonedJob.ctx);
+		}
+	}
+}
+
+/*
+ *	Private Function Implementations
+ */
+void EcuPollScheduler::onResponse(const KLine::Response& response)
+{
+	Result results[KLINE_MAX_PIDS_PER_READ];
+	uint32_t subscribers[KLINE_MAX_PIDS_PER_READ] = {};
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	if (isStale()) {
+		xSemaphoreGive(mutex_);
+		return;
+	}
+
+	inFlight_ = false;
+	const uint8_t count = inFlightCount_;
+	const bool parsed = parseResponse(response, results);
+
+	// An ECU that doesn't know multi-PID reads rejects or ignores them, so stop batching
+	if (count > 1) {
+		failedBatches_ = parsed ? 0 : failedBatches_ + 1;
+		if (failedBatches_ >= MAX_FAILED_BATCHES) {
+			ESP_LOGW(TAG, "Multi-PID reads failed %d times in a row, reading PIDs one by one", failedBatches_);
+			maxPidsPerRead_ = 1;
+			failedBatches_ = 0;
+			batchingDisabledUs_ = esp_timer_get_time();
+		}
+	}
+
+	const int64_t nowUs = esp_timer_get_time();
+	for (uint8_t i = 0; i < count; i++) {
+		Entry* entry = findEntry(results[i].pid);
+		subscribers[i] = entry != nullptr ? entry->subscribers : 0;
+
+		// A failed poll is repeated once in the next slot instead of waiting a whole period
+		if (entry != nullptr) {
+			if (!results[i].valid && !entry->retrying) {
+				entry->nextDueUs = nowUs;
+			}
+			entry->retrying = !results[i].valid && !entry->retrying;
+		}
+	}
+
+	const auto listeners = listeners_;
+	const uint8_t listenerCount = listenerCount_;
+	xSemaphoreGive(mutex_);
+
+	// Fan out
+	for (uint8_t i = 0; i < count; i++) {
+		for (uint8_t j = 0; j < listenerCount; j++) {
+			listeners[j].listener(results[i], subscribers[i], listeners[j].ctx);
+		}
+	}
+
+	// Send the next request right away
+	if (pollTaskHandle_ != nullptr) {
+		xTaskNotifyGive(pollTaskHandle_);
+	}
+}
+
+void EcuPollScheduler::staticOnResponse(const KLine::Response& response, void* ctx)
+{
+	if (ctx == nullptr) {
+		return;
+	}
+
+	static_cast<EcuPollScheduler*>(ctx)->onResponse(response);
+}
+
+void EcuPollScheduler::onBackgroundResponse(const KLine::Response& response)
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	if (isStale()) {
+		xSemaphoreGive(mutex_);
+		return;
+	}
+
+	inFlight_ = false;
+	inFlightBackground_ = false;
+	const BackgroundJob job = inFlightJob_;
+	xSemaphoreGive(mutex_);
+
+	if (job.callback != nullptr) {
+		job.callback(response, job.ctx);
+	}
+
+	// Send the next request right away
+	if (pollTaskHandle_ != nullptr) {
+		xTaskNotifyGive(pollTaskHandle_);
+	}
+}
+
+void EcuPollScheduler::staticOnBackgroundResponse(const KLine::Response& response, void* ctx)
+{
+	if (ctx == nullptr) {
+		return;
+	}
+
+	static_cast<EcuPollScheduler*>(ctx)->onBackgroundResponse(response);
+}
+
+bool EcuPollScheduler::sendBackgroundJob(const int64_t nowUs, const bool pidDue)
+{
+	bool idle = !pidDue;
+	for (uint8_t i = 0; i < entryCount_ && idle; i++) {
+		idle = entries_[i].nextDueUs - nowUs >= BACKGROUND_SLOT_US;
+	}
+
+	if (!idle && nowUs - backgroundJob_.queuedUs < MAX_BACKGROUND_DEFER_US) {
+		return false;
+	}
+
+	// Try again in the next slot if the driver doesn't take it. The job keeps its queue time, so the deferral stays
+	// bounded
+	if (!backgroundJob_.request(kline_, staticOnBackgroundResponse, this)) {
+		return false;
+	}
+
+	inFlightJob_ = backgroundJob_;
+	backgroundPending_ = false;
+	return true;
+}
+
+bool EcuPollScheduler::isStale()
+{
+	// The driver answers every request it took exactly once and in order, so the answers can be counted
+	const uint32_t sequence = ++answeredSequence_;
+	if (inFlight_ && sequence == inFlightSequence_) {
+		return false;
+	}
+
+	ESP_LOGW(TAG, "Ignoring the late response of request %lu", sequence);
+	return true;
+}
+
+EcuPollScheduler::Entry* EcuPollScheduler::findEntry(const uint16_t pid)
+{
+	for (uint8_t i = 0; i < entryCount_; i++) {
+		if (entries_[i].pid == pid) {
+			return &entries_[i];
+		}
+	}
+
+	return nullptr;
+}
+
+EcuPollScheduler::Entry* EcuPollScheduler::nextDueEntry(const int64_t nowUs)
+{
+	Entry* next = nullptr;
+
+	// Highest priority first, the most overdue one within the same priority
+	for (uint8_t i = 0; i < entryCount_; i++) {
+		Entry& entry = entries_[i];
+		if (entry.nextDueUs > nowUs || deferIfFresh(entry, nowUs)) {
+			continue;
+		}
+
+		if (next == nullptr || entry.priority > next->priority ||
+		    (entry.priority == next->priority && entry.nextDueUs < next->nextDueUs)) {
+			next = &entry;
+		}
+	}
+
+	return next;
+}
+
+void EcuPollScheduler::reprobeBatching(const int64_t nowUs)
+{
+	if (maxPidsPerRead_ == configuredPidsPerRead_ || nowUs - batchingDisabledUs_ < BATCH_REPROBE_US) {
+		return;
+	}
+
+	// A single failed probe is enough to fall back again, so it costs at most one transaction
+	ESP_LOGI(TAG, "Trying multi-PID reads again");
+	maxPidsPerRead_ = configuredPidsPerRead_;
+	failedBatches_ = MAX_FAILED_BATCHES - 1;
+}
+
+uint8_t EcuPollScheduler::collectBatch(Entry& first, const int64_t nowUs)
+{
+	inFlightPids_[0] = first.pid;
+	inFlightLengths_[0] = first.length;
+
+	uint8_t count = 1;
+	if (maxPidsPerRead_ == 1 || first.length == 0) {
+		return count;
+	}
+
+	// The response holds the SID and 2 bytes PID plus the value for every PID
+	uint8_t responseLength = 1 + 2 + first.length;
+
+	for (uint8_t i = 0; i < entryCount_ && count < maxPidsPerRead_; i++) {
+		Entry& entry = entries_[i];
+		if (&entry == &first || entry.length == 0 ||
+		    entry.nextDueUs - nowUs > static_cast<int64_t>(entry.periodUs / BATCH_EARLY_PERIOD_DIVISOR) ||
+		    responseLength + 2 + entry.length > KLINE_MAX_PAYLOAD_LENGTH || deferIfFresh(entry, nowUs)) {
+			continue;
+		}
+
+		inFlightPids_[count] = entry.pid;
+		inFlightLengths_[count] = entry.length;
+		responseLength += 2 + entry.length;
+		count++;
+	}
+
+	return count;
+}
+
+bool EcuPollScheduler::parseResponse(const KLine::Response& response, Result* results) const
+{
+	for (uint8_t i = 0; i < inFlightCount_; i++) {
+		results[i] = {};
+		results[i].pid = inFlightPids_[i];
+		results[i].requestUs = response.requestUs;
+		results[i].responseUs = response.responseUs;
+	}
+
+	if (response.result != KLine::RESULT_OK || response.payloadLength < 4 ||
+	    response.payload[0] != SID_RDBI_RESPONSE) {
+		return false;
+	}
+
+	// SID, then PID and 1 or 2 data bytes per PID. A single PID of unknown length takes the rest of the payload
+	uint8_t offset = 1;
+	for (uint8_t i = 0; i < inFlightCount_; i++) {
+		uint8_t length = inFlightLengths_[i];
+		if (length == 0) {
+			length = std::min<uint8_t>(response.payloadLength - offset - 2, 2);
+		}
+
+		const uint8_t* data = &response.payload[offset];
+		if (offset + 2 + length > response.payloadLength || data[0] != results[i].pid >> 8 ||
+		    data[1] != (results[i].pid & 0xFF)) {
+			return false;
+		}
+
+		results[i].valid = true;
+		results[i].rawValue = length == 1 ? data[2] : (data[2] << 8) + data[3];
+		offset += 2 + length;
+	}
+
+	return true;
+}
+
+bool EcuPollScheduler::deferIfFresh(Entry& entry, const int64_t nowUs) const
+{
+	EcuValueCache::Value cached;
+	if (cache_ == nullptr || !cache_->getFresh(entry.pid, nowUs, cached)) {
+		return false;
+	}
+
+	// Values requested within the early batch window are as good as a new poll, e.g. the one of the last period
+	const int64_t requestUs = cached.timestampUs - cached.latencyUs;
+	const int64_t freshUntilUs = requestUs + entry.periodUs - entry.periodUs / BATCH_EARLY_PERIOD_DIVISOR;
+	if (freshUntilUs <= nowUs) {
+		return false;
+	}
+
+	entry.nextDueUs = requestUs + entry.periodUs;
+	return true;
+}
+
+void EcuPollScheduler::scheduleNext(Entry& entry, const int64_t nowUs)
+{
+	// Keep the phase, but don't try to catch up on missed periods
+	entry.nextDueUs = std::max<int64_t>(entry.nextDueUs + entry.periodUs, nowUs);
+}
+
+void EcuPollScheduler::removeEntry(const uint8_t index)
+{
+	// Keep the table dense
+	entries_[index] = entries_[--entryCount_];
+}
+
+void EcuPollScheduler::mergeSubscriptions(Entry& entry)
+{
+	entry.periodUs = UINT32_MAX;
+	entry.priority = PRIORITY_LOW;
+
+	for (uint8_t i = 0; i < MAX_POLL_SUBSCRIBERS; i++) {
+		if ((entry.subscribers & (1u << i)) == 0) {
+			continue;
+		}
+
+		entry.periodUs = std::min(entry.periodUs, entry.subscriptions[i].periodUs);
+		entry.priority = std::max(entry.priority, entry.subscriptions[i].priority);
+	}
+}
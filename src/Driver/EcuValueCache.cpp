@@ -0,0 +1,96 @@
+#include "Driver/EcuValueCache.hpp"
+
+// espidf includes
+#include "esp_log.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "EcuValueCache";
+
+/*
+ *	Public Function Implementations
+ */
+EcuValueCache::EcuValueCache(const uint32_t ttlMs) : ttlUs_(ttlMs * 1000)
+{
+	mutex_ = xSemaphoreCreateMutex();
+	if (mutex_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to create the mutex");
+	}
+}
+
+EcuValueCache::~EcuValueCache()
+{
+	if (mutex_ != nullptr) {
+		vSemaphoreDelete(mutex_);
+	}
+}
+
+void EcuValueCache::store(const uint16_t pid, const Value& value)
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+
+	Entry* entry = nullptr;
+	for (uint8_t i = 0; i < entryCount_ && entry == nullptr; i++) {
+		if (entries_[i].pid == pid) {
+			entry = &entries_[i];
+		}
+	}
+
+	if (entry == nullptr && entryCount_ < MAX_CACHED_PIDS) {
+		entry = &entries_[entryCount_++];
+		entry->pid = pid;
+	}
+
+	if (entry != nullptr) {
+		entry->value = value;
+	}
+
+	xSemaphoreGive(mutex_);
+
+	if (entry == nullptr) {
+		ESP_LOGW(TAG, "Can't cache more than %d PIDs", MAX_CACHED_PIDS);
+	}
+}
+
+bool EcuValueCache::get(const uint16_t pid, Value& value) const
+{
+	bool found = false;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (uint8_t i = 0; i < entryCount_; i++) {
+		if (entries_[i].pid == pid) {
+			value = entries_[i].value;
+			found = true;
+			break;
+		}
+	}
+	xSemaphoreGive(mutex_);
+
+	return found;
+}
+
+bool EcuValueCache::getFresh(const uint16_t pid, const int64_t nowUs, Value& value) const
+{
+	return get(pid, value) && nowUs - value.timestampUs <= ttlUs_;
+}
+
+uint32_t EcuValueCache::getTtlMs() const
+{
+	return ttlUs_ / 1000;
+}
+
+void EcuValueCache::staticOnResult(const EcuPollScheduler::Result& result, const uint32_t subscribers, void* ctx)
+{
+	if (ctx == nullptr || !result.valid) {
+		return;
+	}
+
+	const Value value = {
+		.rawValue = result.rawValue,
+		.timestampUs = result.responseUs,
+		.latencyUs = static_cast<uint32_t>(result.responseUs - result.requestUs),
+	};
+
+	static_cast<EcuValueCache*>(ctx)->store(result.pid, value);
+}
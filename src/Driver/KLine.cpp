@@ -1 +1,844 @@
-#include "Driver/KLine.hpp"// C++ includes#include <string>#include <bits/stdc++.h>// Project includes#include "Global.h"#include "Driver/EcuSensors.hpp"// espidf include#include "driver/gpio.h"#include "driver/uart.h"#include "esp_log.h"/* *	constexpr */constexpr auto TAG = "KLine";constexpr uart_port_t UART_PORT = UART_NUM_2;constexpr uint16_t BUFFER_SIZE_RX = 2048;constexpr uint16_t BUFFER_SIZE_TX = 2048;constexpr uint16_t INTERNAL_BUFFER_SIZE_RX = 64;constexpr uint8_t UART_QUEUE_SIZE = 10;constexpr uint16_t UART_BAUD_RATE = 10400;constexpr uart_config_t UART_CONFIG = {	.baud_rate = 10400,	.data_bits = UART_DATA_8_BITS,	.parity = UART_PARITY_DISABLE,	.stop_bits = UART_STOP_BITS_1,	.flow_ctrl = UART_HW_FLOWCTRL_DISABLE,	.rx_flow_ctrl_thresh = 122,};constexpr gpio_num_t GPIO_RX = GPIO_NUM_12;constexpr gpio_num_t GPIO_TX = GPIO_NUM_11;constexpr uint8_t COMMAND = 0x04;constexpr uint8_t ADDR_ECU = 0x10;constexpr uint8_t ADDR_PCB = 0xF5;constexpr uint8_t SID_RDBI = 0x22; // Read Data By Identifierconstexpr uint8_t SID_READ_FLASH = 0x23; // Unknown SID, but used for reading the ECU IDconstexpr uint8_t READ_SENSOR = 0x17;constexpr uint32_t ECU_ID_ADDR = 0x010006;/* *	Private Static Tasks */void uartRxTask(void* param){	if (param == nullptr) {		vTaskDelete(nullptr);	}	KLine* kline = static_cast<KLine*>(param);	auto queue = kline->getQueue();	uart_event_t event;	uint8_t buffer[INTERNAL_BUFFER_SIZE_RX] = {0x00};	while (true) {		if (xQueueReceive(queue, &event, portMAX_DELAY) == pdFALSE) {			continue;		}		// Act depending on the event type		switch (event.type) {			// Data received			case UART_DATA:			{				uint8_t bytesRead = uart_read_bytes(UART_PORT, buffer, event.size, portMAX_DELAY);				if (bytesRead <= 0) {					continue;				}				// Check if it's a message we send, because we can ignore them				bool ignore = false;				if (xSemaphoreTake(kline->getLastMessageMutex(), portMAX_DELAY) != pdFALSE) {					const auto& lastMessageLength = kline->getLastMessageLength();					if (lastMessageLength == bytesRead) {						const auto& lastMessage = kline->getLastMessage();						for (uint8_t i = 0; i < bytesRead; i++) {							ignore |= *(lastMessage + i) == buffer[i];						}					}					xSemaphoreGive(kline->getLastMessageMutex());				}				if (ignore) {					// ESP_LOGI(TAG, "Ignored message with %d bytes", event.size);					continue;				}				// Is it a new sensor value?				if (buffer[3] == 0x62) {					uint16_t pid = (buffer[4] << 8) + buffer[5];					uint16_t data = 0;					if (buffer[0] == 0x84) {						data = (buffer[6] << 8) + buffer[7];					}					else {						data = buffer[6];					}					// Debug logging p0					if (ECU_SENSORS.contains(pid)) {						ECU_SENSORS[pid].rawValue = data;						ESP_LOGI(TAG, "Updated Sensor with name %s to %d", ECU_SENSORS[pid].name.c_str(), data);					}				}				// Debug logging p1				// if (buffer[0] == 0xA4 && buffer[3] == 0x63 && buffer[4] == 0x00 && buffer[5] == 0x06) {				// 	std::string id;				// 	for (uint8_t i = 6; i < 10; i++) {				// 		id += static_cast<char>(buffer[i]);				// 	}				//				// 	ESP_LOGI(TAG, "ECU ID: %s", id.c_str());				// }				// Debug logging p1				// std::string data;				// for (uint8_t i = 0; i < event.size; i++) {				// 	std::stringstream stream;				// 	stream << std::hex << static_cast<unsigned int>(buffer[i]);				// 	data += "0x" + std::string("00").substr(stream.str().size()) + stream.str() + ", ";				// }				// ESP_LOGI(TAG, "Received %d bytes: %s", event.size, data.c_str());			}			break;			// Buffer Overflow			case UART_FIFO_OVF:			case UART_BUFFER_FULL:				ESP_LOGW(TAG, "UART Buffer Overlow. Flushing");				uart_flush_input(UART_PORT);				xQueueReset(queue);				break;			default:				break;		}	}}/* *	Public Function Implementations */KLine::KLine(){	if (uart_driver_install(UART_PORT, BUFFER_SIZE_RX, BUFFER_SIZE_TX, UART_QUEUE_SIZE, &uartQueueHandle_, 0) !=		ESP_OK) {		ESP_LOGE(TAG, "Failed install UART driver");		return;	}	if (uart_param_config(UART_PORT, &UART_CONFIG)) {		ESP_LOGE(TAG, "Failed to parameterize UART");		return;	}	if (uart_set_pin(UART_NUM_2, GPIO_TX, GPIO_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE)) {		ESP_LOGE(TAG, "Failed to set the GPIOs for UART");		return;	}	if (xTaskCreate(uartRxTask, "KLineRxTask", 2048 * 2, this, 2, &rxTaskHandle_) != pdPASS) {		ESP_LOGE(TAG, "Failed to create RX Task");		return;	}	lastMessageMutex_ = xSemaphoreCreateMutex();	initialized_ = true;}KLine::~KLine(){	vTaskDelete(rxTaskHandle_);}void KLine::readEcuId(){	if (!initialized_) { return; }	uint8_t data[8] = {0x74, ADDR_ECU, ADDR_PCB, SID_READ_FLASH, static_cast<uint8_t>(ECU_ID_ADDR >> 16) & 0xFF,	                   static_cast<uint8_t>(ECU_ID_ADDR >> 8) & 0xFF, static_cast<uint8_t>(ECU_ID_ADDR) & 0xFF, 0x00};	send(data, 8);}void KLine::readPid(const uint16_t pid){	if (!initialized_) { return; }	uint8_t data[7] = {0x64, ADDR_ECU, ADDR_PCB, SID_RDBI, static_cast<uint8_t>(pid >> 8),	                   static_cast<uint8_t>(pid & 0xFF), 0x00};	send(data, 7);	// Debug logging p1	std::string dataStr;	for (uint8_t i = 0; i < 7; i++) {		std::stringstream stream;		stream << std::hex << static_cast<unsigned int>(data[i]);		dataStr += "0x" + std::string("00").substr(stream.str().size()) + stream.str() + ", ";	}	// ESP_LOGI(TAG, "Send %d bytes: %s", 7, dataStr.c_str());}QueueHandle_t KLine::getQueue() const{	return uartQueueHandle_;}SemaphoreHandle_t KLine::getLastMessageMutex() const{	return lastMessageMutex_;}uint8_t KLine::getLastMessageLength() const{	return lastMessageLength_;}uint8_t* KLine::getLastMessage(){	return lastMessage_;}/* *	Private Function Implementations*/void KLine::send(uint8_t* data, const uint8_t length, const bool calcChecksum){	if (calcChecksum) {		data[length - 1] = calculateChecksum(data, length);	}	if (xSemaphoreTake(lastMessageMutex_, portMAX_DELAY) != pdFALSE) {		memcpy(&lastMessage_, data, length);		lastMessageLength_ = length;		xSemaphoreGive(lastMessageMutex_);	}	uart_flush_input(UART_PORT);	const auto bytesWritten = uart_write_bytes(UART_PORT, data, length);	if (bytesWritten < length) {		ESP_LOGW(TAG, "Failed to send full message. Only send %d bytes", bytesWritten);	}}uint8_t KLine::calculateChecksum(const uint8_t* data, const uint8_t& length){	if (data == nullptr) {		return 0;	}	uint32_t checksum = 0;	for (uint8_t i = 0; i < length - 1; i++) {		checksum += data[i];	}	return checksum % 256;}
\ No newline at end of file
+#include "Driver/KLine.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cstring>
+
+// espidf include
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "KLine";
+
+constexpr uart_port_t UART_PORT = UART_NUM_2;
+constexpr uint16_t BUFFER_SIZE_RX = 2048;
+constexpr uint16_t BUFFER_SIZE_TX = 2048;
+constexpr uint16_t INTERNAL_BUFFER_SIZE_RX = 64;
+constexpr uint8_t UART_QUEUE_SIZE = 10;
+constexpr uart_config_t UART_CONFIG = {
+	.baud_rate = 10400,
+	.data_bits = UART_DATA_8_BITS,
+	.parity = UART_PARITY_DISABLE,
+	.stop_bits = UART_STOP_BITS_1,
+	.flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+	.rx_flow_ctrl_thresh = 122,
+};
+
+constexpr gpio_num_t GPIO_RX = GPIO_NUM_12;
+constexpr gpio_num_t GPIO_TX = GPIO_NUM_11;
+
+constexpr uint8_t ADDR_ECU = 0x10;
+constexpr uint8_t ADDR_PCB = 0xF5;
+constexpr uint8_t SID_RDBI = 0x22; // Read Data By Identifier
+constexpr uint8_t SID_READ_FLASH = 0x23; // Unknown SID, but used for reading the ECU ID
+constexpr uint8_t SID_READ_DTC_BY_STATUS = 0x18;
+constexpr uint8_t SID_START_COMMUNICATION = 0x81;
+constexpr uint8_t SID_TESTER_PRESENT = 0x3E;
+constexpr uint8_t SID_NEGATIVE_RESPONSE = 0x7F;
+constexpr uint8_t SID_RESPONSE_OFFSET = 0x40;
+
+constexpr uint32_t ECU_ID_ADDR = 0x010006;
+
+// All stored codes of all groups
+constexpr uint8_t DTC_STATUS_STORED = 0x00;
+constexpr uint16_t DTC_GROUP_ALL = 0xFF00;
+
+constexpr uint8_t TESTER_PRESENT_RESPONSE_REQUIRED = 0x01;
+
+// Fast init: the line has to be idle (W5) before the wake up pattern, which is 25 ms low (TiniL) and 25 ms high
+constexpr int64_t INIT_IDLE_US = 300 * 1000;
+constexpr uint32_t WAKE_UP_LOW_MS = 25;
+constexpr uint32_t WAKE_UP_HIGH_MS = 25;
+
+// A failed init is retried after this long, doubled with every further failure up to the maximum. Requests in
+// between are sent without a session, the ECU may not need one
+constexpr int64_t INIT_RETRY_US = 1000 * 1000;
+constexpr int64_t MAX_INIT_RETRY_US = 32 * INIT_RETRY_US;
+
+// The ECU ends the session after this long without a request (P3 max)
+constexpr int64_t SESSION_TIMEOUT_US = 5000 * 1000;
+
+// Timeouts in a row that mean the session dropped. Above the failed multi-PID reads after which the poll scheduler
+// falls back to single reads (3), so an ECU that doesn't answer those doesn't cost a reconnect
+constexpr uint8_t MAX_SESSION_TIMEOUTS = 4;
+
+constexpr uint8_t REQUEST_QUEUE_SIZE = 16;
+constexpr uint8_t FRAME_QUEUE_SIZE = 4;
+
+// Time to get a request onto the line
+constexpr uint32_t TX_TIMEOUT_MS = 100;
+
+// Adaptive timing. After a window of clean responses P2 is narrowed to a margin above the slowest response in it
+// and P3 is shortened by a fraction, both never below their floor
+constexpr uint32_t ADAPTIVE_WINDOW = 32;
+constexpr uint32_t ADAPTIVE_MIN_P2_US = 5000;
+constexpr uint32_t ADAPTIVE_MIN_P3_US = 1000;
+constexpr uint32_t ADAPTIVE_P3_STEP_DIVISOR = 4;
+
+constexpr int64_t STATS_INTERVAL_US = 60 * 1000000LL;
+
+// Window of the line utilization
+constexpr int64_t METRICS_WINDOW_US = 5 * 1000000LL;
+
+// Format, target, source & checksum around the payload
+constexpr uint8_t FRAME_OVERHEAD = KLINE_HEADER_LENGTH + 1;
+
+/*
+ *	Private Static Tasks
+ */
+static void staticRxTask(void* param)
+{
+	if (param == nullptr) {
+		vTaskDelete(nullptr);
+	}
+
+	static_cast<KLine*>(param)->rxTask();
+}
+
+static void staticRequestTask(void* param)
+{
+	if (param == nullptr) {
+		vTaskDelete(nullptr);
+	}
+
+	static_cast<KLine*>(param)->requestTask();
+}
+
+/*
+ *	Public Function Implementations
+ */
+KLine::KLine(const Timing& timing) : timing_(timing), p2MaxUs_(timing.p2MaxUs), p3MinUs_(timing.p3MinUs)
+{
+	if (uart_driver_install(UART_PORT, BUFFER_SIZE_RX, BUFFER_SIZE_TX, UART_QUEUE_SIZE, &uartQueueHandle_, 0) !=
+		ESP_OK) {
+		ESP_LOGE(TAG, "Failed install UART driver");
+		return;
+	}
+
+	uart_config_t uartConfig = UART_CONFIG;
+	uartConfig.baud_rate = static_cast<int>(timing_.baudRate);
+	if (uart_param_config(UART_PORT, &uartConfig)) {
+		ESP_LOGE(TAG, "Failed to parameterize UART");
+		return;
+	}
+
+	if (uart_set_pin(UART_PORT, GPIO_TX, GPIO_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE)) {
+		ESP_LOGE(TAG, "Failed to set the GPIOs for UART");
+		return;
+	}
+
+	requestQueue_ = xQueueCreate(REQUEST_QUEUE_SIZE, sizeof(Request));
+	frameQueue_ = xQueueCreate(FRAME_QUEUE_SIZE, sizeof(ReceivedFrame));
+	if (requestQueue_ == nullptr || frameQueue_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to create the queues");
+		return;
+	}
+
+	metricsMutex_ = xSemaphoreCreateMutex();
+	if (metricsMutex_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to create the metrics mutex");
+		return;
+	}
+
+	if (xTaskCreate(staticRxTask, "KLineRxTask", 2048 * 2, this, 3, &rxTaskHandle_) != pdPASS) {
+		ESP_LOGE(TAG, "Failed to create RX Task");
+		return;
+	}
+
+	if (xTaskCreate(staticRequestTask, "KLineRequestTask", 2048 * 2, this, 2, &requestTaskHandle_) != pdPASS) {
+		ESP_LOGE(TAG, "Failed to create request Task");
+		return;
+	}
+
+	ESP_LOGI(TAG, "%lu baud, P1 %lu us, P2 %lu us, P3 %lu us, P4 %lu us%s%s, keep-alive %lu us", timing_.baudRate,
+	         timing_.p1MaxUs, timing_.p2MaxUs, timing_.p3MinUs, timing_.p4MinUs, timing_.adaptive ? ", adaptive" : "",
+	         timing_.fastInit ? ", fast init" : "", timing_.keepAliveUs);
+
+	initialized_ = true;
+}
+
+KLine::~KLine()
+{
+	if (requestTaskHandle_ != nullptr) {
+		vTaskDelete(requestTaskHandle_);
+	}
+	if (rxTaskHandle_ != nullptr) {
+		vTaskDelete(rxTaskHandle_);
+	}
+
+	if (requestQueue_ != nullptr) {
+		vQueueDelete(requestQueue_);
+	}
+	if (frameQueue_ != nullptr) {
+		vQueueDelete(frameQueue_);
+	}
+	if (metricsMutex_ != nullptr) {
+		vSemaphoreDelete(metricsMutex_);
+	}
+
+	uart_driver_delete(UART_PORT);
+}
+
+bool KLine::request(const uint8_t* payload, const uint8_t length, const Callback callback, void* ctx,
+                    const bool multiFrame)
+{
+	if (!initialized_ || payload == nullptr || length == 0 || length > KLINE_MAX_PAYLOAD_LENGTH) {
+		return false;
+	}
+
+	Request request = {};
+	memcpy(request.payload, payload, length);
+	request.payloadLength = length;
+	request.multiFrame = multiFrame;
+	request.callback = callback;
+	request.ctx = ctx;
+
+	return xQueueSend(requestQueue_, &request, 0) == pdTRUE;
+}
+
+bool KLine::readEcuId(const Callback callback, void* ctx)
+{
+	const uint8_t payload[4] = {SID_READ_FLASH, static_cast<uint8_t>(ECU_ID_ADDR >> 16),
+	                            static_cast<uint8_t>(ECU_ID_ADDR >> 8), static_cast<uint8_t>(ECU_ID_ADDR)};
+	return request(payload, sizeof(payload), callback, ctx);
+}
+
+bool KLine::readPid(const uint16_t pid, const Callback callback, void* ctx)
+{
+	return readPids(&pid, 1, callback, ctx);
+}
+
+bool KLine::readPids(const uint16_t* pids, const uint8_t count, const Callback callback, void* ctx)
+{
+	if (pids == nullptr || count == 0 || count > KLINE_MAX_PIDS_PER_READ) {
+		return false;
+	}
+
+	uint8_t payload[KLINE_MAX_PAYLOAD_LENGTH];
+	payload[0] = SID_RDBI;
+	for (uint8_t i = 0; i < count; i++) {
+		payload[1 + i * 2] = static_cast<uint8_t>(pids[i] >> 8);
+		payload[2 + i * 2] = static_cast<uint8_t>(pids[i] & 0xFF);
+	}
+
+	return request(payload, 1 + count * 2, callback, ctx);
+}
+
+bool KLine::readDtcs(const Callback callback, void* ctx)
+{
+	const uint8_t payload[4] = {SID_READ_DTC_BY_STATUS, DTC_STATUS_STORED, static_cast<uint8_t>(DTC_GROUP_ALL >> 8),
+	                            static_cast<uint8_t>(DTC_GROUP_ALL & 0xFF)};
+	return request(payload, sizeof(payload), callback, ctx, true);
+}
+
+bool KLine::isInitialized() const
+{
+	return initialized_;
+}
+
+uint32_t KLine::getQueuedRequests() const
+{
+	return requestQueue_ == nullptr ? 0 : uxQueueMessagesWaiting(requestQueue_);
+}
+
+KLine::Stats KLine::getStats() const
+{
+	Stats stats = stats_;
+	stats.invalidFrames = assembler_.getInvalidFrames();
+	stats.droppedFrames = droppedFrames_;
+	stats.maxInterByteUs = maxInterByteUs_;
+	stats.p2MaxUs = p2MaxUs_;
+	stats.p3MinUs = p3MinUs_;
+	return stats;
+}
+
+void KLine::logStats() const
+{
+	const Stats stats = getStats();
+
+	ESP_LOGI(TAG, "%.1f PIDs/s, %lu requests, %lu responses, %lu timeouts, %lu invalid & %lu dropped frames",
+	         stats.pidsPerSecond, stats.requests, stats.responses, stats.timeouts, stats.invalidFrames,
+	         stats.droppedFrames);
+	ESP_LOGI(TAG, "Response %lu us (min %lu us, max %lu us), max inter-byte %lu us, P2 %lu us, P3 %lu us",
+	         stats.lastResponseUs, stats.minResponseUs, stats.maxResponseUs, stats.maxInterByteUs, stats.p2MaxUs,
+	         stats.p3MinUs);
+
+	if (metricsMutex_ == nullptr) {
+		return;
+	}
+
+	xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+	const KLineLatencyHistogram latency = metrics_.getTotal().latency;
+	const float lineUtilization = metrics_.getLineUtilization();
+	const float wireUtilization = metrics_.getWireUtilization();
+	const KLineSessionCounters session = metrics_.getSession();
+	xSemaphoreGive(metricsMutex_);
+
+	ESP_LOGI(TAG, "Latency avg %lu us, p50 %lu us, p95 %lu us, line %.1f %% busy (%.1f %% on the wire)",
+	         latency.getAverageUs(), latency.getPercentileUs(50), latency.getPercentileUs(95), lineUtilization,
+	         wireUtilization);
+
+	if (timing_.fastInit) {
+		ESP_LOGI(TAG, "Session %s for %lld s, %lu drops, %lu failed inits, last reconnect %lu us (max %lu us)",
+		         session.active ? "up" : "down",
+		         session.active ? (esp_timer_get_time() - session.startUs) / 1000000 : 0LL, session.drops,
+		         session.failedInits, session.lastReconnectUs, session.maxReconnectUs);
+	}
+}
+
+std::string KLine::getMetricsJson() const
+{
+	if (metricsMutex_ == nullptr) {
+		return "{}";
+	}
+
+	xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+	const std::string json = metrics_.toJson(esp_timer_get_time());
+	xSemaphoreGive(metricsMutex_);
+
+	return json;
+}
+
+void KLine::rxTask()
+{
+	uart_event_t event;
+	uint8_t buffer[INTERNAL_BUFFER_SIZE_RX] = {0x00};
+
+	ReceivedFrame received = {};
+
+	while (true) {
+		if (xQueueReceive(uartQueueHandle_, &event, portMAX_DELAY) == pdFALSE) {
+			continue;
+		}
+
+		// Act depending on the event type
+		switch (event.type) {
+			// Data received
+			case UART_DATA:
+			{
+				const int bytesRead = uart_read_bytes(UART_PORT, buffer, std::min<size_t>(event.size, sizeof(buffer)),
+				                                      0);
+				if (bytesRead <= 0) {
+					continue;
+				}
+
+				// A pause on the line ends every frame, so resync on it
+				const int64_t nowUs = esp_timer_get_time();
+				if (!assembler_.isEmpty()) {
+					const auto gapUs = static_cast<uint32_t>(nowUs - lastByteUs_);
+					if (gapUs > timing_.p1MaxUs) {
+						ESP_LOGW(TAG, "Dropped incomplete frame");
+						assembler_.reset();
+						droppedFrames_++;
+					}
+					else {
+						// Bytes are read in chunks, so this is an upper bound of the real gap
+						maxInterByteUs_ = std::max(maxInterByteUs_, gapUs);
+					}
+				}
+				lastByteUs_ = nowUs;
+
+				for (int i = 0; i < bytesRead; i++) {
+					const auto result = assembler_.push(buffer[i], received.frame);
+					if (result == KLineFrameAssembler::INVALID) {
+						ESP_LOGW(TAG, "Received invalid frame (%lu so far)", assembler_.getInvalidFrames());
+						continue;
+					}
+
+					// The line is shared, so every sent frame is also received. They can be ignored
+					if (result != KLineFrameAssembler::COMPLETE || received.frame.source == ADDR_PCB) {
+						continue;
+					}
+
+					received.timestampUs = nowUs;
+					if (xQueueSend(frameQueue_, &received, 0) != pdTRUE) {
+						ESP_LOGW(TAG, "Dropped frame, nobody is waiting for it");
+					}
+				}
+			}
+			break;
+
+			// Buffer Overflow
+			case UART_FIFO_OVF:
+			case UART_BUFFER_FULL:
+				ESP_LOGW(TAG, "UART Buffer Overlow. Flushing");
+				uart_flush_input(UART_PORT);
+				xQueueReset(uartQueueHandle_);
+				assembler_.reset();
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+void KLine::requestTask()
+{
+	Request request;
+
+	nextReportUs_ = esp_timer_get_time() + STATS_INTERVAL_US;
+	int64_t untilPeriodicUs = 0;
+
+	while (true) {
+		// Wake up for the metrics window, the throughput report & the keep-alive even without requests
+		bool requestReceived = xQueueReceive(requestQueue_, &request, pdMS_TO_TICKS(untilPeriodicUs / 1000) + 1) ==
+		                       pdTRUE;
+
+		const int64_t nowUs = esp_timer_get_time();
+		untilPeriodicUs = updatePeriodic(nowUs);
+
+		// Keep the session alive while idle. Its response is only tracked like every other one
+		if (!requestReceived && sessionActive_ && timing_.keepAliveUs > 0 &&
+		    nowUs - lastActivityUs_ >= timing_.keepAliveUs) {
+			request = {};
+			request.payload[0] = SID_TESTER_PRESENT;
+			request.payload[1] = TESTER_PRESENT_RESPONSE_REQUIRED;
+			request.payloadLength = 2;
+			requestReceived = true;
+
+			xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+			metrics_.recordKeepAlive();
+			xSemaphoreGive(metricsMutex_);
+		}
+
+		if (!requestReceived) {
+			continue;
+		}
+
+		Response response;
+		const int64_t startUs = esp_timer_get_time();
+
+		ensureSession(startUs);
+		exchange(request, response);
+
+		updateStats(request, response);
+		recordMetrics(request, response, startUs);
+		if (timing_.adaptive) {
+			adaptTiming(response);
+		}
+		updateSession(response, esp_timer_get_time());
+
+		if (request.callback != nullptr) {
+			request.callback(response, request.ctx);
+		}
+
+		// P3 starts with the end of the response, the time spent in the callback already counts
+		const int64_t lineFreeUs = response.result == RESULT_OK || response.result == RESULT_NEGATIVE_RESPONSE
+			                           ? response.responseUs
+			                           : esp_timer_get_time();
+		waitUntil(lineFreeUs + p3MinUs_);
+	}
+}
+
+/*
+ *	Private Function Implementations
+ */
+bool KLine::transmit(const Request& request)
+{
+	KLineFrame frame;
+	frame.target = ADDR_ECU;
+	frame.source = ADDR_PCB;
+	memcpy(frame.payload, request.payload, request.payloadLength);
+	frame.payloadLength = request.payloadLength;
+
+	uint8_t data[KLINE_MAX_FRAME_LENGTH];
+	const uint8_t length = frame.encode(data, sizeof(data));
+	if (length == 0) {
+		return false;
+	}
+
+	// Without P4 the whole frame is sent in one burst
+	if (timing_.p4MinUs == 0) {
+		const int bytesWritten = uart_write_bytes(UART_PORT, data, length);
+		if (bytesWritten < length) {
+			ESP_LOGW(TAG, "Failed to send full message. Only send %d bytes", bytesWritten);
+			return false;
+		}
+
+		return uart_wait_tx_done(UART_PORT, pdMS_TO_TICKS(TX_TIMEOUT_MS)) == ESP_OK;
+	}
+
+	for (uint8_t i = 0; i < length; i++) {
+		if (uart_write_bytes(UART_PORT, &data[i], 1) < 1 ||
+		    uart_wait_tx_done(UART_PORT, pdMS_TO_TICKS(TX_TIMEOUT_MS)) != ESP_OK) {
+			ESP_LOGW(TAG, "Failed to send full message. Only send %d bytes", i);
+			return false;
+		}
+
+		if (i + 1 < length) {
+			waitUntil(esp_timer_get_time() + timing_.p4MinUs);
+		}
+	}
+
+	return true;
+}
+
+bool KLine::isResponseTo(const Request& request, const KLineFrame& frame)
+{
+	if (frame.payloadLength == 0) {
+		return false;
+	}
+
+	const uint8_t sid = request.payload[0];
+
+	// Negative response
+	if (frame.payload[0] == SID_NEGATIVE_RESPONSE) {
+		return frame.payloadLength >= 2 && frame.payload[1] == sid;
+	}
+
+	if (frame.payload[0] != static_cast<uint8_t>(sid + SID_RESPONSE_OFFSET)) {
+		return false;
+	}
+
+	// Responses of the same SID are told apart by their (first) PID
+	if (sid == SID_RDBI) {
+		return frame.payloadLength >= 3 && frame.payload[1] == request.payload[1] &&
+		       frame.payload[2] == request.payload[2];
+	}
+
+	return true;
+}
+
+void KLine::exchange(const Request& request, Response& response)
+{
+	ReceivedFrame received;
+
+	// Late answers to a previous request
+	xQueueReset(frameQueue_);
+
+	if (!transmit(request)) {
+		response.result = RESULT_SEND_FAILED;
+		return;
+	}
+	response.requestUs = esp_timer_get_time();
+
+	// Wait for the matching response, other frames are dropped
+	const int64_t deadlineUs = response.requestUs + p2MaxUs_;
+	int64_t remainingUs = p2MaxUs_;
+	while (remainingUs > 0) {
+		if (xQueueReceive(frameQueue_, &received, pdMS_TO_TICKS(remainingUs / 1000) + 1) == pdTRUE &&
+		    isResponseTo(request, received.frame)) {
+			response.result = received.frame.payload[0] == SID_NEGATIVE_RESPONSE
+				                  ? RESULT_NEGATIVE_RESPONSE
+				                  : RESULT_OK;
+			memcpy(response.payload, received.frame.payload, received.frame.payloadLength);
+			response.payloadLength = received.frame.payloadLength;
+			response.frames = 1;
+			response.responseUs = received.timestampUs;
+
+			if (request.multiFrame && response.result == RESULT_OK) {
+				collectFrames(request, response);
+			}
+			return;
+		}
+
+		remainingUs = deadlineUs - esp_timer_get_time();
+	}
+}
+
+void KLine::ensureSession(const int64_t nowUs)
+{
+	if (!timing_.fastInit) {
+		return;
+	}
+
+	if (sessionActive_ && nowUs - lastActivityUs_ > SESSION_TIMEOUT_US) {
+		dropSession(nowUs, "expired while idle");
+	}
+
+	if (!sessionActive_ && nowUs >= nextInitUs_) {
+		startSession();
+	}
+}
+
+void KLine::startSession()
+{
+	waitUntil(lastActivityUs_ + INIT_IDLE_US);
+
+	const int64_t startUs = esp_timer_get_time();
+	wakeUp();
+
+	Request request = {};
+	request.payload[0] = SID_START_COMMUNICATION;
+	request.payloadLength = 1;
+
+	Response response;
+	exchange(request, response);
+
+	const int64_t nowUs = esp_timer_get_time();
+	lastActivityUs_ = nowUs;
+
+	if (response.result != RESULT_OK) {
+		const int64_t retryUs = std::min(INIT_RETRY_US << failedInits_, MAX_INIT_RETRY_US);
+		if (retryUs < MAX_INIT_RETRY_US) {
+			failedInits_++;
+		}
+
+		ESP_LOGW(TAG, "Fast init failed (result %d), sending without a session and retrying in %lld ms",
+		         response.result, retryUs / 1000);
+		nextInitUs_ = nowUs + retryUs;
+
+		xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+		metrics_.recordFailedInit();
+		xSemaphoreGive(metricsMutex_);
+		return;
+	}
+
+	const auto initUs = static_cast<uint32_t>(nowUs - startUs);
+	const auto reconnectUs = static_cast<uint32_t>(droppedUs_ < 0 ? 0 : nowUs - droppedUs_);
+	if (droppedUs_ < 0) {
+		ESP_LOGI(TAG, "Session started in %lu us", initUs);
+	}
+	else {
+		ESP_LOGI(TAG, "Session restarted in %lu us, %lu us after the drop", initUs, reconnectUs);
+	}
+
+	sessionActive_ = true;
+	consecutiveTimeouts_ = 0;
+	failedInits_ = 0;
+	droppedUs_ = -1;
+
+	xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+	metrics_.recordSessionStart(nowUs, initUs, reconnectUs);
+	xSemaphoreGive(metricsMutex_);
+
+	// The first request follows after P3 like every other one
+	waitUntil(response.responseUs + p3MinUs_);
+}
+
+void KLine::wakeUp()
+{
+	// The UART can't hold the line low, so the pin is driven directly and handed back afterwards
+	gpio_set_direction(GPIO_TX, GPIO_MODE_OUTPUT);
+	gpio_set_level(GPIO_TX, 0);
+	vTaskDelay(pdMS_TO_TICKS(WAKE_UP_LOW_MS));
+	gpio_set_level(GPIO_TX, 1);
+	vTaskDelay(pdMS_TO_TICKS(WAKE_UP_HIGH_MS));
+
+	uart_set_pin(UART_PORT, GPIO_TX, GPIO_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+
+	// The pattern is received as garbage on the shared line
+	uart_flush_input(UART_PORT);
+}
+
+void KLine::updateSession(const Response& response, const int64_t nowUs)
+{
+	if (!sessionActive_ || response.result == RESULT_SEND_FAILED) {
+		return;
+	}
+
+	lastActivityUs_ = nowUs;
+
+	if (response.result != RESULT_TIMEOUT) {
+		consecutiveTimeouts_ = 0;
+		return;
+	}
+
+	if (++consecutiveTimeouts_ >= MAX_SESSION_TIMEOUTS) {
+		dropSession(nowUs, "no response");
+	}
+}
+
+void KLine::dropSession(const int64_t nowUs, const char* reason)
+{
+	ESP_LOGW(TAG, "Session dropped (%s), reconnecting", reason);
+
+	sessionActive_ = false;
+	droppedUs_ = nowUs;
+	nextInitUs_ = 0;
+
+	xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+	metrics_.recordSessionDrop();
+	xSemaphoreGive(metricsMutex_);
+}
+
+void KLine::collectFrames(const Request& request, Response& response)
+{
+	ReceivedFrame received;
+
+	while (response.frames < KLINE_MAX_RESPONSE_FRAMES) {
+		// The response ends when the ECU doesn't send another frame within P2
+		if (xQueueReceive(frameQueue_, &received, pdMS_TO_TICKS(p2MaxUs_ / 1000) + 1) != pdTRUE) {
+			return;
+		}
+
+		const KLineFrame& frame = received.frame;
+		if (!isResponseTo(request, frame) || frame.payload[0] == SID_NEGATIVE_RESPONSE) {
+			continue;
+		}
+
+		// Without the repeated SID
+		const uint8_t length = frame.payloadLength - 1;
+		if (response.payloadLength + length > KLINE_MAX_RESPONSE_LENGTH) {
+			ESP_LOGW(TAG, "Multi-frame response too long, dropping the rest");
+			return;
+		}
+
+		memcpy(response.payload + response.payloadLength, frame.payload + 1, length);
+		response.payloadLength += length;
+		response.frames++;
+	}
+}
+
+void KLine::updateStats(const Request& request, const Response& response)
+{
+	stats_.requests++;
+
+	if (response.result == RESULT_TIMEOUT) {
+		stats_.timeouts++;
+		return;
+	}
+
+	if (response.result == RESULT_SEND_FAILED) {
+		return;
+	}
+
+	const auto responseUs = static_cast<uint32_t>(response.responseUs - response.requestUs);
+	stats_.responses++;
+	stats_.lastResponseUs = responseUs;
+	stats_.maxResponseUs = std::max(stats_.maxResponseUs, responseUs);
+	stats_.minResponseUs = stats_.responses == 1 ? responseUs : std::min(stats_.minResponseUs, responseUs);
+
+	// 2 bytes per PID after the SID
+	if (response.result == RESULT_OK && request.payload[0] == SID_RDBI) {
+		stats_.pidsRead += (request.payloadLength - 1) / 2;
+	}
+}
+
+void KLine::adaptTiming(const Response& response)
+{
+	// Checksum errors & cut off frames mean the timing is too tight, just like missed responses
+	const uint32_t frameErrors = assembler_.getInvalidFrames() + droppedFrames_;
+	const bool error = response.result == RESULT_TIMEOUT || frameErrors != lastFrameErrors_;
+	lastFrameErrors_ = frameErrors;
+
+	if (error) {
+		if (p2MaxUs_ != timing_.p2MaxUs || p3MinUs_ != timing_.p3MinUs) {
+			ESP_LOGW(TAG, "Error with P2 %lu us & P3 %lu us, restoring the configured timing", p2MaxUs_, p3MinUs_);
+		}
+
+		p2MaxUs_ = timing_.p2MaxUs;
+		p3MinUs_ = timing_.p3MinUs;
+		cleanResponses_ = 0;
+		windowMaxResponseUs_ = 0;
+		return;
+	}
+
+	if (response.result == RESULT_SEND_FAILED) {
+		return;
+	}
+
+	windowMaxResponseUs_ = std::max(windowMaxResponseUs_, stats_.lastResponseUs);
+	if (++cleanResponses_ < ADAPTIVE_WINDOW) {
+		return;
+	}
+
+	// Keep half of the slowest response as margin
+	const uint32_t p2MaxUs = std::clamp(windowMaxResponseUs_ + windowMaxResponseUs_ / 2,
+	                                    std::min(ADAPTIVE_MIN_P2_US, timing_.p2MaxUs), timing_.p2MaxUs);
+	const uint32_t p3MinUs = std::max(p3MinUs_ - p3MinUs_ / ADAPTIVE_P3_STEP_DIVISOR,
+	                                  std::min(ADAPTIVE_MIN_P3_US, timing_.p3MinUs));
+
+	if (p2MaxUs != p2MaxUs_ || p3MinUs != p3MinUs_) {
+		ESP_LOGI(TAG, "Narrowed timing to P2 %lu us & P3 %lu us", p2MaxUs, p3MinUs);
+	}
+
+	p2MaxUs_ = p2MaxUs;
+	p3MinUs_ = p3MinUs;
+	cleanResponses_ = 0;
+	windowMaxResponseUs_ = 0;
+}
+
+void KLine::recordMetrics(const Request& request, const Response& response, const int64_t startUs)
+{
+	KLineMetrics::OUTCOME outcome = KLineMetrics::OUTCOME_SEND_FAILED;
+	uint32_t latencyUs = 0;
+	uint16_t lineBytes = 0;
+
+	switch (response.result) {
+		case RESULT_OK:
+		case RESULT_NEGATIVE_RESPONSE:
+			outcome = response.result == RESULT_OK ? KLineMetrics::OUTCOME_OK
+			                                       : KLineMetrics::OUTCOME_NEGATIVE_RESPONSE;
+			latencyUs = static_cast<uint32_t>(response.responseUs - response.requestUs);
+			// Every following frame of a multi-frame response repeats the SID
+			lineBytes = request.payloadLength + FRAME_OVERHEAD + response.payloadLength +
+			            response.frames * (FRAME_OVERHEAD + 1) - 1;
+			break;
+		case RESULT_TIMEOUT:
+			outcome = KLineMetrics::OUTCOME_TIMEOUT;
+			lineBytes = request.payloadLength + FRAME_OVERHEAD;
+			break;
+		case RESULT_SEND_FAILED:
+			break;
+	}
+
+	// PID reads are also counted per PID
+	uint16_t pids[KLINE_MAX_PIDS_PER_READ];
+	uint8_t pidCount = 0;
+	if (request.payload[0] == SID_RDBI) {
+		for (uint8_t i = 1; i + 1 < request.payloadLength && pidCount < KLINE_MAX_PIDS_PER_READ; i += 2) {
+			pids[pidCount++] = (request.payload[i] << 8) + request.payload[i + 1];
+		}
+	}
+
+	const auto transactionUs = static_cast<uint32_t>(esp_timer_get_time() - startUs);
+
+	xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+	metrics_.record(pids, pidCount, outcome, latencyUs, transactionUs, lineBytes);
+	metrics_.setFrameErrors(assembler_.getInvalidFrames(), droppedFrames_);
+	xSemaphoreGive(metricsMutex_);
+}
+
+int64_t KLine::updatePeriodic(const int64_t nowUs)
+{
+	if (nowUs >= nextMetricsWindowUs_) {
+		xSemaphoreTake(metricsMutex_, portMAX_DELAY);
+		metrics_.closeWindow(nowUs, timing_.baudRate);
+		xSemaphoreGive(metricsMutex_);
+		nextMetricsWindowUs_ = nowUs + METRICS_WINDOW_US;
+	}
+
+	if (nowUs >= nextReportUs_) {
+		const int64_t intervalUs = nowUs - (nextReportUs_ - STATS_INTERVAL_US);
+		stats_.pidsPerSecond = static_cast<float>(stats_.pidsRead - reportedPids_) * 1000000.0f /
+		                       static_cast<float>(intervalUs);
+		reportedPids_ = stats_.pidsRead;
+		nextReportUs_ = nowUs + STATS_INTERVAL_US;
+
+		logStats();
+	}
+
+	int64_t nextUs = std::min(nextMetricsWindowUs_, nextReportUs_);
+	if (sessionActive_ && timing_.keepAliveUs > 0) {
+		nextUs = std::min(nextUs, lastActivityUs_ + timing_.keepAliveUs);
+	}
+
+	return std::max<int64_t>(nextUs - nowUs, 0);
+}
+
+void KLine::waitUntil(const int64_t timestampUs)
+{
+	// Whole ticks are slept, the rest is too short for the scheduler and is busy waited
+	int64_t remainingUs = timestampUs - esp_timer_get_time();
+	if (remainingUs <= 0) {
+		return;
+	}
+
+	const TickType_t ticks = remainingUs / (portTICK_PERIOD_MS * 1000);
+	if (ticks > 0) {
+		vTaskDelay(ticks);
+	}
+
+	remainingUs = timestampUs - esp_timer_get_time();
+	if (remainingUs > 0) {
+		esp_rom_delay_us(static_cast<uint32_t>(remainingUs));
+	}
+}
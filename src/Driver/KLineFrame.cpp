@@ -0,0 +1,98 @@
+#include "Driver/KLineFrame.hpp"
+
+// C++ includes
+#include <cstring>
+
+/*
+ *	constexpr
+ */
+// Lower nibble of the format byte used by the ECU
+constexpr uint8_t FORMAT_ADDRESS_MODE = 0x04;
+
+/*
+ *	Public Function Implementations
+ */
+uint8_t KLineFrame::encode(uint8_t* buffer, const uint8_t size) const
+{
+	const uint8_t length = KLINE_HEADER_LENGTH + payloadLength + 1;
+	if (buffer == nullptr || payloadLength == 0 || payloadLength > KLINE_MAX_PAYLOAD_LENGTH || length > size) {
+		return 0;
+	}
+
+	buffer[0] = static_cast<uint8_t>(((length - 1) << 4) | FORMAT_ADDRESS_MODE);
+	buffer[1] = target;
+	buffer[2] = source;
+	memcpy(buffer + KLINE_HEADER_LENGTH, payload, payloadLength);
+	buffer[length - 1] = checksum(buffer, length - 1);
+
+	return length;
+}
+
+uint8_t KLineFrame::checksum(const uint8_t* data, const uint8_t length)
+{
+	if (data == nullptr) {
+		return 0;
+	}
+
+	uint32_t checksum = 0;
+	for (uint8_t i = 0; i < length; i++) {
+		checksum += data[i];
+	}
+
+	return checksum % 256;
+}
+
+uint8_t KLineFrame::frameLength(const uint8_t format)
+{
+	return (format >> 4) + 1;
+}
+
+KLineFrameAssembler::RESULT KLineFrameAssembler::push(const uint8_t byte, KLineFrame& frame)
+{
+	// Start of a new frame
+	if (length_ == 0) {
+		expectedLength_ = KLineFrame::frameLength(byte);
+
+		if (expectedLength_ < KLINE_MIN_FRAME_LENGTH) {
+			invalidFrames_++;
+			return INVALID;
+		}
+	}
+
+	buffer_[length_++] = byte;
+	if (length_ < expectedLength_) {
+		return INCOMPLETE;
+	}
+
+	// Complete, validate the checksum
+	const uint8_t length = length_;
+	reset();
+
+	if (KLineFrame::checksum(buffer_, length - 1) != buffer_[length - 1]) {
+		invalidFrames_++;
+		return INVALID;
+	}
+
+	frame.target = buffer_[1];
+	frame.source = buffer_[2];
+	frame.payloadLength = length - KLINE_HEADER_LENGTH - 1;
+	memcpy(frame.payload, buffer_ + KLINE_HEADER_LENGTH, frame.payloadLength);
+
+	return COMPLETE;
+}
+
+void KLineFrameAssembler::reset()
+{
+	length_ = 0;
+	expectedLength_ = 0;
+}
+
+bool KLineFrameAssembler::isEmpty() const
+{
+	return length_ == 0;
+}
+
+uint32_t KLineFrameAssembler::getInvalidFrames() const
+{
+	return invalidFrames_;
+}
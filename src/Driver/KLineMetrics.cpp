@@ -0,0 +1,268 @@
+#include "Driver/KLineMetrics.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <sstream>
+
+/*
+ *	constexpr
+ */
+// Start, 8 data & stop bit
+constexpr uint32_t BITS_PER_BYTE = 10;
+
+/*
+ *	Public Function Implementations
+ */
+void KLineLatencyHistogram::add(const uint32_t latencyUs)
+{
+	uint8_t bucket = 0;
+	while (bucket < KLINE_LATENCY_BUCKET_EDGES_US.size() && latencyUs > KLINE_LATENCY_BUCKET_EDGES_US[bucket]) {
+		bucket++;
+	}
+	buckets[bucket]++;
+
+	minUs = count == 0 ? latencyUs : std::min(minUs, latencyUs);
+	maxUs = std::max(maxUs, latencyUs);
+	sumUs += latencyUs;
+	count++;
+}
+
+uint32_t KLineLatencyHistogram::getAverageUs() const
+{
+	return count == 0 ? 0 : static_cast<uint32_t>(sumUs / count);
+}
+
+uint32_t KLineLatencyHistogram::getPercentileUs(const uint8_t percentile) const
+{
+	if (count == 0) {
+		return 0;
+	}
+
+	// Rank of the sample, rounded up
+	const uint32_t rank = std::max<uint32_t>((static_cast<uint64_t>(count) * percentile + 99) / 100, 1);
+
+	uint32_t seen = 0;
+	for (uint8_t i = 0; i < KLINE_LATENCY_BUCKET_EDGES_US.size(); i++) {
+		seen += buckets[i];
+		if (seen >= rank) {
+			return std::min(KLINE_LATENCY_BUCKET_EDGES_US[i], maxUs);
+		}
+	}
+
+	return maxUs;
+}
+
+void KLineMetrics::record(const uint16_t* pids, const uint8_t pidCount, const OUTCOME outcome,
+                          const uint32_t latencyUs, const uint32_t transactionUs, const uint16_t lineBytes)
+{
+	count(total_, outcome, latencyUs);
+
+	for (uint8_t i = 0; i < pidCount && pids != nullptr; i++) {
+		KLinePidMetrics* metrics = findOrAddPid(pids[i]);
+		if (metrics == nullptr) {
+			untrackedPids_++;
+			continue;
+		}
+
+		count(metrics->counters, outcome, latencyUs);
+	}
+
+	windowTransactionUs_ += transactionUs;
+	windowLineBytes_ += lineBytes;
+	if (outcome == OUTCOME_OK || outcome == OUTCOME_NEGATIVE_RESPONSE) {
+		windowResponses_++;
+	}
+}
+
+void KLineMetrics::setFrameErrors(const uint32_t checksumErrors, const uint32_t droppedFrames)
+{
+	checksumErrors_ = checksumErrors;
+	droppedFrames_ = droppedFrames;
+}
+
+void KLineMetrics::closeWindow(const int64_t nowUs, const uint32_t baudRate)
+{
+	// The first window starts with the first call
+	if (windowStartUs_ >= 0 && nowUs > windowStartUs_) {
+		const auto windowUs = static_cast<float>(nowUs - windowStartUs_);
+		const float wireUs = baudRate == 0 ? 0.0f
+		                                   : static_cast<float>(windowLineBytes_) * BITS_PER_BYTE * 1000000.0f /
+		                                     static_cast<float>(baudRate);
+
+		lineUtilization_ = std::min(static_cast<float>(windowTransactionUs_) / windowUs * 100.0f, 100.0f);
+		wireUtilization_ = std::min(wireUs / windowUs * 100.0f, 100.0f);
+		responsesPerSecond_ = static_cast<float>(windowResponses_) * 1000000.0f / windowUs;
+	}
+
+	windowStartUs_ = nowUs;
+	windowTransactionUs_ = 0;
+	windowLineBytes_ = 0;
+	windowResponses_ = 0;
+}
+
+void KLineMetrics::recordSessionStart(const int64_t nowUs, const uint32_t initUs, const uint32_t reconnectUs)
+{
+	session_.active = true;
+	session_.startUs = nowUs;
+	session_.connects++;
+	session_.lastInitUs = initUs;
+
+	if (reconnectUs > 0) {
+		session_.lastReconnectUs = reconnectUs;
+		session_.maxReconnectUs = std::max(session_.maxReconnectUs, reconnectUs);
+	}
+}
+
+void KLineMetrics::recordSessionDrop()
+{
+	session_.active = false;
+	session_.drops++;
+}
+
+void KLineMetrics::recordFailedInit()
+{
+	session_.failedInits++;
+}
+
+void KLineMetrics::recordKeepAlive()
+{
+	session_.keepAlives++;
+}
+
+const KLineSessionCounters& KLineMetrics::getSession() const
+{
+	return session_;
+}
+
+const KLineTransactionCounters& KLineMetrics::getTotal() const
+{
+	return total_;
+}
+
+uint8_t KLineMetrics::getPidCount() const
+{
+	return pidCount_;
+}
+
+const KLinePidMetrics& KLineMetrics::getPid(const uint8_t index) const
+{
+	return pids_[std::min<uint8_t>(index, MAX_METRIC_PIDS - 1)];
+}
+
+float KLineMetrics::getLineUtilization() const
+{
+	return lineUtilization_;
+}
+
+float KLineMetrics::getWireUtilization() const
+{
+	return wireUtilization_;
+}
+
+float KLineMetrics::getResponsesPerSecond() const
+{
+	return responsesPerSecond_;
+}
+
+std::string KLineMetrics::toJson(const int64_t nowUs) const
+{
+	const auto countersToJson = [](std::stringstream& output, const KLineTransactionCounters& counters) {
+		const KLineLatencyHistogram& latency = counters.latency;
+
+		output << "\"requests\":" << counters.requests << ",";
+		output << "\"responses\":" << counters.responses << ",";
+		output << "\"negative\":" << counters.negativeResponses << ",";
+		output << "\"timeouts\":" << counters.timeouts << ",";
+		output << "\"sendFailures\":" << counters.sendFailures << ",";
+		output << "\"latencyUs\":{";
+		output << "\"min\":" << latency.minUs << ",";
+		output << "\"avg\":" << latency.getAverageUs() << ",";
+		output << "\"p50\":" << latency.getPercentileUs(50) << ",";
+		output << "\"p95\":" << latency.getPercentileUs(95) << ",";
+		output << "\"max\":" << latency.maxUs << ",";
+		output << "\"buckets\":[";
+		for (uint8_t i = 0; i < KLINE_LATENCY_BUCKETS; i++) {
+			output << (i == 0 ? "" : ",") << latency.buckets[i];
+		}
+		output << "]}";
+	};
+
+	std::stringstream output;
+	output << "{";
+	output << "\"bucketEdgesUs\":[";
+	for (uint8_t i = 0; i < KLINE_LATENCY_BUCKET_EDGES_US.size(); i++) {
+		output << (i == 0 ? "" : ",") << KLINE_LATENCY_BUCKET_EDGES_US[i];
+	}
+	output << "],";
+	output << "\"checksumErrors\":" << checksumErrors_ << ",";
+	output << "\"droppedFrames\":" << droppedFrames_ << ",";
+	output << "\"lineUtilization\":" << lineUtilization_ << ",";
+	output << "\"wireUtilization\":" << wireUtilization_ << ",";
+	output << "\"responsesPerSecond\":" << responsesPerSecond_ << ",";
+	output << "\"untrackedPids\":" << untrackedPids_ << ",";
+	output << "\"session\":{";
+	output << "\"active\":" << (session_.active ? "true" : "false") << ",";
+	output << "\"uptimeMs\":" << (session_.active ? (nowUs - session_.startUs) / 1000 : 0) << ",";
+	output << "\"connects\":" << session_.connects << ",";
+	output << "\"failedInits\":" << session_.failedInits << ",";
+	output << "\"drops\":" << session_.drops << ",";
+	output << "\"keepAlives\":" << session_.keepAlives << ",";
+	output << "\"lastInitUs\":" << session_.lastInitUs << ",";
+	output << "\"lastReconnectUs\":" << session_.lastReconnectUs << ",";
+	output << "\"maxReconnectUs\":" << session_.maxReconnectUs;
+	output << "},";
+	output << "\"total\":{";
+	countersToJson(output, total_);
+	output << "},";
+	output << "\"pids\":[";
+	for (uint8_t i = 0; i < pidCount_; i++) {
+		output << (i == 0 ? "" : ",") << "{\"pid\":" << pids_[i].pid << ",";
+		countersToJson(output, pids_[i].counters);
+		output << "}";
+	}
+	output << "]";
+	output << "}";
+
+	return output.str();
+}
+
+/*
+ *	Private Function Implementations
+ */
+KLinePidMetrics* KLineMetrics::findOrAddPid(const uint16_t pid)
+{
+	for (uint8_t i = 0; i < pidCount_; i++) {
+		if (pids_[i].pid == pid) {
+			return &pids_[i];
+		}
+	}
+
+	if (pidCount_ >= MAX_METRIC_PIDS) {
+		return nullptr;
+	}
+
+	pids_[pidCount_].pid = pid;
+	return &pids_[pidCount_++];
+}
+
+void KLineMetrics::count(KLineTransactionCounters& counters, const OUTCOME outcome, const uint32_t latencyUs)
+{
+	counters.requests++;
+
+	switch (outcome) {
+		case OUTCOME_OK:
+			counters.responses++;
+			counters.latency.add(latencyUs);
+			break;
+		case OUTCOME_NEGATIVE_RESPONSE:
+			counters.negativeResponses++;
+			counters.latency.add(latencyUs);
+			break;
+		case OUTCOME_TIMEOUT:
+			counters.timeouts++;
+			break;
+		case OUTCOME_SEND_FAILED:
+			counters.sendFailures++;
+			break;
+	}
+}
@@ -2,6 +2,7 @@
 
 // espidf includes
 #include "esp_log.h"
+#include "esp_timer.h"
 
 /*
  *	constexpr
@@ -19,6 +20,7 @@ static IRAM_ATTR void staticIsr(void* arg)
 
 	ActiveSensor* instance = static_cast<ActiveSensor*>(arg);
 	instance->cb();
+	instance->notifyEdge();
 }
 
 /*
@@ -61,4 +63,28 @@ void ActiveSensor::disable()
 
 int ActiveSensor::get() { return 0; }
 
+void ActiveSensor::setEdgeNotification(TaskHandle_t task, std::atomic<uint32_t>* edgeTimeUs)
+{
+	// Cleared first, so the ISR never sees a task together with the timestamp of the previous one
+	notifyTask_ = nullptr;
+	notifyEdgeTimeUs_ = edgeTimeUs;
+	notifyTask_ = task;
+}
+
 void ActiveSensor::cb() {}
+
+void ActiveSensor::notifyEdge()
+{
+	TaskHandle_t task = notifyTask_;
+	if (task == nullptr) {
+		return;
+	}
+
+	if (notifyEdgeTimeUs_ != nullptr) {
+		notifyEdgeTimeUs_->store(static_cast<uint32_t>(esp_timer_get_time()), std::memory_order_relaxed);
+	}
+
+	BaseType_t higherPriorityTaskWoken = pdFALSE;
+	vTaskNotifyGiveFromISR(task, &higherPriorityTaskWoken);
+	portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
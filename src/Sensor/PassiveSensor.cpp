@@ -1,5 +1,8 @@
 #include "Sensor/PassiveSensor.hpp"
 
+// C++ includes
+#include <algorithm>
+
 // espidf includes
 #include "esp_log.h"
 
@@ -8,37 +11,24 @@
  */
 constexpr auto TAG = "PassiveSensor";
 constexpr double VOLTAGE = 3.3;
-constexpr unsigned int ADC_SAMPLE_COUNT = 10;
+constexpr uint8_t ADC_SAMPLE_COUNT = 10;
 
 /*
  *	Public Function Implementations
  */
-PassiveSensor::PassiveSensor(gpio_num_t gpio, adc_channel_t adcChannel, adc_oneshot_unit_handle_t* adc, adc_unit_t unit)
+bool PassiveSensor::setup(const PassiveSensorConfig& config, AdcManager* adc)
 {
-	gpio_ = gpio;
-	channel_ = adcChannel;
+	config_ = config;
 	adc_ = adc;
-	unit_ = unit;
+	setup_ = false;
 
-	// Configure the channel
-	if (adc_oneshot_config_channel(*adc_, channel_, &channelConfig_) != ESP_OK) {
-		ESP_LOGW(TAG, "Couldn't set adc config for channel %d", channel_);
-		return;
-	}
-
-	// Calibrate
-	const adc_cali_curve_fitting_config_t calibrationConfig = {
-		.unit_id = unit_,
-		.chan = channel_,
-		.atten = ADC_ATTEN_DB_12,
-		.bitwidth = ADC_BITWIDTH_DEFAULT,
-	};
-	if (adc_cali_create_scheme_curve_fitting(&calibrationConfig, &calibrationHandle_) != ESP_OK) {
-		ESP_LOGW(TAG, "Couldn't calibrate adc channel %d", channel_);
-		return;
+	adcChannel_ = adc_->addChannel(config_.gpio);
+	if (adcChannel_ < 0) {
+		return false;
 	}
 
 	setup_ = true;
+	return true;
 }
 
 void PassiveSensor::read()
@@ -47,43 +37,179 @@ void PassiveSensor::read()
 		return;
 	}
 
-	int adcValue = 0;
-	unsigned int successfullReads = 0;
-	uint32_t adcValueSum = 0;
-	for (unsigned int i = 0; i < ADC_SAMPLE_COUNT; i++) {
-		if (adc_oneshot_read(*adc_, channel_, &adcValue) == ESP_OK) {
-			successfullReads++;
-			adcValueSum += adcValue;
-		} else {
-			ESP_LOGW(TAG, "Failed to read channel %d", channel_);
+	// A failed read is reported like an electrical fault, the last valid value is kept
+	const esp_err_t result = adc_->readMv(adcChannel_, ADC_SAMPLE_COUNT, voltage_);
+	if (result != ESP_OK) {
+		if (status_ != SignalStore::STATUS_ADC_FAILURE) {
+			ESP_LOGW(TAG, "Failed to read %s: %s", SignalStore::getName(config_.signal), esp_err_to_name(result));
+			status_ = SignalStore::STATUS_ADC_FAILURE;
 		}
+		return;
 	}
 
-	if (successfullReads == 0) {
-		ESP_LOGW(TAG, "Failed to read any data from channel %d", channel_);
-		return;
+	float input = static_cast<float>(voltage_);
+	if (config_.input == PassiveSensorConfig::RESISTANCE_OHM) {
+		input = static_cast<float>(calcVoltageDividerR2(voltage_, config_.seriesResistorOhm));
 	}
 
-	if (adc_cali_raw_to_voltage(calibrationHandle_, adcValueSum / successfullReads, &voltage_) != ESP_OK) {
-		voltage_ = 0;
-		ESP_LOGW(TAG, "Couldn't convert adc channel %d value to voltage", channel_);
+	// Faulty readings must not end up in the filters. The last valid value is kept
+	const SignalStore::STATUS status = classify(input);
+	if (status != status_) {
+		ESP_LOGW(TAG, "%s changed from status %d to %d at %d mV", SignalStore::getName(config_.signal), status_,
+		         status, voltage_);
+		status_ = status;
+	}
+
+	if (status_ != SignalStore::STATUS_OK) {
 		return;
 	}
 
-	specificRead();
+	// Convert, filter and clamp the value
+	const float value = filter(convert(input));
+	value_ = static_cast<int>(std::clamp(value, config_.minValue, config_.maxValue));
+}
+
+int PassiveSensor::get() const
+{
+	return value_;
 }
 
-int PassiveSensor::get()
+int PassiveSensor::getVoltage() const
 {
 	return voltage_;
 }
 
-void PassiveSensor::specificRead() {}
+SignalStore::STATUS PassiveSensor::getStatus() const
+{
+	return status_;
+}
+
+const PassiveSensorConfig& PassiveSensor::getConfig() const
+{
+	return config_;
+}
 
-double PassiveSensor::calcVoltageDividerR2(const int voltageMv, const int r1)
+/*
+ *	Private Function Implementations
+ */
+float PassiveSensor::convert(const float input) const
+{
+	switch (config_.conversion) {
+		case PassiveSensorConfig::THRESHOLD:
+			return input >= config_.threshold ? 1.0f : 0.0f;
+
+		case PassiveSensorConfig::CURVE:
+		{
+			const CurvePoint_t* curve = config_.curve;
+			const uint8_t points = config_.curvePoints;
+			if (points == 0) {
+				return 0.0f;
+			}
+
+			// Outside of our range
+			if (input <= curve[0].x) {
+				return curve[0].y;
+			}
+			if (input >= curve[points - 1].x) {
+				return curve[points - 1].y;
+			}
+
+			// Iterate through all entries
+			for (uint8_t i = 0; i < points - 1; i++) {
+				const CurvePoint_t& p1 = curve[i];
+				const CurvePoint_t& p2 = curve[i + 1];
+
+				// Check if the input is between this and the next entry
+				if (input >= p1.x && input <= p2.x) {
+					// Calculate the value with linear interpolation
+					// y = y1 + (x - x1) * (y2 - y1) / (x2 - x1)
+					return p1.y + ((input - p1.x) * (p2.y - p1.y) / (p2.x - p1.x));
+				}
+			}
+
+			return curve[points - 1].y;
+		}
+
+		case PassiveSensorConfig::NONE:
+		default:
+			return input;
+	}
+}
+
+SignalStore::STATUS PassiveSensor::classify(const float input) const
+{
+	/*
+	 *	Readings near the rails
+	 */
+	if (config_.openCircuitMv > 0 && voltage_ >= config_.openCircuitMv) {
+		return SignalStore::STATUS_OPEN_CIRCUIT;
+	}
+
+	if (config_.shortCircuitMv > 0 && voltage_ <= config_.shortCircuitMv) {
+		return SignalStore::STATUS_SHORT_CIRCUIT;
+	}
+
+	/*
+	 *	Readings outside of the curve range
+	 */
+	if (config_.conversion != PassiveSensorConfig::CURVE || config_.curvePoints == 0 || config_.curveMargin <= 0.0f) {
+		return SignalStore::STATUS_OK;
+	}
+
+	const float lowest = config_.curve[0].x;
+	const float highest = config_.curve[config_.curvePoints - 1].x;
+
+	if (input > highest * (1.0f + config_.curveMargin)) {
+		return SignalStore::STATUS_OPEN_CIRCUIT;
+	}
+
+	if (input < lowest * (1.0f - config_.curveMargin)) {
+		return SignalStore::STATUS_SHORT_CIRCUIT;
+	}
+
+	return SignalStore::STATUS_OK;
+}
+
+float PassiveSensor::filter(const float value)
+{
+	/*
+	 *	Median Filter
+	 */
+	float median = value;
+	if (config_.medianWindow > 1) {
+		medianValues_[medianIndex_] = value;
+		medianIndex_ = (medianIndex_ + 1) % config_.medianWindow;
+		if (medianCount_ < config_.medianWindow) {
+			medianCount_++;
+		}
+
+		float sortedValues[MAX_MEDIAN_WINDOW];
+		std::copy_n(medianValues_, medianCount_, sortedValues);
+		std::nth_element(sortedValues, sortedValues + (medianCount_ / 2), sortedValues + medianCount_);
+
+		// Get the element in the middle
+		median = sortedValues[medianCount_ / 2];
+	}
+
+	/*
+	 *	Dampening new values
+	 */
+	// Initial value
+	if (!smoothed_) {
+		smoothedValue_ = median;
+		smoothed_ = true;
+	}
+
+	// Calculate the dampened value
+	smoothedValue_ = (config_.dampener * median) + ((1.0f - config_.dampener) * smoothedValue_);
+
+	return smoothedValue_;
+}
+
+double PassiveSensor::calcVoltageDividerR2(const int voltageMv, const double r1)
 {
 	const double vOut = static_cast<double>(voltageMv) / 1000.0;
-	const double r = static_cast<double>(r1);
+	const double r = r1;
 
 	// Prevents divison by 0
 	if (vOut >= VOLTAGE) {
@@ -92,4 +218,4 @@ double PassiveSensor::calcVoltageDividerR2(const int voltageMv, const int r1)
 
 	// R2 = R1 * (voltageMv / (preR1VoltageV - voltageMv))
 	return r * (vOut / (VOLTAGE - vOut));
-}
\ No newline at end of file
+}
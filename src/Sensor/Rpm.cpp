@@ -17,7 +17,7 @@ constexpr uint16_t MAX_RPM = 8000;
 /*
  *	Public Function Implementations
  */
-Rpm::Rpm() : ActiveSensor(GPIO_NUM_9, GPIO_INTR_NEGEDGE) {}
+Rpm::Rpm(const gpio_num_t gpio) : ActiveSensor(gpio, GPIO_INTR_NEGEDGE) {}
 
 int Rpm::get()
 {
@@ -0,0 +1,381 @@
+#include "Sensor/SensorRegistry.hpp"
+
+// Project includes
+#include "Sensor/LeftIndicator.hpp"
+#include "Sensor/RightIndicator.hpp"
+#include "Sensor/Rpm.hpp"
+#include "Sensor/Speed.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cstring>
+
+// espidf includes
+#include "esp_log.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "SensorRegistry";
+
+constexpr auto JSON_SENSORS = "Sensors";
+constexpr auto JSON_PASSIVE = "Passive";
+constexpr auto JSON_ACTIVE = "Active";
+
+constexpr float DEFAULT_RATE_HZ = 10.0f;
+constexpr float DEFAULT_MIN_VALUE = -32768.0f;
+constexpr float DEFAULT_MAX_VALUE = 32767.0f;
+
+// Built-in wiring, used when the config doesn't describe the sensors
+constexpr PassiveSensorConfig DEFAULT_PASSIVE_SENSORS[] = {
+	{
+		.signal = SignalStore::FUEL_LEVEL,
+		.gpio = GPIO_NUM_1,
+		.input = PassiveSensorConfig::RESISTANCE_OHM,
+		.seriesResistorOhm = 240,
+		.conversion = PassiveSensorConfig::CURVE,
+		.curve = {{3, 100}, {15.8, 75}, {32.5, 50}, {64.2, 25}, {110, 0}},
+		.curvePoints = 5,
+		.threshold = 0,
+		.medianWindow = 21,
+		.dampener = 0.05f,
+		.minValue = 0,
+		.maxValue = 100,
+		.openCircuitMv = 3100,
+		.shortCircuitMv = 10,
+		.curveMargin = 0.5f,
+		.periodUs = 100000,
+	},
+	{
+		.signal = SignalStore::OIL_PRESSURE,
+		.gpio = GPIO_NUM_2,
+		.input = PassiveSensorConfig::VOLTAGE_MV,
+		.seriesResistorOhm = 0,
+		.conversion = PassiveSensorConfig::THRESHOLD,
+		.curve = {},
+		.curvePoints = 0,
+		.threshold = 2800, // with oil pressure -> 5.1k ohms
+		.medianWindow = 1,
+		.dampener = 1.0f,
+		.minValue = 0,
+		.maxValue = 1,
+		.openCircuitMv = 0,
+		.shortCircuitMv = 0,
+		.curveMargin = 0.0f,
+		.periodUs = 100000,
+	},
+	{
+		.signal = SignalStore::WATER_TEMPERATURE,
+		.gpio = GPIO_NUM_6,
+		.input = PassiveSensorConfig::RESISTANCE_OHM,
+		.seriesResistorOhm = 3000,
+		.conversion = PassiveSensorConfig::CURVE,
+		.curve = {{108, 120}, {122, 115}, {139, 110}, {158, 105}, {181, 100}, {208, 95}, {239, 90},
+		          {276, 85},  {319, 80},  {371, 75},  {433, 70},  {507, 65},  {595, 60}, {701, 55},
+		          {830, 50},  {987, 45},  {1178, 40}, {1412, 35}, {1700, 30}, {2056, 25}, {2499, 20},
+		          {3053, 15}, {3749, 10}, {4627, 5},  {5743, 0}},
+		.curvePoints = 25,
+		.threshold = 0,
+		.medianWindow = 1,
+		.dampener = 1.0f,
+		.minValue = 0,
+		.maxValue = 90,
+		.openCircuitMv = 3100,
+		.shortCircuitMv = 30,
+		// The curve ends at 0 °C, so a cold engine would read as open. The rail checks cover this channel
+		.curveMargin = 0.0f,
+		.periodUs = 1000000,
+	},
+};
+
+constexpr ActiveSensorConfig DEFAULT_ACTIVE_SENSORS[] = {
+	{.signal = SignalStore::RPM, .gpio = GPIO_NUM_9},
+	{.signal = SignalStore::SPEED, .gpio = GPIO_NUM_10},
+	{.signal = SignalStore::LEFT_INDICATOR, .gpio = GPIO_NUM_15},
+	{.signal = SignalStore::RIGHT_INDICATOR, .gpio = GPIO_NUM_7},
+};
+
+/*
+ *	Private Static Functions
+ */
+static PassiveSensorConfig::INPUT parseInput(const char* input)
+{
+	if (input != nullptr && strcmp(input, "Resistance") == 0) {
+		return PassiveSensorConfig::RESISTANCE_OHM;
+	}
+
+	return PassiveSensorConfig::VOLTAGE_MV;
+}
+
+static PassiveSensorConfig::CONVERSION parseConversion(const char* conversion)
+{
+	if (conversion == nullptr) {
+		return PassiveSensorConfig::NONE;
+	}
+	if (strcmp(conversion, "Curve") == 0) {
+		return PassiveSensorConfig::CURVE;
+	}
+	if (strcmp(conversion, "Threshold") == 0) {
+		return PassiveSensorConfig::THRESHOLD;
+	}
+
+	return PassiveSensorConfig::NONE;
+}
+
+static bool isActiveSignal(const SignalStore::SIGNAL signal)
+{
+	return signal == SignalStore::RPM || signal == SignalStore::SPEED || signal == SignalStore::LEFT_INDICATOR ||
+	       signal == SignalStore::RIGHT_INDICATOR;
+}
+
+// Published by a sensor along with its own signal
+static bool isDerivedSignal(const SignalStore::SIGNAL signal)
+{
+	return signal == SignalStore::SPEED_CENTI_KMH;
+}
+
+static uint32_t rateToPeriodUs(float rateHz)
+{
+	if (rateHz <= 0.0f) {
+		rateHz = DEFAULT_RATE_HZ;
+	}
+
+	return static_cast<uint32_t>(1000000.0f / rateHz);
+}
+
+/*
+ *	Public Function Implementations
+ */
+SensorRegistry::~SensorRegistry()
+{
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		activeSensors_[i]->disable();
+		delete activeSensors_[i];
+	}
+}
+
+void SensorRegistry::compile(const ArduinoJson::JsonDocument* config)
+{
+	passiveCount_ = 0;
+	activeCount_ = 0;
+
+	ArduinoJson::JsonVariantConst sensors;
+	if (config != nullptr) {
+		sensors = (*config)[JSON_SENSORS];
+	}
+
+	// Passive sensors
+	if (sensors[JSON_PASSIVE].is<ArduinoJson::JsonArrayConst>()) {
+		compilePassiveSensors(sensors[JSON_PASSIVE].as<ArduinoJson::JsonArrayConst>());
+	}
+	else {
+		for (const auto& sensor : DEFAULT_PASSIVE_SENSORS) {
+			passiveConfigs_[passiveCount_++] = sensor;
+		}
+	}
+
+	// Active sensors
+	if (sensors[JSON_ACTIVE].is<ArduinoJson::JsonArrayConst>()) {
+		compileActiveSensors(sensors[JSON_ACTIVE].as<ArduinoJson::JsonArrayConst>());
+	}
+	else {
+		for (const auto& sensor : DEFAULT_ACTIVE_SENSORS) {
+			activeConfigs_[activeCount_++] = sensor;
+		}
+	}
+
+	ESP_LOGI(TAG, "Compiled %d passive and %d active sensors", passiveCount_, activeCount_);
+}
+
+void SensorRegistry::setup(AdcManager* adc)
+{
+	for (uint8_t i = 0; i < passiveCount_; i++) {
+		if (!passiveSensors_[i].setup(passiveConfigs_[i], adc)) {
+			ESP_LOGW(TAG, "Failed to setup passive sensor %s", SignalStore::getName(passiveConfigs_[i].signal));
+		}
+
+		nextReadUs_[i] = 0;
+	}
+
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		const ActiveSensorConfig& config = activeConfigs_[i];
+
+		switch (config.signal) {
+			case SignalStore::RPM:
+				activeSensors_[i] = new Rpm(config.gpio);
+				break;
+
+			case SignalStore::SPEED:
+				activeSensors_[i] = new Speed(config.gpio);
+				break;
+
+			case SignalStore::LEFT_INDICATOR:
+				activeSensors_[i] = new LeftIndicator(config.gpio);
+				break;
+
+			case SignalStore::RIGHT_INDICATOR:
+				activeSensors_[i] = new RightIndicator(config.gpio);
+				break;
+
+			// Only active signals pass the compilation
+			default:
+				activeSensors_[i] = new ActiveSensor(config.gpio, GPIO_INTR_DISABLE);
+				break;
+		}
+	}
+}
+
+void SensorRegistry::readDuePassiveSensors(SignalStore* store, const int64_t nowUs)
+{
+	for (uint8_t i = 0; i < passiveCount_; i++) {
+		if (nowUs < nextReadUs_[i]) {
+			continue;
+		}
+
+		PassiveSensor& sensor = passiveSensors_[i];
+		sensor.read();
+		store->publish(passiveConfigs_[i].signal, sensor.get(), nowUs, sensor.getStatus());
+
+		nextReadUs_[i] = nowUs + passiveConfigs_[i].periodUs;
+	}
+}
+
+void SensorRegistry::sampleActiveSensors(SignalStore* store, const int64_t nowUs) const
+{
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		store->publish(activeConfigs_[i].signal, activeSensors_[i]->get(), nowUs);
+
+		// The setup created a Speed for the signal
+		if (activeConfigs_[i].signal == SignalStore::SPEED) {
+			const auto* speed = static_cast<const Speed*>(activeSensors_[i]);
+			store->publish(SignalStore::SPEED_CENTI_KMH, static_cast<int32_t>(speed->getCentiKmh()), nowUs);
+		}
+	}
+}
+
+PassiveSensor* SensorRegistry::getPassiveSensor(const SignalStore::SIGNAL signal)
+{
+	for (uint8_t i = 0; i < passiveCount_; i++) {
+		if (passiveConfigs_[i].signal == signal) {
+			return &passiveSensors_[i];
+		}
+	}
+
+	return nullptr;
+}
+
+ActiveSensor* SensorRegistry::getActiveSensor(const SignalStore::SIGNAL signal) const
+{
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		if (activeConfigs_[i].signal == signal) {
+			return activeSensors_[i];
+		}
+	}
+
+	return nullptr;
+}
+
+void SensorRegistry::enableActiveSensors() const
+{
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		activeSensors_[i]->enable();
+	}
+}
+
+void SensorRegistry::disableActiveSensors() const
+{
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		activeSensors_[i]->disable();
+	}
+}
+
+/*
+ *	Private Function Implementations
+ */
+void SensorRegistry::compilePassiveSensors(const ArduinoJson::JsonArrayConst sensors)
+{
+	for (const ArduinoJson::JsonObjectConst entry : sensors) {
+		if (passiveCount_ >= MAX_PASSIVE_SENSORS) {
+			ESP_LOGW(TAG, "Too many passive sensors. Only %d are supported", MAX_PASSIVE_SENSORS);
+			break;
+		}
+
+		const SignalStore::SIGNAL signal = SignalStore::fromName(entry["type"].as<const char*>());
+		if (signal == SignalStore::AMOUNT_SIGNALS || isActiveSignal(signal) || isDerivedSignal(signal) ||
+		    isSignalUsed(signal)) {
+			ESP_LOGW(TAG, "Ignoring unknown or duplicate passive sensor %s", entry["type"].as<const char*>());
+			continue;
+		}
+
+		PassiveSensorConfig& config = passiveConfigs_[passiveCount_];
+		config = {};
+		config.signal = signal;
+		config.gpio = static_cast<gpio_num_t>(entry["gpio"] | static_cast<int>(GPIO_NUM_NC));
+		config.input = parseInput(entry["input"].as<const char*>());
+		config.seriesResistorOhm = entry["seriesResistor"] | 0.0f;
+		config.conversion = parseConversion(entry["conversion"].as<const char*>());
+		config.threshold = entry["threshold"] | 0.0f;
+		config.medianWindow = std::clamp<int>(entry["medianWindow"] | 1, 1, MAX_MEDIAN_WINDOW);
+		config.dampener = std::clamp(entry["dampener"] | 1.0f, 0.0f, 1.0f);
+		config.minValue = entry["min"] | DEFAULT_MIN_VALUE;
+		config.maxValue = entry["max"] | DEFAULT_MAX_VALUE;
+		config.openCircuitMv = entry["openCircuitMv"] | 0;
+		config.shortCircuitMv = entry["shortCircuitMv"] | 0;
+		config.curveMargin = entry["curveMargin"] | 0.0f;
+		config.periodUs = rateToPeriodUs(entry["rateHz"] | DEFAULT_RATE_HZ);
+
+		// Curve points as [x, y] pairs
+		for (const ArduinoJson::JsonArrayConst point : entry["curve"].as<ArduinoJson::JsonArrayConst>()) {
+			if (config.curvePoints >= MAX_CURVE_POINTS) {
+				ESP_LOGW(TAG, "Curve of %s has too many points", SignalStore::getName(signal));
+				break;
+			}
+
+			config.curve[config.curvePoints++] = {point[0] | 0.0f, point[1] | 0.0f};
+		}
+
+		// The interpolation expects the points sorted by x
+		std::sort(config.curve, config.curve + config.curvePoints,
+		          [](const CurvePoint_t& a, const CurvePoint_t& b) { return a.x < b.x; });
+
+		passiveCount_++;
+	}
+}
+
+void SensorRegistry::compileActiveSensors(const ArduinoJson::JsonArrayConst sensors)
+{
+	for (const ArduinoJson::JsonObjectConst entry : sensors) {
+		if (activeCount_ >= MAX_ACTIVE_SENSORS) {
+			ESP_LOGW(TAG, "Too many active sensors. Only %d are supported", MAX_ACTIVE_SENSORS);
+			break;
+		}
+
+		const SignalStore::SIGNAL signal = SignalStore::fromName(entry["type"].as<const char*>());
+		if (!isActiveSignal(signal) || isSignalUsed(signal)) {
+			ESP_LOGW(TAG, "Ignoring unknown or duplicate active sensor %s", entry["type"].as<const char*>());
+			continue;
+		}
+
+		activeConfigs_[activeCount_++] = {
+			.signal = signal,
+			.gpio = static_cast<gpio_num_t>(entry["gpio"] | static_cast<int>(GPIO_NUM_NC)),
+		};
+	}
+}
+
+bool SensorRegistry::isSignalUsed(const SignalStore::SIGNAL signal) const
+{
+	for (uint8_t i = 0; i < passiveCount_; i++) {
+		if (passiveConfigs_[i].signal == signal) {
+			return true;
+		}
+	}
+
+	for (uint8_t i = 0; i < activeCount_; i++) {
+		if (activeConfigs_[i].signal == signal) {
+			return true;
+		}
+	}
+
+	return false;
+}
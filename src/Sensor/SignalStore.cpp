@@ -0,0 +1,103 @@
+#include "Sensor/SignalStore.hpp"
+
+// C++ includes
+#include <cstring>
+
+/*
+ *	constexpr
+ */
+// Names as used in the config, in the order of SignalStore::SIGNAL
+constexpr const char* SIGNAL_NAMES[] = {
+	"FuelLevel", "OilPressure", "WaterTemperature", "Rpm", "Speed", "LeftIndicator", "RightIndicator", "SpeedCentiKmh",
+};
+static_assert(std::size(SIGNAL_NAMES) == SignalStore::AMOUNT_SIGNALS);
+
+/*
+ *	Public Function Implementations
+ */
+const char* SignalStore::getName(const SIGNAL signal)
+{
+	if (signal >= AMOUNT_SIGNALS) {
+		return "Unknown";
+	}
+
+	return SIGNAL_NAMES[signal];
+}
+
+SignalStore::SIGNAL SignalStore::fromName(const char* name)
+{
+	if (name == nullptr) {
+		return AMOUNT_SIGNALS;
+	}
+
+	for (uint8_t i = 0; i < AMOUNT_SIGNALS; i++) {
+		if (strcmp(SIGNAL_NAMES[i], name) == 0) {
+			return static_cast<SIGNAL>(i);
+		}
+	}
+
+	return AMOUNT_SIGNALS;
+}
+
+void SignalStore::publish(const SIGNAL signal, const int32_t value, const int64_t timestampUs, const STATUS status)
+{
+	if (signal >= AMOUNT_SIGNALS) {
+		return;
+	}
+
+	Slot& slot = slots_[signal];
+
+	// Mark the slot as being written
+	const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+	slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.value.store(value, std::memory_order_relaxed);
+	slot.status.store(status, std::memory_order_relaxed);
+	slot.timestampLow.store(static_cast<uint32_t>(timestampUs), std::memory_order_relaxed);
+	slot.timestampHigh.store(static_cast<uint32_t>(static_cast<uint64_t>(timestampUs) >> 32),
+	                         std::memory_order_relaxed);
+
+	// Publish the new values
+	slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+SignalStore::Sample SignalStore::read(const SIGNAL signal) const
+{
+	Sample sample;
+	if (signal >= AMOUNT_SIGNALS) {
+		return sample;
+	}
+
+	const Slot& slot = slots_[signal];
+
+	uint32_t begin = 0;
+	uint32_t low = 0;
+	uint32_t high = 0;
+	uint32_t status = STATUS_OK;
+	do {
+		begin = slot.sequence.load(std::memory_order_acquire);
+
+		sample.value = slot.value.load(std::memory_order_relaxed);
+		status = slot.status.load(std::memory_order_relaxed);
+		low = slot.timestampLow.load(std::memory_order_relaxed);
+		high = slot.timestampHigh.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+	// Retry while a write was in progress or happened in between
+	while ((begin & 1) != 0 || slot.sequence.load(std::memory_order_relaxed) != begin);
+
+	sample.timestampUs = static_cast<int64_t>((static_cast<uint64_t>(high) << 32) | low);
+	sample.status = static_cast<STATUS>(status);
+	sample.generation = begin / 2;
+
+	return sample;
+}
+
+void SignalStore::snapshot(Snapshot& snapshot) const
+{
+	for (uint8_t i = 0; i < AMOUNT_SIGNALS; i++) {
+		snapshot[i] = read(static_cast<SIGNAL>(i));
+	}
+}
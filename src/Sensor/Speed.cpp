@@ -1,8 +1,5 @@
 #include "Sensor/Speed.hpp"
 
-// C++ includes
-#include <math.h>
-
 // espidf includes
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -13,47 +10,55 @@
 constexpr auto TAG = "Speed";
 
 constexpr float MPH_TO_KMH = 1.60934;
+constexpr float MPH_PER_HZ = 0.9f;
 
 constexpr uint16_t DEBOUNCE_TIME_US = 2000;
 
+// The estimator state is logged with this period while moving
+constexpr int64_t LOG_PERIOD_US = 10000000;
+
+constexpr SpeedEstimator::Config ESTIMATOR_CONFIG = {
+	.kmhPerHz = MPH_PER_HZ * MPH_TO_KMH,
+	.pulseCountAboveKmh = 30.0f,
+	.periodBelowKmh = 25.0f,
+	.gateUs = 100000,
+	.standstillUs = 1500000,
+};
+
 /*
  *	Public Function Implementations
  */
-Speed::Speed() : ActiveSensor(GPIO_NUM_10, GPIO_INTR_POSEDGE)
+Speed::Speed(const gpio_num_t gpio) : ActiveSensor(gpio, GPIO_INTR_POSEDGE), estimator_(ESTIMATOR_CONFIG)
 {
 }
 
 int Speed::get()
 {
-	/*
-	 * Check if the car is standing
-	 */
+	SpeedEstimator::Edges edges;
+
 	portENTER_CRITICAL_ISR(&mux_);
-	const int64_t timeSinceLastTrigger = esp_timer_get_time() - fallingEdgeTime_;
+	edges.lastEdgeUs = fallingEdgeTime_;
+	edges.previousEdgeUs = lastFallingEdgeTime_;
+	edges.pulseCount = pulseCount_;
 	portEXIT_CRITICAL_ISR(&mux_);
 
-	// The car is standing still
-	const float secondsSinceLastTrigger = static_cast<float>(timeSinceLastTrigger) / 1000000.0f;
-	if (secondsSinceLastTrigger >= 0.5f) {
-		return 0;
-	}
-
-	/*
-	 * Calculate the current speed
-	 */
-	const int64_t time = fallingEdgeTime_ - lastFallingEdgeTime_;
-	const float seconds = static_cast<float>(time) / 1000000.0f;
+	const int64_t nowUs = esp_timer_get_time();
+	estimator_.update(nowUs, edges);
 
-	// Error detection
-	if (seconds <= 0) {
-		return 0;
+	const uint32_t centiKmh = estimator_.getCentiKmh();
+	if (nowUs >= nextLogUs_ && centiKmh > 0) {
+		ESP_LOGI(TAG, "%lu.%02lu km/h by %s over %lu us, %lu us old", centiKmh / 100, centiKmh % 100,
+		         estimator_.getMode() == SpeedEstimator::PERIOD ? "period" : "pulse count", estimator_.getWindowUs(),
+		         estimator_.getLatencyUs());
+		nextLogUs_ = nowUs + LOG_PERIOD_US;
 	}
 
-	hz_ = 1.0f / seconds;
-	const float mph = hz_ * 0.9f;
-	kmh_ = static_cast<int>(round(mph * MPH_TO_KMH));
+	return estimator_.getKmh();
+}
 
-	return kmh_;
+uint32_t Speed::getCentiKmh() const
+{
+	return estimator_.getCentiKmh();
 }
 
 void Speed::cb()
@@ -65,6 +70,7 @@ void Speed::cb()
 	if ((now - fallingEdgeTime_) > DEBOUNCE_TIME_US) {
 		lastFallingEdgeTime_ = fallingEdgeTime_;
 		fallingEdgeTime_ = now;
+		pulseCount_ = pulseCount_ + 1;
 	}
 
 	portEXIT_CRITICAL_ISR(&mux_);
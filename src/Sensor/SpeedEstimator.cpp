@@ -0,0 +1,123 @@
+#include "Sensor/SpeedEstimator.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+
+/*
+ *	Public Function Implementations
+ */
+SpeedEstimator::SpeedEstimator(const Config& config) : config_(config) {}
+
+void SpeedEstimator::update(const int64_t nowUs, const Edges& edges)
+{
+	// The vehicle is standing still
+	if (edges.pulseCount < 2 || nowUs - edges.lastEdgeUs >= config_.standstillUs) {
+		mode_ = PERIOD;
+		setResult(0.0f, nowUs, nowUs, nowUs);
+		startGate(nowUs, edges);
+		return;
+	}
+
+	if (mode_ == PERIOD) {
+		updatePeriod(nowUs, edges);
+
+		if (kmh_ > config_.pulseCountAboveKmh) {
+			mode_ = PULSE_COUNT;
+			startGate(nowUs, edges);
+		}
+	}
+	else {
+		updatePulseCount(nowUs, edges);
+
+		if (kmh_ < config_.periodBelowKmh) {
+			mode_ = PERIOD;
+		}
+	}
+}
+
+uint32_t SpeedEstimator::getCentiKmh() const
+{
+	return static_cast<uint32_t>(std::lround(kmh_ * 100.0f));
+}
+
+int SpeedEstimator::getKmh() const
+{
+	return static_cast<int>(std::lround(kmh_));
+}
+
+SpeedEstimator::MODE SpeedEstimator::getMode() const
+{
+	return mode_;
+}
+
+uint32_t SpeedEstimator::getLatencyUs() const
+{
+	return latencyUs_;
+}
+
+uint32_t SpeedEstimator::getWindowUs() const
+{
+	return windowUs_;
+}
+
+/*
+ *	Private Function Implementations
+ */
+void SpeedEstimator::updatePeriod(const int64_t nowUs, const Edges& edges)
+{
+	const int64_t periodUs = edges.lastEdgeUs - edges.previousEdgeUs;
+
+	// Error detection
+	if (periodUs <= 0) {
+		return;
+	}
+
+	float kmh = config_.kmhPerHz * 1000000.0f / static_cast<float>(periodUs);
+
+	// No edge for longer than the last period, so the vehicle can't be faster than the time since the last edge
+	// allows. This lets the value drop while slowing down instead of waiting for the next edge
+	const int64_t sinceLastEdgeUs = nowUs - edges.lastEdgeUs;
+	if (sinceLastEdgeUs > periodUs) {
+		kmh = std::min(kmh, config_.kmhPerHz * 1000000.0f / static_cast<float>(sinceLastEdgeUs));
+	}
+
+	setResult(kmh, edges.previousEdgeUs, edges.lastEdgeUs, nowUs);
+}
+
+void SpeedEstimator::updatePulseCount(const int64_t nowUs, const Edges& edges)
+{
+	// Keep the last value until the gate is closed
+	if (nowUs - gateStartUs_ < config_.gateUs) {
+		return;
+	}
+
+	const uint32_t pulses = edges.pulseCount - gateStartCount_;
+	const int64_t edgeSpanUs = edges.lastEdgeUs - gateStartEdgeUs_;
+
+	// No edge within the gate, fall back to the period to let the value decay
+	if (pulses == 0 || edgeSpanUs <= 0) {
+		updatePeriod(nowUs, edges);
+	}
+	else {
+		const float hz = static_cast<float>(pulses) * 1000000.0f / static_cast<float>(edgeSpanUs);
+		setResult(config_.kmhPerHz * hz, gateStartEdgeUs_, edges.lastEdgeUs, nowUs);
+	}
+
+	startGate(nowUs, edges);
+}
+
+void SpeedEstimator::setResult(const float kmh, const int64_t windowStartUs, const int64_t windowEndUs,
+                               const int64_t nowUs)
+{
+	kmh_ = kmh;
+	windowUs_ = static_cast<uint32_t>(windowEndUs - windowStartUs);
+	latencyUs_ = static_cast<uint32_t>(nowUs - (windowStartUs + (windowEndUs - windowStartUs) / 2));
+}
+
+void SpeedEstimator::startGate(const int64_t nowUs, const Edges& edges)
+{
+	gateStartUs_ = nowUs;
+	gateStartEdgeUs_ = edges.lastEdgeUs;
+	gateStartCount_ = edges.pulseCount;
+}
@@ -0,0 +1,91 @@
+#include "State/IdleMonitor.hpp"
+
+// C++ includes
+#include <algorithm>
+
+/*
+ *	Public Function Implementations
+ */
+IdleMonitor::IdleMonitor(const Config& config) : config_(config) {}
+
+bool IdleMonitor::update(const int64_t nowUs, const int32_t rpm, const int32_t oilPressure)
+{
+	// The engine runs
+	if (rpm > 0 || oilPressure > 0) {
+		engineOffSinceUs_ = -1;
+
+		if (state_ == IDLE) {
+			leaveIdle(nowUs, nowUs, WAKE_ENGINE);
+			return true;
+		}
+
+		return false;
+	}
+
+	if (engineOffSinceUs_ < 0) {
+		engineOffSinceUs_ = nowUs;
+	}
+
+	if (state_ == ACTIVE && nowUs - engineOffSinceUs_ >= config_.idleAfterUs) {
+		state_ = IDLE;
+		return true;
+	}
+
+	return false;
+}
+
+bool IdleMonitor::wake(const int64_t eventUs, const int64_t nowUs, const WAKE_REASON reason)
+{
+	// Restart the engine off phase, so a CAN frame keeps the board active for another period
+	engineOffSinceUs_ = nowUs;
+
+	if (state_ != IDLE) {
+		return false;
+	}
+
+	leaveIdle(eventUs, nowUs, reason);
+	return true;
+}
+
+IdleMonitor::STATE IdleMonitor::getState() const
+{
+	return state_;
+}
+
+bool IdleMonitor::isIdle() const
+{
+	return state_ == IDLE;
+}
+
+IdleMonitor::WAKE_REASON IdleMonitor::getLastWakeReason() const
+{
+	return lastWakeReason_;
+}
+
+uint32_t IdleMonitor::getLastWakeLatencyUs() const
+{
+	return lastWakeLatencyUs_;
+}
+
+uint32_t IdleMonitor::getMaxWakeLatencyUs() const
+{
+	return maxWakeLatencyUs_;
+}
+
+uint32_t IdleMonitor::getWakeCount() const
+{
+	return wakeCount_;
+}
+
+/*
+ *	Private Function Implementations
+ */
+void IdleMonitor::leaveIdle(const int64_t eventUs, const int64_t nowUs, const WAKE_REASON reason)
+{
+	state_ = ACTIVE;
+
+	lastWakeReason_ = reason;
+	lastWakeLatencyUs_ = static_cast<uint32_t>(std::max<int64_t>(nowUs - eventUs, 0));
+	maxWakeLatencyUs_ = std::max(maxWakeLatencyUs_, lastWakeLatencyUs_);
+	wakeCount_++;
+}
@@ -2,28 +2,51 @@
 
 // Project includes
 #include "DevelopmentStuff/DataSimulation.h"
-#include "Sensor/FuelLevel.hpp"
-#include "Sensor/LeftIndicator.hpp"
-#include "Sensor/OilPressure.hpp"
-#include "Sensor/RightIndicator.hpp"
-#include "Sensor/Rpm.hpp"
-#include "Sensor/Speed.hpp"
-#include "Sensor/WaterTemperature.hpp"
 #include "Wifi.hpp"
 #include "WifiHost.hpp"
 #include "WifiJoin.hpp"
 
 // espidf includes
 #include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
 
 /*
  *	constexpr
  */
 constexpr auto TAG = "Operation";
 
-constexpr auto PASSIVE_SENSOR_POLL_HZ = 0.1;
+// Every passive sensor is read with its own configured rate, this is only the scheduling granularity
+constexpr auto PASSIVE_SENSOR_TICK_MS = 10;
+constexpr int64_t ADC_STATS_INTERVAL_US = 60 * 1000000LL;
+constexpr auto SAMPLE_SENSORS_HZ = 100;
 constexpr auto BROADCAST_SENSOR_DATA_HZ = 100;
 
+// Rates while the engine is off. RPM edges and CAN frames wake the tasks up immediately
+constexpr auto IDLE_PASSIVE_SENSOR_TICK_MS = 1000;
+constexpr auto IDLE_SAMPLE_SENSORS_HZ = 2;
+constexpr auto IDLE_BROADCAST_SENSOR_DATA_HZ = 1;
+
+// The TWAI and UART drivers hold the APB at 80 MHz anyway, so this is the lowest usable clock
+constexpr auto IDLE_MIN_CPU_FREQ_MHZ = 80;
+
+// Set in the byte of a passive sensor instead of its value. The lower bits carry the SignalStore::STATUS
+constexpr uint8_t SENSOR_FAULT_FLAG = 0x80;
+
+/*
+ *	Private Static Functions
+ */
+static uint8_t passiveSensorByte(const SignalStore::Sample& sample)
+{
+    if (sample.status != SignalStore::STATUS_OK)
+    {
+        return SENSOR_FAULT_FLAG | sample.status;
+    }
+
+    return sample.value;
+}
+
 /*
  *	Private Static Task
  */
@@ -39,6 +62,18 @@ void staticReadPassiveSensorsTask(void* param)
     instance->readPassiveSensorsTask();
 }
 
+void staticSampleSensorsTask(void* param)
+{
+    if (param == nullptr)
+    {
+        return;
+    }
+
+    Operation* instance = static_cast<Operation*>(param);
+
+    instance->sampleSensorsTask();
+}
+
 void staticBroadcastSensorDataTask(void* param)
 {
     if (param == nullptr)
@@ -55,9 +90,11 @@ void staticBroadcastSensorDataTask(void* param)
  *	Public Function implementations
  */
 Operation::Operation() :
-    State(State::OPERATION), readPassiveSensorsTaskHandle_(nullptr), broadCastSensorDataTaskHandle_(nullptr)
+    State(State::OPERATION), readPassiveSensorsTaskHandle_(nullptr), sampleSensorsTaskHandle_(nullptr),
+    broadCastSensorDataTaskHandle_(nullptr)
 {
     config_ = core_->getConfig();
+    signalStore_ = core_->getSignalStore();
 
     // Install ISR Service for the Active Sensors
     if (gpio_install_isr_service(ESP_INTR_FLAG_IRAM) != ESP_OK)
@@ -77,53 +114,52 @@ Operation::Operation() :
     {
         simulationData_ = generateSimulationData();
     }
+
+    /*
+     *	Compile the sensor wiring from the config
+     */
+    sensors_.compile(config_);
+
+    /*
+     *	Publish ECU signals on CAN
+     */
+    ecuCanGateway_.compile(config_);
+
+    /*
+     *	Idle mode
+     */
+    IdleMonitor::Config idleConfig;
+    if ((*config_)["Idle"]["afterSeconds"].is<int>())
+    {
+        idleConfig.idleAfterUs = static_cast<int64_t>((*config_)["Idle"]["afterSeconds"].as<int>()) * 1000000;
+    }
+
+    idleMonitor_ = IdleMonitor(idleConfig);
 }
 
 Operation::~Operation()
 {
     vTaskDelete(readPassiveSensorsTaskHandle_);
+    vTaskDelete(sampleSensorsTaskHandle_);
     vTaskDelete(broadCastSensorDataTaskHandle_);
-
-    for (auto& sensor : passiveSensor_)
-    {
-        free(sensor);
-    }
-
-    for (auto& sensor : activeSensor_)
-    {
-        sensor->disable();
-        free(sensor);
-    }
 }
 
 void Operation::enter()
 {
     /*
-     *	Setup passive sensors
+     *	Setup passive & active sensors
      */
-    const auto adc1Handle = core_->getAdc();
-    passiveSensor_ = {
-        new FuelLevel(adc1Handle),
-        new OilPressure(adc1Handle),
-        new WaterTemperature(adc1Handle),
-    };
+    sensors_.setup(core_->getAdc());
+    sensors_.enableActiveSensors();
 
     /*
-     *	Setup active sensors
+     *	ECU to CAN gateway
      */
-    activeSensor_ = {
-        new Rpm(),
-        new Speed(),
-        new LeftIndicator(),
-        new RightIndicator(),
-    };
-    for (const auto& sensor : activeSensor_)
-    {
-        sensor->enable();
-    }
+    ecuCanGateway_.start(core_->getCan(), core_->getEcuPollScheduler(), core_->getEcuValueCache(),
+                         core_->getEcuDtcReader());
 
     /*
-     *	Setup read & broadcast task
+     *	Setup read, sample & broadcast task
      */
     if (xTaskCreate(staticReadPassiveSensorsTask, "OperationReadPassiveSensorsTask", 2048, this, 2,
                     &readPassiveSensorsTaskHandle_) != pdPASS)
@@ -131,6 +167,12 @@ void Operation::enter()
         ESP_LOGE(TAG, "Failed to create task for reading all passive HW sensors");
     }
 
+    if (xTaskCreate(staticSampleSensorsTask, "OperationSampleSensorsTask", 2048 * 2, this, 2,
+                    &sampleSensorsTaskHandle_) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create task for sampling all sensors");
+    }
+
     if (xTaskCreate(staticBroadcastSensorDataTask, "OperationBroadcastSensorDataTask", 2048 * 2, this, 2,
                     &broadCastSensorDataTaskHandle_) != pdPASS)
     {
@@ -205,6 +247,14 @@ void Operation::handleCanFrame(const Can::Frame& frame)
         return;
     }
 
+    // Every frame wakes the board up from the idle mode
+    if (idle_)
+    {
+        canFrameUs_ = static_cast<uint32_t>(esp_timer_get_time());
+        canWakePending_ = true;
+        xTaskNotifyGive(sampleSensorsTaskHandle_);
+    }
+
     if (frame.group != CanFrame::GROUP::WIFI)
     {
         return;
@@ -265,16 +315,42 @@ void Operation::handleCanFrame(const Can::Frame& frame)
     }
 }
 
-void Operation::readPassiveSensorsTask() const
+void Operation::readPassiveSensorsTask()
 {
+    int64_t nextAdcStatsUs = ADC_STATS_INTERVAL_US;
+
     while (true)
     {
-        for (auto& sensor : passiveSensor_)
+        const int64_t nowUs = esp_timer_get_time();
+        sensors_.readDuePassiveSensors(signalStore_, nowUs);
+
+        // Report read failures & latencies, especially of channels shared with Wi-Fi
+        if (nowUs >= nextAdcStatsUs)
         {
-            sensor->read();
+            core_->getAdc()->logStats();
+            nextAdcStatsUs = nowUs + ADC_STATS_INTERVAL_US;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000.0 / PASSIVE_SENSOR_POLL_HZ));
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idle_ ? IDLE_PASSIVE_SENSOR_TICK_MS : PASSIVE_SENSOR_TICK_MS));
+    }
+}
+
+void Operation::sampleSensorsTask()
+{
+    bool woken = false;
+
+    while (true)
+    {
+        const int64_t nowUs = esp_timer_get_time();
+
+        // Every value is computed exactly once per tick, consumers only read the signal store
+        sensors_.sampleActiveSensors(signalStore_, nowUs);
+
+        updateIdleState(nowUs, woken);
+
+        // Woken up early by an RPM edge or a CAN frame while idle
+        const auto hz = idle_ ? IDLE_SAMPLE_SENSORS_HZ : SAMPLE_SENSORS_HZ;
+        woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000 / hz)) > 0;
     }
 }
 
@@ -290,30 +366,33 @@ void Operation::broadcastSensorsTask() const
 
     uint8_t lastData[8] = {0x00};
 
+    SignalStore::Snapshot snapshot;
+
     while (true)
     {
         if (!simulation_)
         {
+            signalStore_->snapshot(snapshot);
+
             // Fuel Level, Oil Pressure, Water Temperature
-            for (uint8_t i = 0; i < passiveSensor_.size(); i++)
-            {
-                frame.data[i] = passiveSensor_.at(i)->get();
-            }
+            frame.data[0] = passiveSensorByte(snapshot[SignalStore::FUEL_LEVEL]);
+            frame.data[1] = passiveSensorByte(snapshot[SignalStore::OIL_PRESSURE]);
+            frame.data[2] = passiveSensorByte(snapshot[SignalStore::WATER_TEMPERATURE]);
             // frame.data[0] = static_cast<uint8_t>(esp_random() % 101);
 
             // RPM
-            const auto& rpm = activeSensor_.at(0)->get();
+            const auto& rpm = snapshot[SignalStore::RPM].value;
             frame.data[3] = rpm >> 8;
             frame.data[4] = rpm & 0xFF;
 
             // Speed
-            frame.data[5] = activeSensor_.at(1)->get();
+            frame.data[5] = snapshot[SignalStore::SPEED].value;
 
             // Left Indicator
-            frame.data[6] = activeSensor_.at(2)->get();
+            frame.data[6] = snapshot[SignalStore::LEFT_INDICATOR].value;
 
             // Right Indicator
-            frame.data[7] = activeSensor_.at(3)->get();
+            frame.data[7] = snapshot[SignalStore::RIGHT_INDICATOR].value;
 
             // Did the data stay the same?
             bool equal = true;
@@ -328,7 +407,8 @@ void Operation::broadcastSensorsTask() const
                 memcpy(lastData, frame.data, frame.dataLengthCode);
             }
 
-            vTaskDelay(pdMS_TO_TICKS(1000 / BROADCAST_SENSOR_DATA_HZ));
+            const auto hz = idle_ ? IDLE_BROADCAST_SENSOR_DATA_HZ : BROADCAST_SENSOR_DATA_HZ;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000 / hz));
         } else
         {
             static unsigned int frameIndex = 0;
@@ -352,6 +432,94 @@ void Operation::broadcastSensorsTask() const
 /*
  *	Private Function Implementations
  */
+void Operation::updateIdleState(const int64_t nowUs, const bool woken)
+{
+    // The simulated data doesn't reflect the real engine
+    if (simulation_)
+    {
+        return;
+    }
+
+    bool changed = false;
+
+    if (woken && idle_)
+    {
+        // Rebuild the full timestamp of the event from its lower 32 bits
+        const auto nowLow = static_cast<uint32_t>(nowUs);
+        if (canWakePending_.exchange(false))
+        {
+            const int64_t eventUs = nowUs - static_cast<uint32_t>(nowLow - canFrameUs_.load());
+            changed |= idleMonitor_.wake(eventUs, nowUs, IdleMonitor::WAKE_CAN_FRAME);
+        }
+        else
+        {
+            const int64_t eventUs = nowUs - static_cast<uint32_t>(nowLow - rpmEdgeUs_.load());
+            changed |= idleMonitor_.wake(eventUs, nowUs, IdleMonitor::WAKE_RPM_EDGE);
+        }
+    }
+
+    // A faulty oil pressure sensor doesn't keep the board awake
+    const SignalStore::Sample oilPressure = signalStore_->read(SignalStore::OIL_PRESSURE);
+    changed |= idleMonitor_.update(nowUs, signalStore_->read(SignalStore::RPM).value,
+                                   oilPressure.status == SignalStore::STATUS_OK ? oilPressure.value : 0);
+
+    if (changed)
+    {
+        applyIdleState();
+    }
+}
+
+void Operation::applyIdleState()
+{
+    const bool idle = idleMonitor_.isIdle();
+    idle_ = idle;
+
+    // Only while idle, otherwise every edge would wake the sample task
+    ActiveSensor* rpm = sensors_.getActiveSensor(SignalStore::RPM);
+    if (rpm != nullptr)
+    {
+        rpm->setEdgeNotification(idle ? xTaskGetCurrentTaskHandle() : nullptr, &rpmEdgeUs_);
+    }
+
+    configurePowerManagement(idle);
+
+    if (idle)
+    {
+        ESP_LOGI(TAG, "Engine is off, entering idle mode");
+        return;
+    }
+
+    ESP_LOGI(TAG, "Leaving idle mode (reason %d) after %lu us, slowest wake up so far %lu us",
+             idleMonitor_.getLastWakeReason(), idleMonitor_.getLastWakeLatencyUs(),
+             idleMonitor_.getMaxWakeLatencyUs());
+
+    // Don't let the other tasks sleep until their idle period is over
+    xTaskNotifyGive(readPassiveSensorsTaskHandle_);
+    xTaskNotifyGive(broadCastSensorDataTaskHandle_);
+}
+
+void Operation::configurePowerManagement(const bool idle) const
+{
+#if CONFIG_PM_ENABLE
+    // Light sleep would stop the TWAI controller and the soft AP, so only the clock is scaled
+    esp_pm_config_t pmConfig = {};
+    pmConfig.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    pmConfig.min_freq_mhz = idle ? IDLE_MIN_CPU_FREQ_MHZ : CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    pmConfig.light_sleep_enable = false;
+
+    if (esp_pm_configure(&pmConfig) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to configure the dynamic frequency scaling");
+    }
+#endif
+
+    // Only has an effect when joined to a network, the soft AP can't sleep
+    if (core_->getWifi() != nullptr)
+    {
+        esp_wifi_set_ps(idle ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+    }
+}
+
 void Operation::setupDisplayWifi() const
 {
     ESP_LOGI(TAG, "Starting to transmit SSID and Password to the displays");
@@ -0,0 +1,146 @@
+#include "WebInterface/AssetArchive.hpp"
+
+// C++ includes
+#include <cstring>
+
+// espidf includes
+#include "esp_log.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "AssetArchive";
+
+constexpr size_t HEADER_SIZE = 16;
+
+// Flags of an index entry
+constexpr uint16_t FLAG_GZIP = 0x0001;
+
+/*
+ *	Private Static Functions
+ */
+static uint32_t readU32(const uint8_t* data)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+/*
+ *	Public Function Implementations
+ */
+AssetArchive::~AssetArchive()
+{
+	if (mapped_) {
+		esp_partition_munmap(mmapHandle_);
+	}
+}
+
+bool AssetArchive::map(const char* partitionLabel)
+{
+	const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+	                                                             partitionLabel);
+	if (partition == nullptr) {
+		ESP_LOGE(TAG, "No partition %s", partitionLabel);
+		return false;
+	}
+
+	const void* mapped;
+	if (esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &mapped, &mmapHandle_) != ESP_OK) {
+		ESP_LOGE(TAG, "Failed to map partition %s", partitionLabel);
+		return false;
+	}
+	mapped_ = true;
+
+	if (!open(static_cast<const uint8_t*>(mapped), partition->size)) {
+		esp_partition_munmap(mmapHandle_);
+		mapped_ = false;
+		return false;
+	}
+
+	ESP_LOGI(TAG, "Mapped %lu assets from %s", count_, partitionLabel);
+	return true;
+}
+
+bool AssetArchive::open(const uint8_t* archive, const size_t size)
+{
+	archive_ = nullptr;
+	index_ = nullptr;
+	count_ = 0;
+
+	if (archive == nullptr || size < HEADER_SIZE || readU32(archive) != ASSET_ARCHIVE_MAGIC) {
+		ESP_LOGE(TAG, "No asset archive");
+		return false;
+	}
+
+	const uint32_t count = readU32(archive + 4);
+	const uint32_t namesOffset = readU32(archive + 8);
+	const uint32_t dataOffset = readU32(archive + 12);
+
+	if (count > (size - HEADER_SIZE) / sizeof(IndexEntry) || namesOffset < HEADER_SIZE + count * sizeof(IndexEntry) ||
+	    dataOffset < namesOffset || dataOffset > size) {
+		ESP_LOGE(TAG, "Corrupt asset archive header");
+		return false;
+	}
+
+	// The entries are 4 byte aligned in the archive, so they are used in place
+	const auto* index = reinterpret_cast<const IndexEntry*>(archive + HEADER_SIZE);
+	for (uint32_t i = 0; i < count; i++) {
+		const IndexEntry& entry = index[i];
+		if (entry.nameOffset < namesOffset || entry.nameOffset + entry.nameLength > dataOffset ||
+		    entry.dataOffset < dataOffset || entry.dataLength > size - entry.dataOffset) {
+			ESP_LOGE(TAG, "Corrupt asset archive entry %lu", i);
+			return false;
+		}
+	}
+
+	archive_ = archive;
+	size_ = size;
+	index_ = index;
+	count_ = count;
+
+	return true;
+}
+
+bool AssetArchive::find(const std::string_view path, Asset& asset) const
+{
+	uint32_t low = 0;
+	uint32_t high = count_;
+
+	while (low < high) {
+		const uint32_t middle = low + (high - low) / 2;
+		const int order = getName(index_[middle]).compare(path);
+
+		if (order < 0) {
+			low = middle + 1;
+		}
+		else if (order > 0) {
+			high = middle;
+		}
+		else {
+			const IndexEntry& entry = index_[middle];
+			asset = {
+				.data = archive_ + entry.dataOffset,
+				.size = entry.dataLength,
+				.gzip = (entry.flags & FLAG_GZIP) != 0,
+				.etag = std::string_view(entry.etag, ASSET_ETAG_LENGTH),
+			};
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint32_t AssetArchive::getCount() const
+{
+	return count_;
+}
+
+/*
+ *	Private Function Implementations
+ */
+std::string_view AssetArchive::getName(const IndexEntry& entry) const
+{
+	return {reinterpret_cast<const char*>(archive_ + entry.nameOffset), entry.nameLength};
+}
@@ -0,0 +1,62 @@
+#include "WebInterface/SensorUpdateFrame.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+
+/*
+ *	Public Function Implementations
+ */
+SensorUpdateFrame::SensorUpdateFrame(const int64_t nowMs) : nowMs_(nowMs)
+{
+	data_[length_++] = WS_BINARY_SENSOR_UPDATE;
+	data_[length_++] = 0;
+	write32(static_cast<uint32_t>(nowMs));
+}
+
+bool SensorUpdateFrame::add(const uint16_t sensorId, const int64_t timestampMs, const double value)
+{
+	if (data_[1] >= SENSOR_UPDATE_MAX_SAMPLES) {
+		return false;
+	}
+
+	const double scaled = std::round(value * SENSOR_UPDATE_VALUE_SCALE);
+	const int64_t ageMs = std::clamp<int64_t>(nowMs_ - timestampMs, 0, UINT16_MAX);
+
+	write16(sensorId);
+	write16(static_cast<uint16_t>(ageMs));
+	write32(static_cast<uint32_t>(static_cast<int32_t>(std::clamp<double>(scaled, INT32_MIN, INT32_MAX))));
+	data_[1]++;
+
+	return true;
+}
+
+uint8_t SensorUpdateFrame::getSampleCount() const
+{
+	return data_[1];
+}
+
+const uint8_t* SensorUpdateFrame::getData() const
+{
+	return data_.data();
+}
+
+size_t SensorUpdateFrame::getLength() const
+{
+	return length_;
+}
+
+/*
+ *	Private Function Implementations
+ */
+void SensorUpdateFrame::write16(const uint16_t value)
+{
+	data_[length_++] = value & 0xFF;
+	data_[length_++] = value >> 8;
+}
+
+void SensorUpdateFrame::write32(const uint32_t value)
+{
+	write16(value & 0xFFFF);
+	write16(value >> 16);
+}
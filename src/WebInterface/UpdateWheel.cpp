@@ -0,0 +1,102 @@
+#include "WebInterface/UpdateWheel.hpp"
+
+// C++ includes
+#include <algorithm>
+
+/*
+ *	Public Function Implementations
+ */
+void UpdateWheel::add(const int client, const uint16_t sensorId, const uint32_t periodMs)
+{
+	const auto periodTicks = static_cast<uint16_t>(
+		std::clamp<uint32_t>((periodMs + UPDATE_WHEEL_TICK_MS / 2) / UPDATE_WHEEL_TICK_MS, 1, UINT16_MAX));
+
+	// The new period starts with the next send
+	Item* item = find(client, sensorId);
+	if (item != nullptr) {
+		item->periodTicks = periodTicks;
+		return;
+	}
+
+	slots_[cursor_].push_back({.client = client, .sensorId = sensorId, .periodTicks = periodTicks, .rounds = 0,
+	                           .lastTimestampUs = -1});
+}
+
+void UpdateWheel::remove(const int client, const uint16_t sensorId)
+{
+	for (std::vector<Item>& slot : slots_) {
+		std::erase_if(slot, [client, sensorId](const Item& item) {
+			return item.client == client && item.sensorId == sensorId;
+		});
+	}
+}
+
+void UpdateWheel::removeClient(const int client)
+{
+	for (std::vector<Item>& slot : slots_) {
+		std::erase_if(slot, [client](const Item& item) { return item.client == client; });
+	}
+}
+
+uint32_t UpdateWheel::getPeriodMs(const int client, const uint16_t sensorId) const
+{
+	for (const std::vector<Item>& slot : slots_) {
+		for (const Item& item : slot) {
+			if (item.client == client && item.sensorId == sensorId) {
+				return item.periodTicks * UPDATE_WHEEL_TICK_MS;
+			}
+		}
+	}
+
+	return 0;
+}
+
+void UpdateWheel::tick(const DueCallback callback, void* ctx)
+{
+	std::vector<Item>& slot = slots_[cursor_];
+
+	due_.clear();
+	for (size_t i = 0; i < slot.size();) {
+		if (slot[i].rounds > 0) {
+			slot[i].rounds--;
+			i++;
+			continue;
+		}
+
+		due_.push_back(slot[i]);
+		slot[i] = slot.back();
+		slot.pop_back();
+	}
+
+	for (Item& item : due_) {
+		if (callback != nullptr) {
+			callback(item, ctx);
+		}
+
+		schedule(item, item.periodTicks);
+	}
+
+	cursor_ = (cursor_ + 1) % UPDATE_WHEEL_SLOTS;
+}
+
+/*
+ *	Private Function Implementations
+ */
+void UpdateWheel::schedule(const Item& item, const uint16_t ticks)
+{
+	Item& scheduled = slots_[(cursor_ + ticks) % UPDATE_WHEEL_SLOTS].emplace_back(item);
+	scheduled.rounds = (ticks - 1) / UPDATE_WHEEL_SLOTS;
+}
+
+UpdateWheel::Item* UpdateWheel::find(const int client, const uint16_t sensorId)
+{
+	for (std::vector<Item>& slot : slots_) {
+		for (Item& item : slot) {
+			if (item.client == client && item.sensorId == sensorId) {
+				return &item;
+			}
+		}
+	}
+
+	return nullptr;
+}
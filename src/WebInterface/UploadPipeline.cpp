@@ -0,0 +1,196 @@
+#include "WebInterface/UploadPipeline.hpp"
+
+// C++ includes
+#include <algorithm>
+
+// espidf includes
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+#include "unistd.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "UploadPipeline";
+
+/*
+ *	Private Static Tasks
+ */
+static void staticWriterTask(void* param)
+{
+	if (param == nullptr) {
+		vTaskDelete(nullptr);
+	}
+
+	static_cast<UploadPipeline*>(param)->writerTask();
+}
+
+/*
+ *	Public Function Implementations
+ */
+UploadPipeline::~UploadPipeline()
+{
+	release();
+}
+
+bool UploadPipeline::run(httpd_req_t* p_reqst, FILE* file, Result& result)
+{
+	result = {};
+
+	if (file == nullptr || !allocate()) {
+		return false;
+	}
+
+	file_ = file;
+	writeFailed_ = false;
+	receiverTaskHandle_ = xTaskGetCurrentTaskHandle();
+
+	// The writes are large already, a stdio buffer would only add a copy
+	setvbuf(file_, nullptr, _IONBF, 0);
+
+	// Allocates the clusters up front instead of with every write
+	const size_t total = p_reqst->content_len;
+	if (ftruncate(fileno(file_), static_cast<off_t>(total)) != 0 || fseek(file_, 0, SEEK_SET) != 0) {
+		ESP_LOGW(TAG, "Couldn't preallocate %u bytes", static_cast<unsigned>(total));
+	}
+
+	if (xTaskCreate(staticWriterTask, "UploadWriterTask", 2048 * 2, this, 5, &writerTaskHandle_) != pdPASS) {
+		ESP_LOGE(TAG, "Failed to create the writer task");
+		writerTaskHandle_ = nullptr;
+		release();
+		return false;
+	}
+
+	mbedtls_sha256_context sha256;
+	mbedtls_sha256_init(&sha256);
+	mbedtls_sha256_starts(&sha256, 0);
+
+	const int64_t startUs = esp_timer_get_time();
+	size_t remaining = total;
+	size_t filled = 0;
+	bool received = true;
+
+	uint8_t current;
+	xQueueReceive(freeQueue_, &current, portMAX_DELAY);
+
+	while (remaining > 0 && !writeFailed_) {
+		const int length = httpd_req_recv(p_reqst, reinterpret_cast<char*>(buffers_[current] + filled),
+		                                  std::min(remaining, UPLOAD_BUFFER_B - filled));
+		if (length <= 0) {
+			// Retry on timeout
+			if (length == HTTPD_SOCK_ERR_TIMEOUT) {
+				continue;
+			}
+
+			received = false;
+			break;
+		}
+
+		mbedtls_sha256_update(&sha256, buffers_[current] + filled, length);
+		filled += length;
+		remaining -= length;
+
+		if (filled < UPLOAD_BUFFER_B && remaining > 0) {
+			continue;
+		}
+
+		// Hand the full buffer to the writer and continue with the other one
+		const Chunk chunk = {.bufferIndex = current, .length = filled};
+		xQueueSend(filledQueue_, &chunk, portMAX_DELAY);
+		filled = 0;
+
+		if (remaining > 0) {
+			const int64_t waitStartUs = esp_timer_get_time();
+			xQueueReceive(freeQueue_, &current, portMAX_DELAY);
+			result.writerWaitUs += static_cast<uint32_t>(esp_timer_get_time() - waitStartUs);
+		}
+	}
+
+	// Ends the writer once it wrote everything queued
+	const Chunk end = {.bufferIndex = 0, .length = 0};
+	xQueueSend(filledQueue_, &end, portMAX_DELAY);
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	writerTaskHandle_ = nullptr;
+
+	mbedtls_sha256_finish(&sha256, result.sha256.data());
+	mbedtls_sha256_free(&sha256);
+
+	result.bytes = total - remaining;
+	result.durationUs = static_cast<uint32_t>(esp_timer_get_time() - startUs);
+
+	release();
+
+	return received && !writeFailed_;
+}
+
+void UploadPipeline::writerTask()
+{
+	Chunk chunk;
+	while (xQueueReceive(filledQueue_, &chunk, portMAX_DELAY) == pdTRUE && chunk.length > 0) {
+		// Keeps taking the buffers after a failure, so the receiver doesn't block
+		if (!writeFailed_ && fwrite(buffers_[chunk.bufferIndex], 1, chunk.length, file_) != chunk.length) {
+			ESP_LOGE(TAG, "Failed writing into the file");
+			writeFailed_ = true;
+		}
+
+		xQueueSend(freeQueue_, &chunk.bufferIndex, portMAX_DELAY);
+	}
+
+	if (!writeFailed_ && (fflush(file_) != 0 || fsync(fileno(file_)) != 0)) {
+		ESP_LOGE(TAG, "Failed flushing the file");
+		writeFailed_ = true;
+	}
+
+	xTaskNotifyGive(receiverTaskHandle_);
+	vTaskDelete(nullptr);
+}
+
+/*
+ *	Private Function Implementations
+ */
+bool UploadPipeline::allocate()
+{
+	// DMA capable buffers are written to the SD card without another copy
+	for (uint8_t*& buffer : buffers_) {
+		buffer = static_cast<uint8_t*>(heap_caps_malloc(UPLOAD_BUFFER_B, MALLOC_CAP_DMA));
+		if (buffer == nullptr) {
+			buffer = static_cast<uint8_t*>(heap_caps_malloc(UPLOAD_BUFFER_B, MALLOC_CAP_8BIT));
+		}
+	}
+
+	// The end of the upload is queued on top of the buffers
+	filledQueue_ = xQueueCreate(UPLOAD_BUFFER_COUNT + 1, sizeof(Chunk));
+	freeQueue_ = xQueueCreate(UPLOAD_BUFFER_COUNT, sizeof(uint8_t));
+
+	if (std::ranges::find(buffers_, nullptr) != buffers_.end() || filledQueue_ == nullptr || freeQueue_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to allocate the upload buffers");
+		release();
+		return false;
+	}
+
+	for (uint8_t i = 0; i < UPLOAD_BUFFER_COUNT; i++) {
+		xQueueSend(freeQueue_, &i, 0);
+	}
+
+	return true;
+}
+
+void UploadPipeline::release()
+{
+	for (uint8_t*& buffer : buffers_) {
+		heap_caps_free(buffer);
+		buffer = nullptr;
+	}
+
+	if (filledQueue_ != nullptr) {
+		vQueueDelete(filledQueue_);
+		filledQueue_ = nullptr;
+	}
+
+	if (freeQueue_ != nullptr) {
+		vQueueDelete(freeQueue_);
+		freeQueue_ = nullptr;
+	}
+}
@@ -4,10 +4,20 @@
 #include "Driver/EcuSensors.hpp"
 #include "Event.hpp"
 #include "Core.hpp"
+#include "WebInterface/AssetArchive.hpp"
+#include "WebInterface/SensorUpdateFrame.hpp"
+#include "WebInterface/UploadPipeline.hpp"
+#include "WebInterface/WebsocketOutbox.hpp"
 
 // C++ includes
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <sstream>
 
+// espidf includes
+#include "esp_timer.h"
+
 /*
  *	Prototypes
  */
@@ -23,18 +33,44 @@ constexpr auto JSON_WIFI_MODE = "OverwriteWifiMode";
 constexpr auto JSON_WIFI_HOST = "WifiHost";
 constexpr auto JSON_WIFI_JOIN = "WifiJoin";
 
-constexpr uint16_t FILE_CHUNK_SIZE_B = 1024;
+// Versioned URLs never change their content, the pages are revalidated with their ETag
+constexpr auto CACHE_CONTROL_VERSIONED = "public, max-age=31536000, immutable";
+constexpr auto CACHE_CONTROL_REVALIDATE = "no-cache";
 
 constexpr uint16_t WEBSOCKET_RECV_BUFFER_B = 256;
 
+// Update rate of a sensor if the client doesn't request one and the range of the requested ones. The ECU is polled
+// with the same rate
+constexpr float DEFAULT_UPDATE_RATE_HZ = 2.0f;
+constexpr float MIN_UPDATE_RATE_HZ = 0.1f;
+constexpr float MAX_UPDATE_RATE_HZ = 1000.0f / UPDATE_WHEEL_TICK_MS;
+
+constexpr auto PROTOCOL_PREFIX = "protocol:";
+
 constexpr httpd_uri_t FILE_URI = {
 	.uri = "/*", .method = HTTP_GET, .handler = fileHandler, .user_ctx = nullptr
 };
 
+/*
+ *	Private Static Variables
+ */
+// Mapped once at startup, afterwards only read by the httpd task
+static AssetArchive assetArchive;
+
 /*
  *	Private Static ISR
  */
-static std::string getMimeType(const std::string& filepath)
+static bool matchesEtag(httpd_req_t* p_reqst, const char* etag)
+{
+	char ifNoneMatch[ASSET_ETAG_LENGTH + 3] = {0x00};
+	if (httpd_req_get_hdr_value_str(p_reqst, "If-None-Match", ifNoneMatch, sizeof(ifNoneMatch)) != ESP_OK) {
+		return false;
+	}
+
+	return strcmp(ifNoneMatch, etag) == 0;
+}
+
+static std::string getMimeType(const std::string_view filepath)
 {
 	// Get file ending
 	const size_t pos = filepath.find_last_of(".");
@@ -42,7 +78,7 @@ static std::string getMimeType(const std::string& filepath)
 		return "text/plain";
 	}
 
-	const std::string lastDot = filepath.substr(pos + 1);
+	const std::string_view lastDot = filepath.substr(pos + 1);
 	if (lastDot == "html") {
 		return "text/html";
 	}
@@ -67,55 +103,50 @@ static std::string getMimeType(const std::string& filepath)
 
 static esp_err_t fileHandler(httpd_req_t* p_reqst)
 {
-	std::string filepath;
-
 	if (strcmp(p_reqst->uri, "") == 0) {
 		return ESP_ERR_INVALID_ARG;
 	}
 
-	// Return the specified file
-	if (strcmp(p_reqst->uri, "/") == 0) {
-		filepath = "webinterface/index.html";
-	}
-	else {
-		filepath = "webinterface";
-		filepath += p_reqst->uri;
+	// Without the leading slash and the query, which only holds the version of the asset
+	std::string_view path(p_reqst->uri + 1, strcspn(p_reqst->uri + 1, "?"));
+	if (path.empty()) {
+		path = "index.html";
 	}
 
-	// Then open the file as read only
-	FILE* reqFile = Filesystem::get()->openFile(filepath, "r", Filesystem::DATA_PARTITION);
-	if (reqFile == nullptr) {
-		esp_rom_printf("[%s] Couldn't open file: %s\n", TAG, filepath.c_str());
+	AssetArchive::Asset asset;
+	if (!assetArchive.find(path, asset)) {
+		httpd_resp_send_err(p_reqst, HTTPD_404_NOT_FOUND, nullptr);
 		return ESP_FAIL;
 	}
 
-	httpd_resp_set_type(p_reqst, getMimeType(filepath).c_str());
+	char etag[ASSET_ETAG_LENGTH + 3] = {0x00};
+	snprintf(etag, sizeof(etag), "\"%.*s\"", ASSET_ETAG_LENGTH, asset.etag.data());
 
-	/*
-	 * Send the file in chunks
-	 */
-	char chunk[FILE_CHUNK_SIZE_B] = {0x00};
-	ssize_t chunkSize;
-	do {
-		chunkSize = fread(chunk, 1, FILE_CHUNK_SIZE_B, reqFile);
+	// Only the versioned URLs the pages reference may be cached without asking again
+	char version[ASSET_ETAG_LENGTH + 1] = {0x00};
+	char query[ASSET_ETAG_LENGTH + 8] = {0x00};
+	const bool versioned = httpd_req_get_url_query_str(p_reqst, query, sizeof(query)) == ESP_OK &&
+	                       httpd_query_key_value(query, "v", version, sizeof(version)) == ESP_OK &&
+	                       asset.etag == version;
 
-		if (chunkSize <= 0) {
-			continue;
-		}
+	httpd_resp_set_hdr(p_reqst, "ETag", etag);
+	httpd_resp_set_hdr(p_reqst, "Cache-Control", versioned ? CACHE_CONTROL_VERSIONED : CACHE_CONTROL_REVALIDATE);
 
-		if (httpd_resp_send_chunk(p_reqst, chunk, chunkSize) != ESP_OK) {
-			fclose(reqFile);
-			return ESP_FAIL;
-		}
+	// The browser still has this content
+	if (matchesEtag(p_reqst, etag)) {
+		httpd_resp_set_status(p_reqst, "304 Not Modified");
+		return httpd_resp_send(p_reqst, nullptr, 0);
 	}
-	while (chunkSize != 0);
-
-	fclose(reqFile);
 
-	// Send one last empty chunk to signalize the end of the transmission
-	httpd_resp_send_chunk(p_reqst, nullptr, 0);
+	// Every browser accepts gzip, so there is no uncompressed fallback
+	const std::string mimeType = getMimeType(path);
+	httpd_resp_set_type(p_reqst, mimeType.c_str());
+	if (asset.gzip) {
+		httpd_resp_set_hdr(p_reqst, "Content-Encoding", "gzip");
+	}
 
-	return ESP_OK;
+	// Straight from the mapped flash in one go, the socket splits it as large as its buffers allow
+	return httpd_resp_send(p_reqst, reinterpret_cast<const char*>(asset.data), static_cast<ssize_t>(asset.size));
 }
 
 struct WsContext
@@ -179,6 +210,103 @@ static esp_err_t staticDisplayUpdateDownloadHandler(httpd_req_t* p_reqst)
 	return web->displayUpdateDownloadHandler(p_reqst);
 }
 
+static void writeBinaryUpdate(const std::vector<uint16_t>& sensors, const int64_t nowMs,
+                              WebsocketOutbox::Buffer& buffer)
+{
+	const EcuValueCache* cache = Core::get()->getEcuValueCache();
+	EcuValueCache::Value value;
+
+	// Fixed-point values and the age of every sample, a fraction of the JSON size and without formatting
+	SensorUpdateFrame frame(nowMs);
+	for (const uint16_t sensorId : sensors) {
+		const EcuSensor* sensor = getEcuSensor(sensorId);
+		if (sensor == nullptr || !cache->get(sensor->address, value)) {
+			continue;
+		}
+
+		frame.add(sensorId, value.timestampUs / 1000, sensor->convert(value.rawValue));
+	}
+
+	buffer.binary = true;
+	buffer.length = 0;
+	if (frame.getSampleCount() > 0) {
+		memcpy(buffer.data, frame.getData(), frame.getLength());
+		buffer.length = frame.getLength();
+	}
+}
+
+static void writeJsonUpdate(const std::vector<uint16_t>& sensors, const int64_t nowMs, WebsocketOutbox::Buffer& buffer)
+{
+	const EcuValueCache* cache = Core::get()->getEcuValueCache();
+	EcuValueCache::Value value;
+
+	auto* output = reinterpret_cast<char*>(buffer.data);
+	buffer.binary = false;
+	buffer.length = 0;
+
+	// JSON Header. The client places the samples on its own time axis using the current time of the board
+	size_t length = snprintf(output, WS_SEND_BUFFER_B, "{\"type\":\"update-sensors\",\"now\":%lld,\"sensors\":[",
+	                         static_cast<long long>(nowMs));
+
+	// Parse all sensors with a cached value to JSON
+	bool first = true;
+	for (const uint16_t sensorId : sensors) {
+		// All signals of one address are decoded from the same read
+		const EcuSensor* sensor = getEcuSensor(sensorId);
+		if (sensor == nullptr || !cache->get(sensor->address, value)) {
+			continue;
+		}
+
+		// Leaves room for the separator and the JSON ending
+		const size_t start = length + (first ? 0 : 1);
+		const int written = sensor->writeJson(output + start, WS_SEND_BUFFER_B - start - 2, value.rawValue,
+		                                      value.timestampUs / 1000);
+		if (written < 0 || start + written + 2 >= WS_SEND_BUFFER_B) {
+			ESP_LOGW(TAG, "Sensor update doesn't fit into a send buffer");
+			break;
+		}
+
+		if (!first) {
+			output[length] = ',';
+		}
+		first = false;
+		length = start + written;
+	}
+
+	// JSON Ending
+	output[length++] = ']';
+	output[length++] = '}';
+	buffer.length = length;
+}
+
+static std::string toHex(const uint8_t* data, const size_t length)
+{
+	constexpr auto DIGITS = "0123456789abcdef";
+
+	std::string hex;
+	hex.reserve(length * 2);
+	for (size_t i = 0; i < length; i++) {
+		hex += DIGITS[data[i] >> 4];
+		hex += DIGITS[data[i] & 0x0F];
+	}
+
+	return hex;
+}
+
+// Collects the due sensors per client, but only those with a new value since the last update of the client
+static void staticOnUpdateDue(UpdateWheel::Item& item, void* ctx)
+{
+	const EcuSensor* sensor = getEcuSensor(item.sensorId);
+	EcuValueCache::Value value;
+	if (sensor == nullptr || !Core::get()->getEcuValueCache()->get(sensor->address, value) ||
+	    value.timestampUs <= item.lastTimestampUs) {
+		return;
+	}
+	item.lastTimestampUs = value.timestampUs;
+
+	(*static_cast<std::map<int, std::vector<uint16_t>>*>(ctx))[item.client].push_back(item.sensorId);
+}
+
 static void updateSensorsTask(void* param)
 {
 	if (param == nullptr) {
@@ -189,43 +317,63 @@ static void updateSensorsTask(void* param)
 	WebInterface* web = static_cast<WebInterface*>(param);
 	auto mutex = web->getSensorsMutex();
 
+	// Clients with the same protocol and the same set of sensors get the same message
+	typedef std::pair<WebInterface::PROTOCOL, std::vector<uint16_t>> SubscriptionSet;
+	std::map<SubscriptionSet, std::vector<int>> clientsBySet;
+	std::map<int, std::vector<uint16_t>> dueSensors;
+
+	TickType_t lastWakeTime = xTaskGetTickCount();
+
 	while (true) {
+		vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(UPDATE_WHEEL_TICK_MS));
+
 		xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
-		auto trackedSensorsMap = web->getTrackedSensors();
-		for (auto& fdPair : trackedSensorsMap) {
-			auto& trackedSensorsVector = fdPair.second;
+		// The task is never deleted from outside, it could hold a pooled buffer or the outbox mutex then. Without
+		// tracked sensors it sleeps until the next one is added
+		if (web->getTrackedSensors().empty()) {
+			xSemaphoreGiveRecursive(mutex);
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			lastWakeTime = xTaskGetTickCount();
+			continue;
+		}
 
-			for (auto& sensor : trackedSensorsVector) {
-				web->getKLine()->readPid(sensor);
-			}
+		// Every subscription has its own rate, the due ones of a client are merged into one update
+		dueSensors.clear();
+		web->getUpdateWheel().tick(staticOnUpdateDue, &dueSensors);
 
-			// JSON Header
-			std::stringstream output;
-			output << "{";
-			output << "\"type\":\"update-sensors\",";
-			output << "\"sensors\":" << "[";
+		clientsBySet.clear();
+		for (auto& [clientFD, sensors] : dueSensors) {
+			// The order of the samples doesn't matter to the client
+			std::ranges::sort(sensors);
+			clientsBySet[{web->getProtocol(clientFD), std::move(sensors)}].push_back(clientFD);
+		}
 
-			// Parse all sensors to JSON
-			for (auto& sensorId : trackedSensorsVector) {
-				output << ECU_SENSORS[sensorId].toJson();
+		xSemaphoreGiveRecursive(mutex);
 
-				// Add ',' if it's not the last sensor we add
-				if (sensorId != trackedSensorsVector.at(trackedSensorsVector.size() - 1)) {
-					output << ",";
-				}
+		// Serialized once per distinct set into a pooled buffer, the clients share it
+		const int64_t nowMs = esp_timer_get_time() / 1000;
+		for (const auto& [set, clients] : clientsBySet) {
+			WebsocketOutbox::Buffer* buffer = web->getOutbox().acquire();
+			if (buffer == nullptr) {
+				// The clients get the values with their next update
+				break;
 			}
 
-			// JSON Ending
-			output << "]";
-			output << "}";
-
-			web->send(fdPair.first, output.str());
-		}
+			if (set.first == WebInterface::PROTOCOL_BINARY) {
+				writeBinaryUpdate(set.second, nowMs, *buffer);
+			}
+			else {
+				writeJsonUpdate(set.second, nowMs, *buffer);
+			}
 
-		xSemaphoreGiveRecursive(mutex);
+			if (buffer->length == 0) {
+				web->getOutbox().release(buffer);
+				continue;
+			}
 
-		vTaskDelay(pdMS_TO_TICKS(500));
+			web->getOutbox().enqueue(clients, buffer);
+		}
 	}
 }
 
@@ -234,7 +382,11 @@ static void updateSensorsTask(void* param)
  */
 WebInterface::WebInterface()
 {
-	sensorsMutex_ = xSemaphoreCreateMutex();
+	sensorsMutex_ = xSemaphoreCreateRecursiveMutex();
+
+	if (!assetArchive.map()) {
+		ESP_LOGE(TAG, "No web assets, the web interface won't be served");
+	}
 
 	httpdConfig_ = HTTPD_DEFAULT_CONFIG();
 	httpdConfig_.uri_match_fn = httpd_uri_match_wildcard;
@@ -246,6 +398,10 @@ WebInterface::WebInterface()
 		return;
 	}
 
+	if (!outbox_.init(httpdHandle_)) {
+		return;
+	}
+
 	/*
 	 *	Setup URI's
 	 */
@@ -291,10 +447,8 @@ WebInterface::WebInterface()
 		return;
 	}
 
-	/*
-	 *	Read ECU ID
-	 */
-	kline_.readEcuId();
+	// The polled values are read from the cache
+	ecuPollScheduler_ = Core::get()->getEcuPollScheduler();
 
 	ESP_LOGI(TAG, "Initialized");
 	initialized_ = true;
@@ -318,6 +472,12 @@ void WebInterface::send(const int clientFD, const std::string& data) const
 	httpd_ws_send_frame_async(httpdHandle_, clientFD, &frame);
 }
 
+WebInterface::PROTOCOL WebInterface::getProtocol(const int clientFD) const
+{
+	const auto it = protocols_.find(clientFD);
+	return it != protocols_.end() ? it->second : PROTOCOL_JSON;
+}
+
 std::unordered_map<int, std::vector<uint16_t>>& WebInterface::getTrackedSensors()
 {
 	return trackedSensors_;
@@ -328,9 +488,20 @@ SemaphoreHandle_t& WebInterface::getSensorsMutex()
 	return sensorsMutex_;
 }
 
-KLine* WebInterface::getKLine()
+int8_t WebInterface::getPollSubscriber(const int clientFD) const
+{
+	const auto it = pollSubscribers_.find(clientFD);
+	return it != pollSubscribers_.end() ? it->second : -1;
+}
+
+UpdateWheel& WebInterface::getUpdateWheel()
 {
-	return &kline_;
+	return updateWheel_;
+}
+
+WebsocketOutbox& WebInterface::getOutbox()
+{
+	return outbox_;
 }
 
 /*
@@ -364,14 +535,86 @@ esp_err_t WebInterface::websocketHandler(httpd_req_t* p_reqst)
 		return ESP_OK;
 	}
 
+	// Clients that don't ask keep getting JSON
+	if (dataStr.starts_with(PROTOCOL_PREFIX)) {
+		const PROTOCOL protocol = dataStr == "protocol:binary" ? PROTOCOL_BINARY : PROTOCOL_JSON;
+
+		xSemaphoreTakeRecursive(sensorsMutex_, portMAX_DELAY);
+		protocols_[clientFD] = protocol;
+		xSemaphoreGiveRecursive(sensorsMutex_);
+
+		send(clientFD, std::string("{\"type\":\"protocol\",\"protocol\":\"") +
+		               (protocol == PROTOCOL_BINARY ? "binary" : "json") + "\"}");
+		return ESP_OK;
+	}
+
+	if (dataStr == "fetch-ws-metrics") {
+		send(clientFD, "{\"type\":\"ws-metrics\",\"metrics\":" + outbox_.toJson(esp_timer_get_time()) + "}");
+		return ESP_OK;
+	}
+
+	if (dataStr == "fetch-kline-metrics") {
+		send(clientFD, "{\"type\":\"kline-metrics\",\"metrics\":" + Core::get()->getKLine()->getMetricsJson() + "}");
+		return ESP_OK;
+	}
+
+	// The refresh only queues the read, the page polls until it's done
+	if (dataStr == "fetch-dtcs" || dataStr == "refresh-dtcs") {
+		EcuDtcReader* dtcReader = Core::get()->getEcuDtcReader();
+		if (dataStr == "refresh-dtcs") {
+			dtcReader->refresh();
+		}
+
+		send(clientFD, "{\"type\":\"dtcs\",\"dtcs\":" + dtcReader->toJson() + "}");
+		return ESP_OK;
+	}
+
+	// "add-sensor:<id>" or "add-sensor:<id>:<rate in Hz>", adding a tracked sensor again changes its rate
 	if (dataStr.contains("add-sensor")) {
-		const std::string sensorId = dataStr.substr(dataStr.find(':') + 1);
+		const size_t idStart = dataStr.find(':') + 1;
+		const size_t rateStart = dataStr.find(':', idStart);
+
+		const uint16_t signal = std::stoi(dataStr.substr(idStart, rateStart - idStart));
+		const EcuSensor* sensor = getEcuSensor(signal);
+		if (sensor == nullptr) {
+			ESP_LOGW(TAG, "Unknown sensor %d", signal);
+			return ESP_OK;
+		}
+
+		float rateHz = DEFAULT_UPDATE_RATE_HZ;
+		if (rateStart != std::string::npos) {
+			rateHz = std::clamp(std::strtof(dataStr.c_str() + rateStart + 1, nullptr), MIN_UPDATE_RATE_HZ,
+			                    MAX_UPDATE_RATE_HZ);
+		}
 
 		xSemaphoreTakeRecursive(sensorsMutex_, portMAX_DELAY);
-		trackedSensors_[clientFD].push_back(std::stoi(sensorId));
+
+		// Every client is one subscriber, the scheduler merges the addresses of all clients
+		if (!pollSubscribers_.contains(clientFD)) {
+			const int8_t subscriber = ecuPollScheduler_->addSubscriber();
+			if (subscriber < 0) {
+				xSemaphoreGiveRecursive(sensorsMutex_);
+
+				ESP_LOGW(TAG, "No poll subscriber left for client %d", clientFD);
+				send(clientFD, "{\"type\":\"error\",\"message\":\"Too many clients track sensors\"}");
+				return ESP_OK;
+			}
+
+			pollSubscribers_[clientFD] = subscriber;
+		}
+
+		std::vector<uint16_t>& sensors = trackedSensors_[clientFD];
+		if (std::ranges::find(sensors, signal) == sensors.end()) {
+			sensors.push_back(signal);
+		}
+
+		// The cached value is sent with the next tick
+		updateWheel_.add(clientFD, signal, static_cast<uint32_t>(1000.0f / rateHz));
+		resubscribe(clientFD, sensor->address);
 		xSemaphoreGiveRecursive(sensorsMutex_);
 
 		if (updateSensorsDataTask_ != nullptr) {
+			xTaskNotifyGive(updateSensorsDataTask_);
 			return ESP_OK;
 		}
 
@@ -394,37 +637,15 @@ esp_err_t WebInterface::websocketHandler(httpd_req_t* p_reqst)
 			if (sensorVector.at(i) == sensorId) {
 				xSemaphoreTakeRecursive(sensorsMutex_, portMAX_DELAY);
 				sensorVector.erase(sensorVector.begin() + i);
+				updateWheel_.remove(clientFD, sensorId);
+
+				// The address is still needed if another tracked signal is decoded from it
+				resubscribe(clientFD, ECU_SENSORS[sensorId].address);
 				xSemaphoreGiveRecursive(sensorsMutex_);
 				break;
 			}
 		}
 
-		if (trackedSensors_.empty()) {
-			if (updateSensorsDataTask_ == nullptr) {
-				return ESP_OK;
-			}
-
-			vTaskDelete(updateSensorsDataTask_);
-			updateSensorsDataTask_ = nullptr;
-		}
-
-		return ESP_OK;
-	}
-
-	if (dataStr.contains("prepare-display-update")) {
-		auto filesystem = Filesystem::get();
-
-		// Create file if necessary
-		if (!filesystem->doesFileExist("display_update.bin", Filesystem::Location::SD_CARD)) {
-			filesystem->createFile("display_update.bin", Filesystem::Location::SD_CARD);
-		}
-
-		if (displayUpdateFile_ != nullptr) {
-			fclose(displayUpdateFile_);
-		}
-
-		displayUpdateFile_ = filesystem->openFile("display_update.bin", "wb+", Filesystem::Location::SD_CARD);
-
 		return ESP_OK;
 	}
 
@@ -433,8 +654,27 @@ esp_err_t WebInterface::websocketHandler(httpd_req_t* p_reqst)
 
 esp_err_t WebInterface::displayUpdateUploadHandler(httpd_req_t* p_reqst)
 {
-	if (displayUpdateFile_ == nullptr) {
+	// The update is only accepted with the checksum the page computed. It's passed in the query, as a header it would
+	// count against the small header limit of the httpd
+	char expectedHex[UPLOAD_SHA256_LENGTH * 2 + 1] = {0x00};
+	char query[UPLOAD_SHA256_LENGTH * 2 + 16] = {0x00};
+	if (httpd_req_get_url_query_str(p_reqst, query, sizeof(query)) != ESP_OK ||
+	    httpd_query_key_value(query, "sha256", expectedHex, sizeof(expectedHex)) != ESP_OK ||
+	    strlen(expectedHex) != UPLOAD_SHA256_LENGTH * 2) {
+		httpd_resp_send_err(p_reqst, HTTPD_400_BAD_REQUEST, "Missing sha256 query parameter");
+		return ESP_FAIL;
+	}
+
+	// Only opened here, the file is never truncated outside of an upload
+	const auto filesystem = Filesystem::get();
+	if (!filesystem->doesFileExist("display_update.bin", Filesystem::Location::SD_CARD)) {
+		filesystem->createFile("display_update.bin", Filesystem::Location::SD_CARD);
+	}
+
+	FILE* updateFile = filesystem->openFile("display_update.bin", "wb+", Filesystem::Location::SD_CARD);
+	if (updateFile == nullptr) {
 		ESP_LOGE(TAG, "Can't download the display update file. The destination file is a nullptr!");
+		httpd_resp_send_err(p_reqst, HTTPD_500_INTERNAL_SERVER_ERROR, "Can't open the display update file");
 		return ESP_FAIL;
 	}
 
@@ -442,41 +682,43 @@ esp_err_t WebInterface::displayUpdateUploadHandler(httpd_req_t* p_reqst)
 
 	/*
 	 *	Download file
-	*/
-	size_t remaining = p_reqst->content_len;
-	int received = 0;
-	char buf[1024];
-
-	while (remaining > 0) {
-		// Read file chunk
-		received = httpd_req_recv(p_reqst, buf, MIN(remaining, sizeof(buf)));
-
-		if (received <= 0) {
-			// Retry on timeout
-			if (received == HTTPD_SOCK_ERR_TIMEOUT) {
-				continue;
-			}
+	 */
+	UploadPipeline pipeline;
+	UploadPipeline::Result result;
+	const bool received = pipeline.run(p_reqst, updateFile, result);
 
-			// Fault
-			return ESP_FAIL;
-		}
+	fclose(updateFile);
+	updateFile = nullptr;
 
-		// Write into the file on the filesystem
-		if (fwrite(buf, 1, received, displayUpdateFile_) != received) {
-			ESP_LOGE(TAG, "Failed writing into display update file!");
+	const std::string sha256 = toHex(result.sha256.data(), result.sha256.size());
+	if (!received || strcasecmp(sha256.c_str(), expectedHex) != 0) {
+		ESP_LOGE(TAG, "Upload of display update file failed after %u bytes", static_cast<unsigned>(result.bytes));
 
-			fclose(displayUpdateFile_);
-			return ESP_FAIL;
-		}
+		// A partial or corrupt update must never reach the display
+		filesystem->deleteFile("display_update.bin", Filesystem::Location::SD_CARD);
 
-		remaining -= received;
+		httpd_resp_send_err(p_reqst, received ? HTTPD_400_BAD_REQUEST : HTTPD_500_INTERNAL_SERVER_ERROR,
+		                    received ? "Checksum mismatch" : "Upload failed");
+		return ESP_FAIL;
 	}
 
-	// Close the file
-	fclose(displayUpdateFile_);
-	displayUpdateFile_ = nullptr;
+	const float throughputKBps = result.durationUs == 0 ? 0.0f
+	                                                    : static_cast<float>(result.bytes) * 1000000.0f /
+	                                                      static_cast<float>(result.durationUs) / 1024.0f;
+	ESP_LOGI(TAG, "Upload of display update file successful! %u bytes with %.1f KB/s",
+	         static_cast<unsigned>(result.bytes), throughputKBps);
 
-	ESP_LOGI(TAG, "Upload of display update file successful!");
+	std::stringstream output;
+	output << "{";
+	output << "\"bytes\":" << result.bytes << ",";
+	output << "\"durationMs\":" << result.durationUs / 1000 << ",";
+	output << "\"throughputKBps\":" << throughputKBps << ",";
+	output << "\"writerWaitMs\":" << result.writerWaitUs / 1000 << ",";
+	output << "\"sha256\":\"" << sha256 << "\"";
+	output << "}";
+
+	httpd_resp_set_type(p_reqst, "application/json");
+	httpd_resp_sendstr(p_reqst, output.str().c_str());
 
 	/*
 	 *	Notify backend that the update is ready
@@ -533,22 +775,25 @@ esp_err_t WebInterface::displayUpdateDownloadHandler(httpd_req_t* p_reqst)
 
 void WebInterface::websocketCrashed(const int fd)
 {
+	outbox_.removeClient(fd);
+
+	xSemaphoreTakeRecursive(sensorsMutex_, portMAX_DELAY);
+	protocols_.erase(fd);
+	xSemaphoreGiveRecursive(sensorsMutex_);
+
 	if (!trackedSensors_.contains(fd)) {
 		return;
 	}
 
+	xSemaphoreTakeRecursive(sensorsMutex_, portMAX_DELAY);
 	trackedSensors_.erase(fd);
+	updateWheel_.removeClient(fd);
 
-	if (!trackedSensors_.empty()) {
-		return;
+	if (pollSubscribers_.contains(fd)) {
+		ecuPollScheduler_->removeSubscriber(pollSubscribers_[fd]);
+		pollSubscribers_.erase(fd);
 	}
-
-	if (updateSensorsDataTask_ == nullptr) {
-		return;
-	}
-
-	vTaskDelete(updateSensorsDataTask_);
-	updateSensorsDataTask_ = nullptr;
+	xSemaphoreGiveRecursive(sensorsMutex_);
 }
 
 /*
@@ -562,12 +807,12 @@ void WebInterface::sendAllSensors(const int clientFD) const
 	output << "\"sensors\":" << "[";
 
 	// Parse all sensors to JSON
-	for (auto it = ECU_SENSORS.begin(); it != ECU_SENSORS.end(); ++it) {
-		output << it->second.toJson();
-
-		if (std::next(it) != ECU_SENSORS.end()) {
+	for (const EcuSensor& sensor : ECU_SENSORS) {
+		if (&sensor != ECU_SENSORS) {
 			output << ",";
 		}
+
+		output << sensor.toJson();
 	}
 
 	output << "]";
@@ -575,3 +820,25 @@ void WebInterface::sendAllSensors(const int clientFD) const
 
 	send(clientFD, output.str());
 }
+
+void WebInterface::resubscribe(const int clientFD, const uint16_t address)
+{
+	const int8_t subscriber = getPollSubscriber(clientFD);
+	if (subscriber < 0) {
+		return;
+	}
+
+	uint32_t periodMs = UINT32_MAX;
+	for (const uint16_t signal : trackedSensors_[clientFD]) {
+		if (ECU_SENSORS[signal].address == address) {
+			periodMs = std::min(periodMs, updateWheel_.getPeriodMs(clientFD, signal));
+		}
+	}
+
+	if (periodMs == UINT32_MAX) {
+		ecuPollScheduler_->unsubscribe(subscriber, address);
+	}
+	else {
+		ecuPollScheduler_->subscribe(subscriber, address, periodMs);
+	}
+}
@@ -0,0 +1,423 @@
+#include "WebInterface/WebsocketOutbox.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+
+// espidf includes
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sys/socket.h"
+
+/*
+ *	constexpr
+ */
+constexpr auto TAG = "WebsocketOutbox";
+
+/*
+ *	Private Variables
+ */
+// The send function of the httpd has no context
+static WebsocketOutbox* outbox = nullptr;
+
+/*
+ *	Private Static Functions
+ */
+static void staticDrain(void* arg)
+{
+	static_cast<WebsocketOutbox*>(arg)->drain();
+}
+
+static void staticCheck(void* arg)
+{
+	static_cast<WebsocketOutbox*>(arg)->check();
+}
+
+/*
+ *	Public Function Implementations
+ */
+WebsocketOutbox::~WebsocketOutbox()
+{
+	if (checkTimer_ != nullptr) {
+		esp_timer_stop(checkTimer_);
+		esp_timer_delete(checkTimer_);
+	}
+
+	if (outbox == this) {
+		outbox = nullptr;
+	}
+
+	heap_caps_free(memory_);
+
+	if (mutex_ != nullptr) {
+		vSemaphoreDelete(mutex_);
+	}
+}
+
+bool WebsocketOutbox::init(const httpd_handle_t httpdHandle)
+{
+	constexpr size_t POOL_SIZE = WS_SEND_BUFFER_B * WS_SEND_BUFFER_COUNT;
+
+	memory_ = static_cast<uint8_t*>(heap_caps_malloc(POOL_SIZE, MALLOC_CAP_SPIRAM));
+	if (memory_ == nullptr) {
+		memory_ = static_cast<uint8_t*>(heap_caps_malloc(POOL_SIZE, MALLOC_CAP_8BIT));
+	}
+
+	mutex_ = xSemaphoreCreateMutex();
+	if (memory_ == nullptr || mutex_ == nullptr) {
+		ESP_LOGE(TAG, "Failed to allocate the send buffers");
+		return false;
+	}
+
+	for (uint8_t i = 0; i < WS_SEND_BUFFER_COUNT; i++) {
+		buffers_[i] = {.data = memory_ + i * WS_SEND_BUFFER_B, .length = 0, .binary = false, .references = 0};
+	}
+	freeBuffers_ = WS_SEND_BUFFER_COUNT;
+	httpdHandle_ = httpdHandle;
+	outbox = this;
+
+	const esp_timer_create_args_t timerArgs = {.callback = staticCheck, .arg = this, .name = "wsOutboxCheck"};
+	if (esp_timer_create(&timerArgs, &checkTimer_) != ESP_OK ||
+	    esp_timer_start_periodic(checkTimer_, WS_CHECK_PERIOD_US) != ESP_OK) {
+		ESP_LOGE(TAG, "Failed to start the check timer, stalled clients are only closed on updates");
+	}
+
+	return true;
+}
+
+WebsocketOutbox::Buffer* WebsocketOutbox::acquire()
+{
+	if (mutex_ == nullptr) {
+		return nullptr;
+	}
+
+	Buffer* buffer = nullptr;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (Buffer& candidate : buffers_) {
+		if (candidate.references == 0) {
+			// Held by the caller until it's queued
+			candidate.references = 1;
+			candidate.length = 0;
+			freeBuffers_--;
+			buffer = &candidate;
+			break;
+		}
+	}
+
+	if (buffer == nullptr) {
+		poolExhausted_++;
+	}
+	xSemaphoreGive(mutex_);
+
+	return buffer;
+}
+
+void WebsocketOutbox::release(Buffer* buffer)
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	unreference(buffer);
+	xSemaphoreGive(mutex_);
+}
+
+void WebsocketOutbox::enqueue(const std::vector<int>& clientFDs, Buffer* buffer)
+{
+	const int64_t nowUs = esp_timer_get_time();
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+
+	for (const int clientFD : clientFDs) {
+		Client* client = findClient(clientFD, true);
+		if (client == nullptr) {
+			ESP_LOGW(TAG, "No slot left for client %d", clientFD);
+			continue;
+		}
+
+		// Telemetry is only worth its latest value
+		if (client->count == WS_CLIENT_QUEUE_DEPTH) {
+			unreference(client->queue[client->head].buffer);
+			client->head = (client->head + 1) % WS_CLIENT_QUEUE_DEPTH;
+			client->count--;
+			client->metrics.dropped++;
+		}
+
+		client->queue[(client->head + client->count) % WS_CLIENT_QUEUE_DEPTH] = {.buffer = buffer, .queuedUs = nowUs};
+		client->count++;
+		buffer->references++;
+	}
+
+	// Drops the reference of the caller
+	unreference(buffer);
+
+	xSemaphoreGive(mutex_);
+
+	queueDrain();
+}
+
+void WebsocketOutbox::removeClient(const int clientFD)
+{
+	if (mutex_ == nullptr) {
+		return;
+	}
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+
+	Client* client = findClient(clientFD, false);
+	if (client != nullptr) {
+		for (uint8_t i = 0; i < client->count; i++) {
+			unreference(client->queue[(client->head + i) % WS_CLIENT_QUEUE_DEPTH].buffer);
+		}
+
+		*client = {};
+	}
+
+	xSemaphoreGive(mutex_);
+}
+
+std::string WebsocketOutbox::toJson(const int64_t nowUs) const
+{
+	std::stringstream output;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+
+	output << "{";
+	output << "\"freeBuffers\":" << static_cast<int>(freeBuffers_) << ",";
+	output << "\"poolExhausted\":" << poolExhausted_ << ",";
+	output << "\"clients\":[";
+
+	bool first = true;
+	for (const Client& client : clients_) {
+		if (client.fd < 0) {
+			continue;
+		}
+
+		const ClientMetrics& metrics = client.metrics;
+		output << (first ? "" : ",") << "{";
+		output << "\"fd\":" << client.fd << ",";
+		output << "\"queued\":" << static_cast<int>(client.count) << ",";
+		output << "\"pendingB\":" << client.pending.size() << ",";
+		output << "\"sent\":" << metrics.sent << ",";
+		output << "\"dropped\":" << metrics.dropped << ",";
+		output << "\"failed\":" << metrics.failed << ",";
+		output << "\"lagUs\":" << metrics.lastLagUs << ",";
+		output << "\"maxLagUs\":" << metrics.maxLagUs << ",";
+		output << "\"stalledMs\":" << (metrics.stalledSinceUs < 0 ? 0 : (nowUs - metrics.stalledSinceUs) / 1000);
+		output << "}";
+		first = false;
+	}
+
+	output << "]";
+	output << "}";
+
+	xSemaphoreGive(mutex_);
+
+	return output.str();
+}
+
+void WebsocketOutbox::drain()
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	drainQueued_ = false;
+	xSemaphoreGive(mutex_);
+
+	for (Client& client : clients_) {
+		while (true) {
+			xSemaphoreTake(mutex_, portMAX_DELAY);
+
+			const int clientFD = client.fd;
+			if (clientFD < 0) {
+				xSemaphoreGive(mutex_);
+				break;
+			}
+
+			// Whatever is left is sent by the next drain
+			const int64_t nowUs = esp_timer_get_time();
+			if (!flushPending(client, nowUs)) {
+				const bool stalled = nowUs - client.metrics.stalledSinceUs > WS_STALL_TIMEOUT_US;
+				xSemaphoreGive(mutex_);
+
+				if (stalled) {
+					ESP_LOGW(TAG, "Closing stalled client %d", clientFD);
+					httpd_sess_trigger_close(httpdHandle_, clientFD);
+				}
+				break;
+			}
+
+			if (client.count == 0) {
+				xSemaphoreGive(mutex_);
+				break;
+			}
+
+			if (!client.sendOverridden) {
+				client.sendOverridden = httpd_sess_set_send_override(httpdHandle_, clientFD, staticSend) == ESP_OK;
+			}
+
+			// The queue holds its reference until the frame is sent, so the mutex isn't held while sending
+			const Entry entry = client.queue[client.head];
+			client.head = (client.head + 1) % WS_CLIENT_QUEUE_DEPTH;
+			client.count--;
+			xSemaphoreGive(mutex_);
+
+			// Doesn't block, what the socket doesn't take becomes pending and is sent first by the next round
+			httpd_ws_frame_t frame = {};
+			frame.payload = entry.buffer->data;
+			frame.len = entry.buffer->length;
+			frame.type = entry.buffer->binary ? HTTPD_WS_TYPE_BINARY : HTTPD_WS_TYPE_TEXT;
+			frame.final = true;
+			const esp_err_t result = httpd_ws_send_frame_async(httpdHandle_, clientFD, &frame);
+
+			const auto lagUs = static_cast<uint32_t>(esp_timer_get_time() - entry.queuedUs);
+
+			xSemaphoreTake(mutex_, portMAX_DELAY);
+			unreference(entry.buffer);
+
+			// The client might have been removed meanwhile
+			if (client.fd == clientFD) {
+				if (result == ESP_OK) {
+					client.metrics.sent++;
+					client.metrics.lastLagUs = lagUs;
+					client.metrics.maxLagUs = std::max(client.metrics.maxLagUs, lagUs);
+				}
+				else {
+					client.metrics.failed++;
+				}
+			}
+			xSemaphoreGive(mutex_);
+		}
+	}
+}
+
+void WebsocketOutbox::check()
+{
+	bool waiting = false;
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (const Client& client : clients_) {
+		waiting = waiting || (client.fd >= 0 && (client.count > 0 || !client.pending.empty()));
+	}
+	xSemaphoreGive(mutex_);
+
+	// The drain sends the leftovers and closes the stalled clients
+	if (waiting) {
+		queueDrain();
+	}
+}
+
+/*
+ *	Private Function Implementations
+ */
+WebsocketOutbox::Client* WebsocketOutbox::findClient(const int clientFD, const bool add)
+{
+	Client* freeSlot = nullptr;
+	for (Client& client : clients_) {
+		if (client.fd == clientFD) {
+			return &client;
+		}
+
+		if (client.fd < 0 && freeSlot == nullptr) {
+			freeSlot = &client;
+		}
+	}
+
+	if (!add || freeSlot == nullptr) {
+		return nullptr;
+	}
+
+	*freeSlot = {};
+	freeSlot->fd = clientFD;
+	return freeSlot;
+}
+
+void WebsocketOutbox::unreference(Buffer* buffer)
+{
+	if (buffer == nullptr || buffer->references == 0) {
+		return;
+	}
+
+	buffer->references--;
+	if (buffer->references == 0) {
+		freeBuffers_++;
+	}
+}
+
+void WebsocketOutbox::queueDrain()
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	const bool queue = !drainQueued_;
+	drainQueued_ = true;
+	xSemaphoreGive(mutex_);
+
+	if (queue && httpd_queue_work(httpdHandle_, staticDrain, this) != ESP_OK) {
+		xSemaphoreTake(mutex_, portMAX_DELAY);
+		drainQueued_ = false;
+		xSemaphoreGive(mutex_);
+	}
+}
+
+bool WebsocketOutbox::flushPending(Client& client, const int64_t nowUs)
+{
+	if (!client.pending.empty()) {
+		const ssize_t sent = ::send(client.fd, client.pending.data(), client.pending.size(), MSG_DONTWAIT);
+		if (sent > 0) {
+			client.pending.erase(client.pending.begin(), client.pending.begin() + sent);
+			client.metrics.stalledSinceUs = -1;
+		}
+	}
+
+	if (client.pending.empty()) {
+		client.metrics.stalledSinceUs = -1;
+		return true;
+	}
+
+	if (client.metrics.stalledSinceUs < 0) {
+		client.metrics.stalledSinceUs = nowUs;
+	}
+	return false;
+}
+
+int WebsocketOutbox::sendWithoutBlocking(const int clientFD, const char* data, const size_t length)
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+
+	Client* client = findClient(clientFD, false);
+	if (client == nullptr) {
+		xSemaphoreGive(mutex_);
+		return ::send(clientFD, data, length, 0) < 0 ? HTTPD_SOCK_ERR_FAIL : static_cast<int>(length);
+	}
+
+	// Nothing may overtake the pending bytes
+	size_t sent = 0;
+	if (client->pending.empty()) {
+		const ssize_t result = ::send(clientFD, data, length, MSG_DONTWAIT);
+		if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+			xSemaphoreGive(mutex_);
+			return HTTPD_SOCK_ERR_FAIL;
+		}
+		sent = std::max<ssize_t>(result, 0);
+	}
+
+	const bool overflow = client->pending.size() + length - sent > WS_MAX_PENDING_B;
+	if (!overflow) {
+		client->pending.insert(client->pending.end(), data + sent, data + length);
+	}
+	xSemaphoreGive(mutex_);
+
+	// Part of a frame might be out already, so the stream can't continue without the rest
+	if (overflow) {
+		ESP_LOGW(TAG, "Closing client %d, its socket takes nothing", clientFD);
+		httpd_sess_trigger_close(httpdHandle_, clientFD);
+		return HTTPD_SOCK_ERR_FAIL;
+	}
+
+	return static_cast<int>(length);
+}
+
+int WebsocketOutbox::staticSend(httpd_handle_t, const int clientFD, const char* data, const size_t length, int)
+{
+	if (outbox == nullptr) {
+		return HTTPD_SOCK_ERR_FAIL;
+	}
+
+	return outbox->sendWithoutBlocking(clientFD, data, length);
+}
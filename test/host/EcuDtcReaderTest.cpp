@@ -0,0 +1,206 @@
+#include "Driver/EcuDtcReader.hpp"
+
+// Project includes
+#include "EcuEmulatorProcess.hpp"
+#include "HostUart.hpp"
+
+// C++ includes
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// Libraries
+#include <gtest/gtest.h>
+
+/*
+ *	constexpr
+ */
+// The first and each following frame of the emulator hold 3 codes
+constexpr uint8_t DTCS_PER_FRAME = 3;
+
+// The emulator stores all codes with this status
+constexpr uint8_t DTC_STATUS_STORED = 0x20;
+
+constexpr auto REFRESH_TIMEOUT = std::chrono::seconds(3);
+
+/*
+ *	Helpers
+ */
+// The emulator answers on its own pseudo-terminal as long as this lives
+class EmulatedEcu
+{
+public:
+	explicit EmulatedEcu(const std::vector<std::string>& args)
+	{
+		device_ = startEcuEmulator(ECU_EMULATOR_PATH, args, pid_);
+		if (!device_.empty()) {
+			hostUartAttach(UART_NUM_2, device_.c_str());
+		}
+	}
+
+	~EmulatedEcu()
+	{
+		if (!device_.empty()) {
+			stopEcuEmulator(pid_);
+		}
+	}
+
+	bool isRunning() const
+	{
+		return !device_.empty();
+	}
+
+private:
+	std::string device_;
+	pid_t pid_ = 0;
+};
+
+// Like in the Core the driver lives until the end and all tests share it, an EmulatedEcu has to be running first
+static EcuDtcReader& reader()
+{
+	static EcuDtcReader* reader = [] {
+		KLine::Timing timing;
+		timing.fastInit = false;
+
+		auto* kline = new KLine(timing);
+		return new EcuDtcReader(new EcuPollScheduler(kline));
+	}();
+
+	return *reader;
+}
+
+static bool refreshAndWait()
+{
+	if (!reader().refresh()) {
+		return false;
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + REFRESH_TIMEOUT;
+	while (reader().isRefreshing()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return true;
+}
+
+static std::vector<std::string> readCodes()
+{
+	EcuDtc dtcs[MAX_ECU_DTCS];
+	int64_t readUs = 0;
+	const uint8_t count = reader().getDtcs(dtcs, MAX_ECU_DTCS, readUs);
+
+	std::vector<std::string> codes;
+	for (uint8_t i = 0; i < count; i++) {
+		char code[ECU_DTC_STRING_LENGTH];
+		EcuDtcReader::formatCode(dtcs[i].code, code);
+		codes.emplace_back(code);
+		EXPECT_EQ(dtcs[i].status, DTC_STATUS_STORED) << code;
+	}
+
+	return codes;
+}
+
+// P0001, P0002, ...
+static std::vector<std::string> makeCodes(const uint8_t count)
+{
+	std::vector<std::string> codes;
+	for (uint8_t i = 1; i <= count; i++) {
+		char code[ECU_DTC_STRING_LENGTH];
+		EcuDtcReader::formatCode(i, code);
+		codes.emplace_back(code);
+	}
+
+	return codes;
+}
+
+static std::string joinCodes(const std::vector<std::string>& codes)
+{
+	std::string list;
+	for (const std::string& code : codes) {
+		list += (list.empty() ? "" : ",") + code;
+	}
+
+	return list;
+}
+
+/*
+ *	Tests
+ */
+TEST(EcuDtcReader, FormatsCodes)
+{
+	char code[ECU_DTC_STRING_LENGTH];
+
+	EcuDtcReader::formatCode(0x0130, code);
+	EXPECT_STREQ(code, "P0130");
+	EcuDtcReader::formatCode(0x4123, code);
+	EXPECT_STREQ(code, "C0123");
+	EcuDtcReader::formatCode(0x8000, code);
+	EXPECT_STREQ(code, "B0000");
+	EcuDtcReader::formatCode(0xFFFF, code);
+	EXPECT_STREQ(code, "U3FFF");
+}
+
+TEST(EcuDtcReader, ReadsCodesFromOneFrame)
+{
+	const EmulatedEcu ecu({"--dtcs", "P0130,C0171,U0420"});
+	ASSERT_TRUE(ecu.isRunning());
+
+	ASSERT_TRUE(refreshAndWait());
+	EXPECT_EQ(readCodes(), std::vector<std::string>({"P0130", "C0171", "U0420"}));
+	EXPECT_NE(reader().toJson().find("\"failed\":false,"), std::string::npos);
+}
+
+TEST(EcuDtcReader, ReadsNoCodes)
+{
+	const EmulatedEcu ecu({"--dtcs", "none"});
+	ASSERT_TRUE(ecu.isRunning());
+
+	ASSERT_TRUE(refreshAndWait());
+	EXPECT_TRUE(readCodes().empty());
+	EXPECT_NE(reader().toJson().find("\"count\":0,\"dtcs\":[]"), std::string::npos);
+}
+
+TEST(EcuDtcReader, JoinsTheFramesOfAResponse)
+{
+	// 3 frames, the last one only partly filled
+	const std::vector<std::string> codes = makeCodes(2 * DTCS_PER_FRAME + 1);
+	const EmulatedEcu ecu({"--dtcs", joinCodes(codes)});
+	ASSERT_TRUE(ecu.isRunning());
+
+	ASSERT_TRUE(refreshAndWait());
+	EXPECT_EQ(readCodes(), codes);
+}
+
+TEST(EcuDtcReader, KeepsTheCodesOfTheFirstFrames)
+{
+	// One frame more than a response takes, the count still tells how many there are
+	const std::vector<std::string> codes = makeCodes((KLINE_MAX_RESPONSE_FRAMES + 1) * DTCS_PER_FRAME);
+	const EmulatedEcu ecu({"--dtcs", joinCodes(codes)});
+	ASSERT_TRUE(ecu.isRunning());
+
+	ASSERT_TRUE(refreshAndWait());
+	const std::vector<std::string> expectedCodes(codes.begin(),
+	                                             codes.begin() + KLINE_MAX_RESPONSE_FRAMES * DTCS_PER_FRAME);
+	EXPECT_EQ(readCodes(), expectedCodes);
+	EXPECT_NE(reader().toJson().find("\"count\":" + std::to_string(codes.size()) + ","), std::string::npos);
+}
+
+TEST(EcuDtcReader, ReportsAFailedRead)
+{
+	{
+		const EmulatedEcu ecu({"--dtcs", "P0130"});
+		ASSERT_TRUE(ecu.isRunning());
+		ASSERT_TRUE(refreshAndWait());
+	}
+
+	// The codes of the last successful read are kept
+	const EmulatedEcu ecu({"--drop-rate", "1"});
+	ASSERT_TRUE(ecu.isRunning());
+
+	ASSERT_TRUE(refreshAndWait());
+	EXPECT_EQ(readCodes(), std::vector<std::string>({"P0130"}));
+	EXPECT_NE(reader().toJson().find("\"failed\":true,"), std::string::npos);
+}
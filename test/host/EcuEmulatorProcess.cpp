@@ -0,0 +1,59 @@
+// Project includes
+#include "EcuEmulatorProcess.hpp"
+
+// C++ includes
+#include <csignal>
+
+// POSIX includes
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ *	Public Function Implementations
+ */
+std::string startEcuEmulator(const std::string& path, const std::vector<std::string>& args, pid_t& pid)
+{
+	int pipeFds[2];
+	if (pipe(pipeFds) != 0) {
+		return "";
+	}
+
+	std::vector<std::string> allArgs = {path, "serve"};
+	allArgs.insert(allArgs.end(), args.begin(), args.end());
+
+	std::vector<char*> argv;
+	for (std::string& arg : allArgs) {
+		argv.push_back(arg.data());
+	}
+	argv.push_back(nullptr);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addclose(&actions, pipeFds[0]);
+
+	const int error = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+	close(pipeFds[1]);
+	if (error != 0) {
+		close(pipeFds[0]);
+		return "";
+	}
+
+	// The emulator prints the path of the pseudo-terminal once it's ready
+	std::string device;
+	char c;
+	while (read(pipeFds[0], &c, 1) == 1 && c != '\n') {
+		device += c;
+	}
+	close(pipeFds[0]);
+
+	return device;
+}
+
+void stopEcuEmulator(const pid_t pid)
+{
+	kill(pid, SIGTERM);
+	waitpid(pid, nullptr, 0);
+}
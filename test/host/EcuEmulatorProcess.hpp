@@ -0,0 +1,16 @@
+#pragma once
+
+// C++ includes
+#include <string>
+#include <vector>
+
+// POSIX includes
+#include <sys/types.h>
+
+/*
+ *	Public Functions
+ */
+// Starts "<path> serve <args>" on a new pseudo-terminal and returns its path, empty if it didn't start
+std::string startEcuEmulator(const std::string& path, const std::vector<std::string>& args, pid_t& pid);
+
+void stopEcuEmulator(pid_t pid);
@@ -0,0 +1,140 @@
+#include "State/IdleMonitor.hpp"
+
+// Libraries
+#include <gtest/gtest.h>
+
+/*
+ *	constexpr
+ */
+constexpr int64_t IDLE_AFTER_US = 60000000;
+
+// The operation state feeds the monitor with this period
+constexpr int64_t UPDATE_PERIOD_US = 100000;
+
+/*
+ *	Helpers
+ */
+static IdleMonitor makeMonitor()
+{
+	IdleMonitor::Config config;
+	config.idleAfterUs = IDLE_AFTER_US;
+	return IdleMonitor(config);
+}
+
+// Feeds the same values until endUs, returns the time of the first state change or -1
+static int64_t feed(IdleMonitor& monitor, int64_t& nowUs, const int64_t endUs, const int32_t rpm,
+                    const int32_t oilPressure)
+{
+	int64_t changedUs = -1;
+	while (nowUs < endUs) {
+		nowUs += UPDATE_PERIOD_US;
+		if (monitor.update(nowUs, rpm, oilPressure) && changedUs < 0) {
+			changedUs = nowUs;
+		}
+	}
+
+	return changedUs;
+}
+
+/*
+ *	Tests
+ */
+TEST(IdleMonitor, StaysActiveWhileTheEngineRuns)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	EXPECT_EQ(feed(monitor, nowUs, 3 * IDLE_AFTER_US, 850, 1), -1);
+	EXPECT_EQ(monitor.getState(), IdleMonitor::ACTIVE);
+}
+
+TEST(IdleMonitor, GoesIdleAfterTheEngineWasOff)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	feed(monitor, nowUs, 1000000, 850, 1);
+	const int64_t engineOffUs = nowUs + UPDATE_PERIOD_US;
+
+	const int64_t idleUs = feed(monitor, nowUs, engineOffUs + 2 * IDLE_AFTER_US, 0, 0);
+	EXPECT_EQ(idleUs, engineOffUs + IDLE_AFTER_US);
+	EXPECT_TRUE(monitor.isIdle());
+}
+
+TEST(IdleMonitor, OilPressureAloneKeepsItActive)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	// E.g. a missing RPM signal while the engine runs
+	EXPECT_EQ(feed(monitor, nowUs, 2 * IDLE_AFTER_US, 0, 1), -1);
+	EXPECT_FALSE(monitor.isIdle());
+}
+
+TEST(IdleMonitor, ShortEngineRunRestartsTheOffPhase)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	feed(monitor, nowUs, IDLE_AFTER_US - 1000000, 0, 0);
+	feed(monitor, nowUs, nowUs + UPDATE_PERIOD_US, 850, 1);
+	const int64_t engineOffUs = nowUs + UPDATE_PERIOD_US;
+
+	EXPECT_EQ(feed(monitor, nowUs, engineOffUs + 2 * IDLE_AFTER_US, 0, 0), engineOffUs + IDLE_AFTER_US);
+}
+
+TEST(IdleMonitor, EngineWakesWithoutLatency)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	feed(monitor, nowUs, 2 * IDLE_AFTER_US, 0, 0);
+	ASSERT_TRUE(monitor.isIdle());
+
+	nowUs += UPDATE_PERIOD_US;
+	EXPECT_TRUE(monitor.update(nowUs, 850, 0));
+	EXPECT_EQ(monitor.getState(), IdleMonitor::ACTIVE);
+	EXPECT_EQ(monitor.getLastWakeReason(), IdleMonitor::WAKE_ENGINE);
+	EXPECT_EQ(monitor.getLastWakeLatencyUs(), 0u);
+	EXPECT_EQ(monitor.getWakeCount(), 1u);
+}
+
+TEST(IdleMonitor, MeasuresTheWakeLatencyOfEvents)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	feed(monitor, nowUs, 2 * IDLE_AFTER_US, 0, 0);
+	ASSERT_TRUE(monitor.isIdle());
+
+	// The RPM edge is handled 1.5 ms after the ISR saw it
+	EXPECT_TRUE(monitor.wake(nowUs, nowUs + 1500, IdleMonitor::WAKE_RPM_EDGE));
+	EXPECT_EQ(monitor.getLastWakeReason(), IdleMonitor::WAKE_RPM_EDGE);
+	EXPECT_EQ(monitor.getLastWakeLatencyUs(), 1500u);
+
+	// Go idle again and wake up faster, the maximum is kept
+	nowUs += 1500;
+	feed(monitor, nowUs, nowUs + 2 * IDLE_AFTER_US, 0, 0);
+	ASSERT_TRUE(monitor.isIdle());
+
+	EXPECT_TRUE(monitor.wake(nowUs, nowUs + 400, IdleMonitor::WAKE_CAN_FRAME));
+	EXPECT_EQ(monitor.getLastWakeReason(), IdleMonitor::WAKE_CAN_FRAME);
+	EXPECT_EQ(monitor.getLastWakeLatencyUs(), 400u);
+	EXPECT_EQ(monitor.getMaxWakeLatencyUs(), 1500u);
+	EXPECT_EQ(monitor.getWakeCount(), 2u);
+}
+
+TEST(IdleMonitor, WakeWhileActiveDelaysTheIdleState)
+{
+	IdleMonitor monitor = makeMonitor();
+	int64_t nowUs = 0;
+
+	feed(monitor, nowUs, IDLE_AFTER_US - 1000000, 0, 0);
+
+	// A CAN frame keeps the board active for another period
+	EXPECT_FALSE(monitor.wake(nowUs, nowUs, IdleMonitor::WAKE_CAN_FRAME));
+	const int64_t wakeUs = nowUs;
+
+	EXPECT_EQ(feed(monitor, nowUs, wakeUs + 2 * IDLE_AFTER_US, 0, 0), wakeUs + IDLE_AFTER_US);
+	EXPECT_EQ(monitor.getWakeCount(), 0u);
+}
@@ -0,0 +1,272 @@
+// Runs the K-Line driver and the poll scheduler of the firmware against the ECU emulator on a pseudo-terminal and
+// reports the achieved throughput. Fails if a PID misses its rate or there are too many timeouts, so it runs in CTest.
+//
+// Usage:
+//	KLineBench --emulator <path> [options] [-- <emulator serve options>]
+//
+// Options:
+//	--seconds <n>            Duration of the run (5)
+//	--pids <pid,pid,...>     Subscribed PIDs (RPM, speed, coolant, throttle)
+//	--period-ms <n>          Period of every subscription (100)
+//	--batch <n>              PIDs per request, 1 disables the batching (5)
+//	--p2-ms <n>              Response timeout (100)
+//	--p3-ms <n>              Pause between the response and the next request (10)
+//	--init                   Start a session with a fast init
+//	--adaptive               Adaptive P2 & P3
+//	--min-rate <f>           Fraction of the subscribed rate every PID has to reach (0.8)
+//	--max-timeouts <n>       Timeouts the driver may see, -1 for any (0)
+
+// Project includes
+#include "Driver/EcuPollScheduler.hpp"
+#include "Driver/EcuPids.h"
+#include "Driver/EcuValueCache.hpp"
+#include "Driver/KLine.hpp"
+#include "EcuEmulatorProcess.hpp"
+#include "HostUart.hpp"
+
+// C++ includes
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX includes
+#include <unistd.h>
+
+/*
+ *	Private Struct
+ */
+struct Options
+{
+	std::string emulator;
+	std::vector<std::string> emulatorArgs;
+
+	uint32_t seconds = 5;
+	std::vector<uint16_t> pids = {ADDR_RPM, ADDR_SPEED_KMH, ADDR_COOLANT_C, ADDR_THROTTLE_POSITION_V};
+	uint32_t periodMs = 100;
+	uint32_t batch = KLINE_MAX_PIDS_PER_READ;
+
+	KLine::Timing timing;
+
+	double minRate = 0.8;
+	int32_t maxTimeouts = 0;
+};
+
+struct PidCounters
+{
+	uint32_t valid = 0;
+	uint32_t invalid = 0;
+};
+
+// Collects the results of the scheduler, called from the K-Line task
+class ResultCounter
+{
+public:
+	static void staticOnResult(const EcuPollScheduler::Result& result, uint32_t, void* ctx)
+	{
+		static_cast<ResultCounter*>(ctx)->onResult(result);
+	}
+
+	std::map<uint16_t, PidCounters> get()
+	{
+		std::lock_guard lock(mutex_);
+		return counters_;
+	}
+
+private:
+	void onResult(const EcuPollScheduler::Result& result)
+	{
+		std::lock_guard lock(mutex_);
+		PidCounters& counters = counters_[result.pid];
+		if (result.valid) {
+			counters.valid++;
+		}
+		else {
+			counters.invalid++;
+		}
+	}
+
+	std::mutex mutex_;
+	std::map<uint16_t, PidCounters> counters_;
+};
+
+/*
+ *	Private Functions
+ */
+static bool parseUnsigned(const char* text, uint32_t& value)
+{
+	char* end = nullptr;
+	value = strtoul(text, &end, 0);
+	return end != text && *end == '\0';
+}
+
+static bool parseOptions(const int argc, char** argv, Options& options)
+{
+	options.timing.fastInit = false;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg(argv[i]);
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (arg == "--") {
+			options.emulatorArgs.assign(argv + i + 1, argv + argc);
+			break;
+		}
+		if (arg == "--init") {
+			options.timing.fastInit = true;
+			continue;
+		}
+		if (arg == "--adaptive") {
+			options.timing.adaptive = true;
+			continue;
+		}
+
+		// Everything else has a value
+		if (value == nullptr) {
+			return false;
+		}
+		i++;
+
+		bool valid = true;
+		uint32_t number = 0;
+		if (arg == "--emulator") {
+			options.emulator = value;
+		}
+		else if (arg == "--seconds") {
+			valid = parseUnsigned(value, options.seconds);
+		}
+		else if (arg == "--pids") {
+			options.pids.clear();
+			const std::string list(value);
+			size_t start = 0;
+			while (valid && start <= list.size()) {
+				const size_t end = std::min(list.find(',', start), list.size());
+				valid = parseUnsigned(list.substr(start, end - start).c_str(), number) && number <= 0xFFFF;
+				options.pids.push_back(number);
+				start = end + 1;
+			}
+		}
+		else if (arg == "--period-ms") {
+			valid = parseUnsigned(value, options.periodMs) && options.periodMs > 0;
+		}
+		else if (arg == "--batch") {
+			valid = parseUnsigned(value, options.batch) && options.batch >= 1;
+		}
+		else if (arg == "--p2-ms") {
+			valid = parseUnsigned(value, number);
+			options.timing.p2MaxUs = number * 1000;
+		}
+		else if (arg == "--p3-ms") {
+			valid = parseUnsigned(value, number);
+			options.timing.p3MinUs = number * 1000;
+		}
+		else if (arg == "--min-rate") {
+			char* end = nullptr;
+			options.minRate = strtod(value, &end);
+			valid = end != value && *end == '\0';
+		}
+		else if (arg == "--max-timeouts") {
+			char* end = nullptr;
+			options.maxTimeouts = static_cast<int32_t>(strtol(value, &end, 0));
+			valid = end != value && *end == '\0';
+		}
+		else {
+			valid = false;
+		}
+
+		if (!valid) {
+			fprintf(stderr, "Invalid option %s %s\n", arg.c_str(), value);
+			return false;
+		}
+	}
+
+	return !options.emulator.empty() && !options.pids.empty();
+}
+
+static int run(const Options& options)
+{
+	pid_t emulatorPid = 0;
+	const std::string device = startEcuEmulator(options.emulator, options.emulatorArgs, emulatorPid);
+	if (device.empty()) {
+		fprintf(stderr, "Failed to start %s\n", options.emulator.c_str());
+		return EXIT_FAILURE;
+	}
+	hostUartAttach(UART_NUM_2, device.c_str());
+
+	// Like in the Core they live until the end, the tasks can't be stopped
+	auto* kline = new KLine(options.timing);
+	if (!kline->isInitialized()) {
+		stopEcuEmulator(emulatorPid);
+		return EXIT_FAILURE;
+	}
+
+	auto* cache = new EcuValueCache(1000);
+	auto* scheduler = new EcuPollScheduler(kline, cache, options.batch);
+	auto* counter = new ResultCounter();
+	scheduler->addListener(EcuValueCache::staticOnResult, cache);
+	scheduler->addListener(ResultCounter::staticOnResult, counter);
+
+	const int8_t subscriber = scheduler->addSubscriber();
+	for (const uint16_t pid : options.pids) {
+		scheduler->subscribe(subscriber, pid, options.periodMs);
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+	scheduler->removeSubscriber(subscriber);
+
+	const KLine::Stats stats = kline->getStats();
+	const std::map<uint16_t, PidCounters> counters = counter->get();
+	stopEcuEmulator(emulatorPid);
+
+	// Rates over the whole run, the fast init counts against it
+	const double subscribedRate = 1000.0 / options.periodMs;
+	uint32_t validResults = 0;
+	bool rateReached = true;
+	for (const uint16_t pid : options.pids) {
+		const PidCounters pidCounters = counters.contains(pid) ? counters.at(pid) : PidCounters();
+		const double rate = static_cast<double>(pidCounters.valid) / options.seconds;
+		validResults += pidCounters.valid;
+		rateReached = rateReached && rate >= subscribedRate * options.minRate;
+
+		printf("PID 0x%04X: %.1f/s of %.1f/s, %u failed\n", pid, rate, subscribedRate, pidCounters.invalid);
+	}
+
+	printf("%u requests, %u responses, %u PIDs, %u timeouts, %u invalid & %u dropped frames\n", stats.requests,
+	       stats.responses, stats.pidsRead, stats.timeouts, stats.invalidFrames, stats.droppedFrames);
+	printf("%.1f requests/s, %.1f PIDs/s, response %.2f ms min, %.2f ms max, P2 %.1f ms, P3 %.1f ms\n",
+	       static_cast<double>(stats.responses) / options.seconds, static_cast<double>(validResults) / options.seconds,
+	       stats.minResponseUs / 1000.0, stats.maxResponseUs / 1000.0, stats.p2MaxUs / 1000.0,
+	       stats.p3MinUs / 1000.0);
+
+	const bool timeoutsOk = options.maxTimeouts < 0 || stats.timeouts <= static_cast<uint32_t>(options.maxTimeouts);
+	if (!rateReached) {
+		printf("FAILED: a PID stayed below %.0f %% of its rate\n", options.minRate * 100.0);
+	}
+	if (!timeoutsOk) {
+		printf("FAILED: more than %d timeouts\n", options.maxTimeouts);
+	}
+
+	return rateReached && timeoutsOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(const int argc, char** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		fprintf(stderr, "Usage: %s --emulator <path> [options] [-- <emulator options>], see the head of %s\n",
+		        argv[0], __FILE__);
+		return EXIT_FAILURE;
+	}
+
+	const int result = run(options);
+
+	// The driver tasks still run, so don't tear down the statics under them
+	fflush(stdout);
+	fflush(stderr);
+	_exit(result);
+}
@@ -0,0 +1,177 @@
+#include "Sensor/SpeedEstimator.hpp"
+
+// Libraries
+#include <gtest/gtest.h>
+
+/*
+ *	constexpr
+ */
+// The sensor task updates the estimator with this period
+constexpr int64_t UPDATE_PERIOD_US = 10000;
+
+/*
+ *	Helpers
+ */
+// Synthetic edges of the speed sensor with a constant frequency, as the ISR would record them
+class PulseTrain
+{
+public:
+	// Runs the train for durationUs with the given edge frequency and updates the estimator every update period
+	void run(SpeedEstimator& estimator, const int64_t durationUs, const double hz)
+	{
+		const int64_t endUs = nowUs_ + durationUs;
+		while (nowUs_ < endUs) {
+			nowUs_ += UPDATE_PERIOD_US;
+			advance(hz);
+			estimator.update(nowUs_, edges_);
+		}
+	}
+
+	int64_t getNowUs() const
+	{
+		return nowUs_;
+	}
+
+	const SpeedEstimator::Edges& getEdges() const
+	{
+		return edges_;
+	}
+
+private:
+	void advance(const double hz)
+	{
+		if (hz <= 0.0) {
+			nextEdgeUs_ = -1.0;
+			return;
+		}
+
+		const double periodUs = 1000000.0 / hz;
+		if (nextEdgeUs_ < 0.0) {
+			nextEdgeUs_ = static_cast<double>(nowUs_);
+		}
+
+		while (nextEdgeUs_ <= static_cast<double>(nowUs_)) {
+			edges_.previousEdgeUs = edges_.lastEdgeUs;
+			edges_.lastEdgeUs = static_cast<int64_t>(nextEdgeUs_);
+			edges_.pulseCount++;
+			nextEdgeUs_ += periodUs;
+		}
+	}
+
+	int64_t nowUs_ = 0;
+	double nextEdgeUs_ = -1.0;
+	SpeedEstimator::Edges edges_;
+};
+
+// 1 km/h per Hz, so the edge frequency reads as the speed
+static SpeedEstimator::Config makeConfig()
+{
+	SpeedEstimator::Config config;
+	config.kmhPerHz = 1.0f;
+	return config;
+}
+
+/*
+ *	Tests
+ */
+TEST(SpeedEstimator, StandsStillWithoutEdges)
+{
+	SpeedEstimator estimator(makeConfig());
+	PulseTrain train;
+
+	train.run(estimator, 500000, 0.0);
+
+	EXPECT_EQ(estimator.getCentiKmh(), 0u);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PERIOD);
+}
+
+TEST(SpeedEstimator, ReportsCentiKmhFromThePeriod)
+{
+	SpeedEstimator estimator(makeConfig());
+	PulseTrain train;
+
+	train.run(estimator, 1000000, 12.5);
+
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PERIOD);
+	EXPECT_NEAR(estimator.getCentiKmh(), 1250, 2);
+	EXPECT_EQ(estimator.getKmh(), 13);
+}
+
+TEST(SpeedEstimator, SwitchesModesWithHysteresis)
+{
+	SpeedEstimator estimator(makeConfig());
+	PulseTrain train;
+
+	// Below the upper threshold the period is used
+	train.run(estimator, 1000000, 28.0);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PERIOD);
+
+	// Above 30 km/h the pulses are counted
+	train.run(estimator, 1000000, 40.0);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PULSE_COUNT);
+	EXPECT_NEAR(estimator.getCentiKmh(), 4000, 60);
+
+	// Between both thresholds the mode is kept
+	train.run(estimator, 1000000, 27.0);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PULSE_COUNT);
+	EXPECT_NEAR(estimator.getCentiKmh(), 2700, 60);
+
+	// Below 25 km/h it switches back
+	train.run(estimator, 1000000, 20.0);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PERIOD);
+	EXPECT_NEAR(estimator.getCentiKmh(), 2000, 5);
+
+	// And stays there until 30 km/h are exceeded again
+	train.run(estimator, 1000000, 29.0);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PERIOD);
+}
+
+TEST(SpeedEstimator, CountsPulsesOverTheGate)
+{
+	SpeedEstimator estimator(makeConfig());
+	PulseTrain train;
+
+	train.run(estimator, 1000000, 100.0);
+	ASSERT_EQ(estimator.getMode(), SpeedEstimator::PULSE_COUNT);
+
+	// The value only changes when a gate closes, so it changes at most once per gate
+	uint32_t changes = 0;
+	uint32_t lastCentiKmh = estimator.getCentiKmh();
+	for (int i = 0; i < 100; i++) {
+		train.run(estimator, UPDATE_PERIOD_US, i < 50 ? 100.0 : 150.0);
+
+		if (estimator.getCentiKmh() != lastCentiKmh) {
+			changes++;
+			lastCentiKmh = estimator.getCentiKmh();
+		}
+	}
+
+	// 1 s in 100 ms gates
+	EXPECT_LE(changes, 10u);
+	EXPECT_GE(changes, 1u);
+	EXPECT_NEAR(estimator.getCentiKmh(), 15000, 200);
+
+	// The window spans the edges of one gate
+	EXPECT_GE(estimator.getWindowUs(), 90000u);
+	EXPECT_LE(estimator.getWindowUs(), 120000u);
+}
+
+TEST(SpeedEstimator, DropsToZeroAfterTheStandstillTimeout)
+{
+	SpeedEstimator estimator(makeConfig());
+	PulseTrain train;
+
+	train.run(estimator, 1000000, 50.0);
+	ASSERT_GT(estimator.getCentiKmh(), 0u);
+	const int64_t lastEdgeUs = train.getEdges().lastEdgeUs;
+
+	// Just before the timeout the value decays, but isn't zero yet
+	train.run(estimator, 1400000 - (train.getNowUs() - lastEdgeUs), 0.0);
+	EXPECT_GT(estimator.getCentiKmh(), 0u);
+	EXPECT_LT(estimator.getCentiKmh(), 100u);
+
+	// 1.5 s after the last edge the vehicle stands
+	train.run(estimator, 100000, 0.0);
+	EXPECT_EQ(estimator.getCentiKmh(), 0u);
+	EXPECT_EQ(estimator.getMode(), SpeedEstimator::PERIOD);
+}
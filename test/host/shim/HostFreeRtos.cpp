@@ -0,0 +1,326 @@
+// Project includes
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// C++ includes
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ *	Private Struct
+ */
+struct HostTask
+{
+	std::string name;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	uint32_t notifications = 0;
+};
+
+struct HostQueue
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	size_t length;
+	size_t itemSize;
+	std::deque<std::vector<uint8_t>> items;
+};
+
+struct HostMutex
+{
+	std::timed_mutex mutex;
+};
+
+// Thrown by vTaskDelete(nullptr) to unwind the task function
+struct TaskDeleted
+{
+};
+
+/*
+ *	Private Variables
+ */
+static thread_local HostTask* currentTask = nullptr;
+
+static esp_log_level_t logLevel = ESP_LOG_INFO;
+static std::mutex logMutex;
+
+/*
+ *	Private Functions
+ */
+static std::chrono::milliseconds toDuration(const TickType_t ticks)
+{
+	return std::chrono::milliseconds(static_cast<int64_t>(ticks) * portTICK_PERIOD_MS);
+}
+
+// Waits for the predicate like FreeRTOS would block, forever with portMAX_DELAY. That one waits in slices, as
+// condition_variable::wait needs a newer libstdc++ than some prebuilt GoogleTest packages bring along
+template<typename Predicate>
+static bool waitFor(std::condition_variable& condition, std::unique_lock<std::mutex>& lock, const TickType_t ticks,
+                    Predicate predicate)
+{
+	if (ticks == portMAX_DELAY) {
+		while (!condition.wait_for(lock, std::chrono::seconds(1), predicate)) {
+		}
+		return true;
+	}
+
+	return condition.wait_for(lock, toDuration(ticks), predicate);
+}
+
+// long has 32 bit on the board, so %lu & co. are passed 32 bit values
+static std::string toHostFormat(const char* format)
+{
+	std::string hostFormat;
+	for (const char* c = format; *c != '\0'; c++) {
+		hostFormat += *c;
+		if (*c != '%') {
+			continue;
+		}
+
+		while (c[1] != '\0' && strchr("-+ #0123456789.*", c[1]) != nullptr) {
+			hostFormat += *++c;
+		}
+
+		if (c[1] == 'l' && c[2] != 'l') {
+			c++;
+		}
+		else if (c[1] == '%') {
+			hostFormat += *++c;
+		}
+	}
+
+	return hostFormat;
+}
+
+/*
+ *	Tasks
+ */
+BaseType_t xTaskCreate(const TaskFunction_t function, const char* name, uint32_t, void* param, UBaseType_t,
+                       TaskHandle_t* handle)
+{
+	auto* task = new HostTask();
+	task->name = name;
+
+	std::thread([function, param, task] {
+		currentTask = task;
+		try {
+			function(param);
+		}
+		catch (const TaskDeleted&) {
+		}
+	}).detach();
+
+	if (handle != nullptr) {
+		*handle = task;
+	}
+
+	return pdPASS;
+}
+
+void vTaskDelete(const TaskHandle_t task)
+{
+	if (task == nullptr || task == currentTask) {
+		throw TaskDeleted();
+	}
+}
+
+void vTaskDelay(const TickType_t ticks)
+{
+	std::this_thread::sleep_for(toDuration(ticks));
+}
+
+TickType_t xTaskGetTickCount()
+{
+	return static_cast<TickType_t>(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+	if (currentTask == nullptr) {
+		currentTask = new HostTask();
+		currentTask->name = "main";
+	}
+
+	return currentTask;
+}
+
+BaseType_t xTaskNotifyGive(const TaskHandle_t task)
+{
+	{
+		std::lock_guard lock(task->mutex);
+		task->notifications++;
+	}
+	task->condition.notify_all();
+
+	return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clearCountOnExit, const TickType_t ticksToWait)
+{
+	HostTask* task = xTaskGetCurrentTaskHandle();
+
+	std::unique_lock lock(task->mutex);
+	if (!waitFor(task->condition, lock, ticksToWait, [task] { return task->notifications > 0; })) {
+		return 0;
+	}
+
+	const uint32_t notifications = task->notifications;
+	task->notifications = clearCountOnExit == pdTRUE ? 0 : notifications - 1;
+	return notifications;
+}
+
+/*
+ *	Queues
+ */
+QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t itemSize)
+{
+	auto* queue = new HostQueue();
+	queue->length = length;
+	queue->itemSize = itemSize;
+	return queue;
+}
+
+void vQueueDelete(const QueueHandle_t queue)
+{
+	delete queue;
+}
+
+BaseType_t xQueueSend(const QueueHandle_t queue, const void* item, const TickType_t ticksToWait)
+{
+	{
+		std::unique_lock lock(queue->mutex);
+		if (!waitFor(queue->condition, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+			return pdFALSE;
+		}
+
+		const auto* bytes = static_cast<const uint8_t*>(item);
+		queue->items.emplace_back(bytes, bytes + queue->itemSize);
+	}
+	queue->condition.notify_all();
+
+	return pdTRUE;
+}
+
+BaseType_t xQueueReceive(const QueueHandle_t queue, void* item, const TickType_t ticksToWait)
+{
+	{
+		std::unique_lock lock(queue->mutex);
+		if (!waitFor(queue->condition, lock, ticksToWait, [queue] { return !queue->items.empty(); })) {
+			return pdFALSE;
+		}
+
+		memcpy(item, queue->items.front().data(), queue->itemSize);
+		queue->items.pop_front();
+	}
+	queue->condition.notify_all();
+
+	return pdTRUE;
+}
+
+BaseType_t xQueueReset(const QueueHandle_t queue)
+{
+	{
+		std::lock_guard lock(queue->mutex);
+		queue->items.clear();
+	}
+	queue->condition.notify_all();
+
+	return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t queue)
+{
+	std::lock_guard lock(queue->mutex);
+	return queue->items.size();
+}
+
+/*
+ *	Semaphores
+ */
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+	return new HostMutex();
+}
+
+void vSemaphoreDelete(const SemaphoreHandle_t semaphore)
+{
+	delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(const SemaphoreHandle_t semaphore, const TickType_t ticksToWait)
+{
+	if (ticksToWait == portMAX_DELAY) {
+		semaphore->mutex.lock();
+		return pdTRUE;
+	}
+
+	return semaphore->mutex.try_lock_for(toDuration(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(const SemaphoreHandle_t semaphore)
+{
+	semaphore->mutex.unlock();
+	return pdTRUE;
+}
+
+/*
+ *	Timer
+ */
+int64_t esp_timer_get_time()
+{
+	static const auto startTime = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void esp_rom_delay_us(const uint32_t us)
+{
+	const int64_t endUs = esp_timer_get_time() + us;
+	while (esp_timer_get_time() < endUs) {
+	}
+}
+
+/*
+ *	Log
+ */
+void esp_log_level_set(const char* tag, const esp_log_level_t level)
+{
+	if (strcmp(tag, "*") == 0) {
+		logLevel = level;
+	}
+}
+
+void hostLog(const esp_log_level_t level, const char* tag, const char* format, ...)
+{
+	constexpr char LEVELS[] = "NEWIDV";
+
+	if (level > logLevel) {
+		return;
+	}
+
+	const std::string hostFormat = toHostFormat(format);
+
+	std::lock_guard lock(logMutex);
+	fprintf(stderr, "%c (%lld) %s: ", LEVELS[level], static_cast<long long>(esp_timer_get_time() / 1000), tag);
+
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, hostFormat.c_str(), args);
+	va_end(args);
+
+	fputc('\n', stderr);
+}
@@ -0,0 +1,353 @@
+// Project includes
+#include "HostUart.hpp"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+// C++ includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX includes
+#include <asm/ioctls.h>
+#include <asm/termbits.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// <sys/ioctl.h> conflicts with the termios2 definitions
+extern "C" int ioctl(int fd, unsigned long request, ...);
+
+/*
+ *	constexpr
+ */
+// Start, 8 data & stop bit
+constexpr uint32_t BITS_PER_BYTE = 10;
+
+// Bytes read at once, about the RX FIFO threshold of the board
+constexpr size_t READ_CHUNK = 64;
+
+/*
+ *	Private Struct
+ */
+struct HostUartPort
+{
+	std::string device;
+	std::atomic<int> fd = -1;
+	uint32_t baudRate = 115200;
+	int txPin = UART_PIN_NO_CHANGE;
+	bool txPinTaken = false;
+
+	QueueHandle_t eventQueue = nullptr;
+	size_t rxBufferSize = 0;
+
+	std::atomic<bool> running = false;
+	std::thread rxThread;
+	std::thread txThread;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<uint8_t> rxBuffer;
+	std::deque<uint8_t> txBuffer;
+
+	// Bytes taken from the TX buffer, but not written yet
+	bool txActive = false;
+	int64_t txBusyUntilUs = 0;
+};
+
+/*
+ *	Private Variables
+ */
+// Never destroyed, the driver tasks still use them when the process exits
+static std::array<HostUartPort, UART_NUM_MAX>& ports = *new std::array<HostUartPort, UART_NUM_MAX>();
+
+/*
+ *	Private Functions
+ */
+// Raw 8N1 without any line discipline. termios2 also allows the non-standard 10400 baud
+static bool configureTty(const int fd, const uint32_t baudRate)
+{
+	termios2 tty = {};
+	if (ioctl(fd, TCGETS2, &tty) != 0) {
+		return false;
+	}
+
+	tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+	tty.c_oflag &= ~OPOST;
+	tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	tty.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CBAUD);
+	tty.c_cflag |= CS8 | CLOCAL | CREAD | BOTHER;
+	tty.c_ispeed = baudRate;
+	tty.c_ospeed = baudRate;
+	tty.c_cc[VMIN] = 0;
+	tty.c_cc[VTIME] = 0;
+
+	return ioctl(fd, TCSETS2, &tty) == 0;
+}
+
+static int64_t byteTimeUs(const HostUartPort& port)
+{
+	return BITS_PER_BYTE * 1000000LL / port.baudRate;
+}
+
+// Moves the received bytes into the RX buffer and reports them with an event, like the UART ISR
+static void rxThread(HostUartPort* port)
+{
+	uint8_t chunk[READ_CHUNK];
+
+	while (port->running) {
+		pollfd pfd = {.fd = port->fd, .events = POLLIN, .revents = 0};
+		if (poll(&pfd, 1, 10) <= 0) {
+			continue;
+		}
+
+		const ssize_t bytesRead = read(port->fd, chunk, sizeof(chunk));
+		if (bytesRead <= 0) {
+			continue;
+		}
+
+		uart_event_t event = {.type = UART_DATA, .size = static_cast<size_t>(bytesRead), .timeout_flag = true};
+		{
+			std::lock_guard lock(port->mutex);
+			if (port->rxBuffer.size() + bytesRead > port->rxBufferSize) {
+				event.type = UART_BUFFER_FULL;
+			}
+			else {
+				port->rxBuffer.insert(port->rxBuffer.end(), chunk, chunk + bytesRead);
+			}
+		}
+
+		// Lost like from the ISR if the queue is full
+		xQueueSend(port->eventQueue, &event, 0);
+	}
+}
+
+// Sends the queued bytes with the baud rate. A burst is written at once when its last byte would have left the wire,
+// so the receiver gets it complete at the same time as on the line and without gaps from the host scheduling
+static void txThread(HostUartPort* port)
+{
+	std::unique_lock lock(port->mutex);
+
+	while (port->running) {
+		if (port->txBuffer.empty()) {
+			port->condition.wait_for(lock, std::chrono::milliseconds(10));
+			continue;
+		}
+
+		const std::vector<uint8_t> burst(port->txBuffer.begin(), port->txBuffer.end());
+		port->txBuffer.clear();
+		port->txActive = true;
+
+		const int64_t startUs = std::max(esp_timer_get_time(), port->txBusyUntilUs);
+		port->txBusyUntilUs = startUs + static_cast<int64_t>(burst.size()) * byteTimeUs(*port);
+		const int64_t busyUntilUs = port->txBusyUntilUs;
+
+		lock.unlock();
+		std::this_thread::sleep_for(std::chrono::microseconds(busyUntilUs - esp_timer_get_time()));
+		(void)!write(port->fd, burst.data(), burst.size());
+		lock.lock();
+
+		port->txActive = false;
+		port->condition.notify_all();
+	}
+}
+
+static HostUartPort* findPortOfPin(const gpio_num_t gpio)
+{
+	for (HostUartPort& port : ports) {
+		if (port.fd >= 0 && port.txPin == gpio) {
+			return &port;
+		}
+	}
+
+	return nullptr;
+}
+
+/*
+ *	Public Function Implementations
+ */
+void hostUartAttach(const uart_port_t port, const char* device)
+{
+	HostUartPort& uart = ports[port];
+	uart.device = device;
+	if (uart.fd < 0) {
+		return;
+	}
+
+	// Like plugging the adapter into another ECU, the threads continue on the new device
+	const int fd = open(device, O_RDWR | O_NOCTTY);
+	if (fd < 0 || !configureTty(fd, uart.baudRate)) {
+		return;
+	}
+
+	std::lock_guard lock(uart.mutex);
+	close(uart.fd.exchange(fd));
+	uart.rxBuffer.clear();
+}
+
+esp_err_t uart_driver_install(const uart_port_t port, const int rxBufferSize, int, const int queueSize,
+                              QueueHandle_t* queue, int)
+{
+	HostUartPort& uart = ports[port];
+	if (uart.device.empty() || uart.fd >= 0) {
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	uart.fd = open(uart.device.c_str(), O_RDWR | O_NOCTTY);
+	if (uart.fd < 0 || !configureTty(uart.fd, uart.baudRate)) {
+		return ESP_FAIL;
+	}
+
+	uart.rxBufferSize = rxBufferSize;
+	uart.eventQueue = xQueueCreate(queueSize, sizeof(uart_event_t));
+	if (queue != nullptr) {
+		*queue = uart.eventQueue;
+	}
+
+	uart.running = true;
+	uart.rxThread = std::thread(rxThread, &uart);
+	uart.txThread = std::thread(txThread, &uart);
+
+	return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(const uart_port_t port)
+{
+	HostUartPort& uart = ports[port];
+	if (uart.fd < 0) {
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	uart.running = false;
+	uart.condition.notify_all();
+	uart.rxThread.join();
+	uart.txThread.join();
+
+	close(uart.fd);
+	uart.fd = -1;
+	vQueueDelete(uart.eventQueue);
+	uart.eventQueue = nullptr;
+
+	return ESP_OK;
+}
+
+esp_err_t uart_param_config(const uart_port_t port, const uart_config_t* config)
+{
+	HostUartPort& uart = ports[port];
+	if (config == nullptr || config->baud_rate <= 0) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	std::lock_guard lock(uart.mutex);
+	uart.baudRate = config->baud_rate;
+	return uart.fd < 0 || configureTty(uart.fd, uart.baudRate) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t uart_set_pin(const uart_port_t port, const int txPin, int, int, int)
+{
+	HostUartPort& uart = ports[port];
+	if (txPin != UART_PIN_NO_CHANGE) {
+		uart.txPin = txPin;
+		uart.txPinTaken = false;
+	}
+
+	return ESP_OK;
+}
+
+int uart_read_bytes(const uart_port_t port, void* buffer, const uint32_t length, const TickType_t ticksToWait)
+{
+	HostUartPort& uart = ports[port];
+	const int64_t deadlineUs = esp_timer_get_time() + static_cast<int64_t>(ticksToWait) * portTICK_PERIOD_MS * 1000;
+
+	// Polled, the wait is rarely used as the data is only read after its event
+	while (true) {
+		{
+			std::lock_guard lock(uart.mutex);
+			if (!uart.rxBuffer.empty() || esp_timer_get_time() >= deadlineUs) {
+				const size_t count = std::min<size_t>(length, uart.rxBuffer.size());
+				std::copy_n(uart.rxBuffer.begin(), count, static_cast<uint8_t*>(buffer));
+				uart.rxBuffer.erase(uart.rxBuffer.begin(), uart.rxBuffer.begin() + count);
+				return static_cast<int>(count);
+			}
+		}
+
+		vTaskDelay(1);
+	}
+}
+
+int uart_write_bytes(const uart_port_t port, const void* data, const size_t size)
+{
+	HostUartPort& uart = ports[port];
+	if (uart.fd < 0) {
+		return -1;
+	}
+
+	{
+		std::lock_guard lock(uart.mutex);
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		uart.txBuffer.insert(uart.txBuffer.end(), bytes, bytes + size);
+	}
+	uart.condition.notify_all();
+
+	return static_cast<int>(size);
+}
+
+esp_err_t uart_wait_tx_done(const uart_port_t port, const TickType_t ticksToWait)
+{
+	HostUartPort& uart = ports[port];
+
+	std::unique_lock lock(uart.mutex);
+	const auto done = [&uart] {
+		return uart.txBuffer.empty() && !uart.txActive;
+	};
+
+	// In slices like the FreeRTOS shim
+	if (ticksToWait == portMAX_DELAY) {
+		while (!uart.condition.wait_for(lock, std::chrono::seconds(1), done)) {
+		}
+		return ESP_OK;
+	}
+
+	return uart.condition.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), done)
+		       ? ESP_OK
+		       : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t uart_flush_input(const uart_port_t port)
+{
+	HostUartPort& uart = ports[port];
+
+	std::lock_guard lock(uart.mutex);
+	uart.rxBuffer.clear();
+
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(const gpio_num_t gpio, const gpio_mode_t mode)
+{
+	HostUartPort* port = findPortOfPin(gpio);
+	if (port != nullptr && mode == GPIO_MODE_OUTPUT) {
+		port->txPinTaken = true;
+	}
+
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_level(const gpio_num_t gpio, const uint32_t level)
+{
+	HostUartPort* port = findPortOfPin(gpio);
+	if (port != nullptr && port->txPinTaken && level == 0) {
+		const uint8_t wakeUp = 0x00;
+		(void)!write(port->fd, &wakeUp, 1);
+	}
+
+	return ESP_OK;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Project includes
+#include "driver/uart.h"
+
+/*
+ *	Public Functions
+ */
+// Connects the UART to a serial device or pseudo-terminal, e.g. the one of the ECU emulator. An installed driver
+// switches to the new device
+void hostUartAttach(uart_port_t port, const char* device);
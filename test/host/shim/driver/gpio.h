@@ -0,0 +1,35 @@
+#pragma once
+
+// Project includes
+#include "esp_err.h"
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Public enum
+ */
+typedef enum
+{
+	GPIO_NUM_NC = -1,
+	GPIO_NUM_0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7, GPIO_NUM_8,
+	GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15, GPIO_NUM_16,
+	GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21,
+	GPIO_NUM_MAX
+} gpio_num_t;
+
+typedef enum
+{
+	GPIO_MODE_DISABLE = 0,
+	GPIO_MODE_INPUT = 1,
+	GPIO_MODE_OUTPUT = 2
+} gpio_mode_t;
+
+/*
+ *	Public Functions
+ */
+// Only the TX pin of a UART is emulated. Switching it to an output takes it from the UART until uart_set_pin()
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode);
+
+// Pulling the taken TX pin low sends a break, which is received as 0x00
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level);
@@ -0,0 +1,108 @@
+#pragma once
+
+// Project includes
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// C++ includes
+#include <cstddef>
+#include <cstdint>
+
+/*
+ *	Public enum
+ */
+typedef enum
+{
+	UART_NUM_0,
+	UART_NUM_1,
+	UART_NUM_2,
+	UART_NUM_MAX
+} uart_port_t;
+
+typedef enum
+{
+	UART_DATA_5_BITS,
+	UART_DATA_6_BITS,
+	UART_DATA_7_BITS,
+	UART_DATA_8_BITS
+} uart_word_length_t;
+
+typedef enum
+{
+	UART_PARITY_DISABLE = 0,
+	UART_PARITY_EVEN = 2,
+	UART_PARITY_ODD = 3
+} uart_parity_t;
+
+typedef enum
+{
+	UART_STOP_BITS_1 = 1,
+	UART_STOP_BITS_1_5,
+	UART_STOP_BITS_2
+} uart_stop_bits_t;
+
+typedef enum
+{
+	UART_HW_FLOWCTRL_DISABLE = 0
+} uart_hw_flowcontrol_t;
+
+typedef enum
+{
+	UART_DATA,
+	UART_BREAK,
+	UART_BUFFER_FULL,
+	UART_FIFO_OVF,
+	UART_FRAME_ERR,
+	UART_PARITY_ERR,
+	UART_DATA_BREAK,
+	UART_PATTERN_DET,
+	UART_EVENT_MAX
+} uart_event_type_t;
+
+/*
+ *	Public Struct
+ */
+typedef struct
+{
+	int baud_rate;
+	uart_word_length_t data_bits;
+	uart_parity_t parity;
+	uart_stop_bits_t stop_bits;
+	uart_hw_flowcontrol_t flow_ctrl;
+	uint8_t rx_flow_ctrl_thresh;
+} uart_config_t;
+
+typedef struct
+{
+	uart_event_type_t type;
+	size_t size;
+	bool timeout_flag;
+} uart_event_t;
+
+/*
+ *	Public defines
+ */
+#define UART_PIN_NO_CHANGE (-1)
+
+/*
+ *	Public Functions
+ */
+// The port has to be attached to a device with hostUartAttach() first
+esp_err_t uart_driver_install(uart_port_t port, int rxBufferSize, int txBufferSize, int queueSize,
+                              QueueHandle_t* queue, int interruptFlags);
+
+esp_err_t uart_driver_delete(uart_port_t port);
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t* config);
+
+esp_err_t uart_set_pin(uart_port_t port, int txPin, int rxPin, int rtsPin, int ctsPin);
+
+int uart_read_bytes(uart_port_t port, void* buffer, uint32_t length, TickType_t ticksToWait);
+
+// The bytes leave with the configured baud rate, like from the TX FIFO
+int uart_write_bytes(uart_port_t port, const void* data, size_t size);
+
+esp_err_t uart_wait_tx_done(uart_port_t port, TickType_t ticksToWait);
+
+esp_err_t uart_flush_input(uart_port_t port);
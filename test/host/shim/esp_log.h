@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+ *	Public enum
+ */
+typedef enum
+{
+	ESP_LOG_NONE,
+	ESP_LOG_ERROR,
+	ESP_LOG_WARN,
+	ESP_LOG_INFO,
+	ESP_LOG_DEBUG,
+	ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+/*
+ *	Public Functions
+ */
+// Only the wildcard tag "*" is supported
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+
+// Prints to stderr. Like on the board %lu takes a 32 bit value, so the firmware format strings can be used unchanged
+void hostLog(esp_log_level_t level, const char* tag, const char* format, ...);
+
+/*
+ *	Public defines
+ */
+#define ESP_LOGE(tag, format, ...) hostLog(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) hostLog(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) hostLog(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) hostLog(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) hostLog(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
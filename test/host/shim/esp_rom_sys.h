@@ -0,0 +1,10 @@
+#pragma once
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Public Functions
+ */
+// Busy waits like the ROM function
+void esp_rom_delay_us(uint32_t us);
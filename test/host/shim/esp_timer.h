@@ -0,0 +1,10 @@
+#pragma once
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Public Functions
+ */
+// Microseconds since the start of the process
+int64_t esp_timer_get_time();
@@ -0,0 +1,27 @@
+#pragma once
+
+// Host shim of FreeRTOS for the host build of the drivers. Tasks are threads and the tick has 10 ms like on the board
+
+// C++ includes
+#include <cstdint>
+
+/*
+ *	Public typedefs
+ */
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+/*
+ *	Public defines
+ */
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+#define configTICK_RATE_HZ 100
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
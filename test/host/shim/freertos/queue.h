@@ -0,0 +1,24 @@
+#pragma once
+
+// Project includes
+#include "freertos/FreeRTOS.h"
+
+/*
+ *	Public typedefs
+ */
+typedef struct HostQueue* QueueHandle_t;
+
+/*
+ *	Public Functions
+ */
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+
+void vQueueDelete(QueueHandle_t queue);
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait);
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait);
+
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
@@ -0,0 +1,20 @@
+#pragma once
+
+// Project includes
+#include "freertos/queue.h"
+
+/*
+ *	Public typedefs
+ */
+typedef struct HostMutex* SemaphoreHandle_t;
+
+/*
+ *	Public Functions
+ */
+SemaphoreHandle_t xSemaphoreCreateMutex();
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
@@ -0,0 +1,33 @@
+#pragma once
+
+// Project includes
+#include "freertos/FreeRTOS.h"
+
+/*
+ *	Public typedefs
+ */
+typedef void (*TaskFunction_t)(void* param);
+
+typedef struct HostTask* TaskHandle_t;
+
+/*
+ *	Public Functions
+ */
+// The stack depth and the priority are ignored, every task is a thread of its own
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* param,
+                       UBaseType_t priority, TaskHandle_t* handle);
+
+// Ends the calling task if task is nullptr. Other tasks can't be stopped from outside, they keep running until the
+// process ends
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+
+TickType_t xTaskGetTickCount();
+
+// Threads that weren't created with xTaskCreate get a handle on their first call
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
@@ -0,0 +1,734 @@
+// Host side ECU emulator for the K-Line driver. It answers like the ECU on a pseudo-terminal or a serial device, so the
+// protocol handling can be exercised and benchmarked without the vehicle. test/host/KLineBench runs the driver of the
+// firmware against it.
+//
+// Build from the repository root:
+//	g++ -std=c++20 -O2 -Iinclude -o EcuEmulator tools/EcuEmulator/EcuEmulator.cpp src/Driver/KLineFrame.cpp
+// or with the host tests in test/host.
+//
+// Usage:
+//	EcuEmulator serve [options]          Emulates the ECU on a new pseudo-terminal (or --device) and prints its path
+//
+// Serve options:
+//	--device <path>          Serial device instead of a pseudo-terminal, e.g. a USB K-Line adapter wired to the board
+//	--baud <n>               Baud rate of the serial device (10400)
+//	--latency-ms <f>         Response time of the ECU (20)
+//	--jitter-ms <f>          Random additional response time (5)
+//	--p1-ms <f>              A longer gap between two bytes drops a partially received frame (20)
+//	--drop-rate <f>          Probability that a request isn't answered (0)
+//	--checksum-rate <f>      Probability that a response has a wrong checksum (0)
+//	--negative-rate <f>      Probability that a request is answered with "busy, repeat request" (0)
+//	--no-multi               Reject reads of multiple PIDs with one request
+//	--require-init           Only answer after a fast init. The session ends after 5 s without a request
+//	--no-init                Don't answer the fast init, like an ECU that doesn't know it
+//	--echo                   Echo every received byte, like the single wire K-Line does
+//	--ecu-id <4 chars>       Returned by the ECU ID read (EMUL)
+//	--dtcs <code,code,...>   Stored fault codes, e.g. P0130. Many of them are answered with multiple frames
+//	                         (P0130,P0171,P0420), "none" for no codes
+//	--wave <pid>=<type>[:<period s>|:<value>]
+//	                         Waveform of a PID: sine, ramp, square or const. Defaults to square for the switch
+//	                         bitfields and sine for everything else
+//	--seed <n>               Seed of the error injection
+
+// Project includes
+#include "Driver/EcuSensors.hpp"
+#include "Driver/KLineFrame.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX includes
+#include <asm/ioctls.h>
+#include <asm/termbits.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// <sys/ioctl.h> conflicts with the termios2 definitions
+extern "C" int ioctl(int fd, unsigned long request, ...);
+
+/*
+ *	constexpr
+ */
+constexpr uint8_t ADDR_ECU = 0x10;
+constexpr uint8_t ADDR_PCB = 0xF5;
+
+constexpr uint8_t SID_START_COMMUNICATION = 0x81;
+constexpr uint8_t SID_STOP_COMMUNICATION = 0x82;
+constexpr uint8_t SID_START_DIAGNOSTIC_SESSION = 0x10;
+constexpr uint8_t SID_TESTER_PRESENT = 0x3E;
+constexpr uint8_t SID_RDBI = 0x22;
+constexpr uint8_t SID_READ_MEMORY = 0x23;
+constexpr uint8_t SID_READ_DTC_BY_STATUS = 0x18;
+constexpr uint8_t SID_NEGATIVE_RESPONSE = 0x7F;
+constexpr uint8_t SID_RESPONSE_OFFSET = 0x40;
+
+constexpr uint8_t NRC_SERVICE_NOT_SUPPORTED = 0x11;
+constexpr uint8_t NRC_INVALID_FORMAT = 0x12;
+constexpr uint8_t NRC_BUSY_REPEAT_REQUEST = 0x21;
+constexpr uint8_t NRC_REQUEST_OUT_OF_RANGE = 0x31;
+
+// Key bytes of the start communication response
+constexpr uint8_t KEY_BYTE_1 = 0xEF;
+constexpr uint8_t KEY_BYTE_2 = 0x8F;
+
+// Without a request for this long the ECU ends the session (P3 max)
+constexpr int64_t SESSION_TIMEOUT_US = 5000000;
+
+// Between the frames of a multi-frame response
+constexpr int64_t FOLLOW_UP_FRAME_GAP_US = 5000;
+
+// Code (2 bytes) and status per fault code
+constexpr uint8_t DTC_LENGTH = 3;
+constexpr uint8_t DTC_STATUS_STORED = 0x20;
+
+/*
+ *	Private Struct
+ */
+typedef enum
+{
+	WAVE_SINE,
+	WAVE_RAMP,
+	WAVE_SQUARE,
+	WAVE_CONST
+} WAVE_TYPE;
+
+struct Waveform
+{
+	WAVE_TYPE type = WAVE_SINE;
+	double periodS = 4.0;
+	uint16_t value = 0;
+};
+
+struct ServeOptions
+{
+	std::string device;
+	uint32_t baudRate = 10400;
+
+	double latencyMs = 20.0;
+	double jitterMs = 5.0;
+	double p1Ms = 20.0;
+
+	double dropRate = 0.0;
+	double checksumRate = 0.0;
+	double negativeRate = 0.0;
+
+	bool multiPidReads = true;
+	bool requireInit = false;
+	bool answerInit = true;
+	bool echo = false;
+
+	std::string ecuId = "EMUL";
+	std::vector<uint16_t> dtcs = {0x0130, 0x0171, 0x0420};
+	std::map<uint16_t, Waveform> waves;
+
+	uint32_t seed = 1;
+};
+
+/*
+ *	Private Variables
+ */
+static volatile sig_atomic_t running = 1;
+
+/*
+ *	Private Functions
+ */
+static int64_t nowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void onSignal(int)
+{
+	running = 0;
+}
+
+// Raw 8N1 without any line discipline. termios2 also allows the non-standard 10400 baud
+static bool configureTty(const int fd, const uint32_t baudRate)
+{
+	termios2 tty = {};
+	if (ioctl(fd, TCGETS2, &tty) != 0) {
+		return false;
+	}
+
+	tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+	tty.c_oflag &= ~OPOST;
+	tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	tty.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CBAUD);
+	tty.c_cflag |= CS8 | CLOCAL | CREAD | BOTHER;
+	tty.c_ispeed = baudRate;
+	tty.c_ospeed = baudRate;
+	tty.c_cc[VMIN] = 0;
+	tty.c_cc[VTIME] = 0;
+
+	return ioctl(fd, TCSETS2, &tty) == 0;
+}
+
+static bool writeFrame(const int fd, const KLineFrame& frame, const bool corruptChecksum = false)
+{
+	uint8_t data[KLINE_MAX_FRAME_LENGTH];
+	const uint8_t length = frame.encode(data, sizeof(data));
+	if (length == 0) {
+		return false;
+	}
+
+	if (corruptChecksum) {
+		data[length - 1] ^= 0xFF;
+	}
+
+	return write(fd, data, length) == length;
+}
+
+static bool parseDouble(const char* text, double& value)
+{
+	char* end = nullptr;
+	value = strtod(text, &end);
+	return end != text && *end == '\0';
+}
+
+static bool parseUnsigned(const char* text, uint32_t& value)
+{
+	char* end = nullptr;
+	value = strtoul(text, &end, 0);
+	return end != text && *end == '\0';
+}
+
+/*
+ *	Emulated ECU
+ */
+class Ecu
+{
+public:
+	explicit Ecu(const ServeOptions& options) : options_(options), random_(options.seed) {}
+
+	// Handles the received bytes and answers complete requests
+	void receive(const int fd, const uint8_t* data, const size_t length)
+	{
+		const int64_t timestampUs = nowUs();
+
+		if (options_.echo) {
+			(void)!write(fd, data, length);
+		}
+
+		if (!assembler_.isEmpty() && timestampUs - lastByteUs_ > static_cast<int64_t>(options_.p1Ms * 1000.0)) {
+			assembler_.reset();
+			droppedFrames_++;
+		}
+		lastByteUs_ = timestampUs;
+
+		for (size_t i = 0; i < length; i++) {
+			// The wake up pattern of the fast init is received as a break
+			if (assembler_.isEmpty() && data[i] == 0x00) {
+				wakeUps_++;
+				continue;
+			}
+
+			KLineFrame request;
+			const auto result = assembler_.push(data[i], request);
+
+			// Own responses are received again on the single wire
+			if (result != KLineFrameAssembler::COMPLETE || request.target != ADDR_ECU || request.source == ADDR_ECU) {
+				continue;
+			}
+
+			handleRequest(fd, request, timestampUs);
+		}
+	}
+
+	void printStats() const
+	{
+		fprintf(stderr, "%lu requests, %lu responses, %lu ignored, %lu dropped, %lu corrupted, %lu negative, "
+		        "%lu invalid & %lu cut off frames, %lu wake ups\n",
+		        requests_, responses_, ignored_, injectedDrops_, injectedChecksumErrors_, negativeResponses_,
+		        static_cast<unsigned long>(assembler_.getInvalidFrames()), droppedFrames_, wakeUps_);
+	}
+
+private:
+	void handleRequest(const int fd, const KLineFrame& request, const int64_t timestampUs)
+	{
+		requests_++;
+
+		const uint8_t sid = request.payload[0];
+
+		// Without a session only the start communication is answered
+		if (sessionActive_ && timestampUs - lastRequestUs_ > SESSION_TIMEOUT_US) {
+			sessionActive_ = false;
+		}
+		if (options_.requireInit && !sessionActive_ && sid != SID_START_COMMUNICATION) {
+			ignored_++;
+			return;
+		}
+		if (!options_.answerInit && sid == SID_START_COMMUNICATION) {
+			ignored_++;
+			return;
+		}
+		lastRequestUs_ = timestampUs;
+
+		KLineFrame response;
+		response.target = ADDR_PCB;
+		response.source = ADDR_ECU;
+
+		if (chance(options_.dropRate)) {
+			injectedDrops_++;
+			return;
+		}
+
+		if (chance(options_.negativeRate)) {
+			setNegativeResponse(response, sid, NRC_BUSY_REPEAT_REQUEST);
+		}
+		else {
+			buildResponse(request, response);
+		}
+
+		// Response time of the ECU
+		const double jitterMs = std::uniform_real_distribution<double>(0.0, options_.jitterMs)(random_);
+		std::this_thread::sleep_for(std::chrono::microseconds(
+			static_cast<int64_t>((options_.latencyMs + jitterMs) * 1000.0)));
+
+		const bool corrupt = chance(options_.checksumRate);
+		if (corrupt) {
+			injectedChecksumErrors_++;
+		}
+
+		if (writeFrame(fd, response, corrupt)) {
+			responses_++;
+		}
+
+		for (const KLineFrame& frame : followUpFrames_) {
+			std::this_thread::sleep_for(std::chrono::microseconds(FOLLOW_UP_FRAME_GAP_US));
+			writeFrame(fd, frame);
+		}
+		followUpFrames_.clear();
+	}
+
+	void buildResponse(const KLineFrame& request, KLineFrame& response)
+	{
+		const uint8_t sid = request.payload[0];
+		response.payload[0] = sid + SID_RESPONSE_OFFSET;
+		response.payloadLength = 1;
+
+		switch (sid) {
+			case SID_START_COMMUNICATION:
+				sessionActive_ = true;
+				response.payload[1] = KEY_BYTE_1;
+				response.payload[2] = KEY_BYTE_2;
+				response.payloadLength = 3;
+				break;
+
+			case SID_STOP_COMMUNICATION:
+				sessionActive_ = false;
+				break;
+
+			case SID_START_DIAGNOSTIC_SESSION:
+				response.payload[1] = request.payloadLength >= 2 ? request.payload[1] : 0x81;
+				response.payloadLength = 2;
+				break;
+
+			case SID_TESTER_PRESENT:
+				break;
+
+			// SID, address and the 4 chars of the ECU ID
+			case SID_READ_MEMORY:
+				if (request.payloadLength < 4) {
+					setNegativeResponse(response, sid, NRC_INVALID_FORMAT);
+					break;
+				}
+				response.payload[1] = request.payload[2];
+				response.payload[2] = request.payload[3];
+				for (uint8_t i = 0; i < 4; i++) {
+					response.payload[3 + i] = i < options_.ecuId.size() ? options_.ecuId[i] : ' ';
+				}
+				response.payloadLength = 7;
+				break;
+
+			case SID_RDBI:
+				readPids(request, response);
+				break;
+
+			case SID_READ_DTC_BY_STATUS:
+				readDtcs(response);
+				break;
+
+			default:
+				setNegativeResponse(response, sid, NRC_SERVICE_NOT_SUPPORTED);
+				break;
+		}
+	}
+
+	// Every PID is answered with the PID followed by its value, in request order
+	void readPids(const KLineFrame& request, KLineFrame& response)
+	{
+		const uint8_t count = (request.payloadLength - 1) / 2;
+		if (count == 0 || request.payloadLength != 1 + count * 2 || (count > 1 && !options_.multiPidReads)) {
+			setNegativeResponse(response, SID_RDBI, NRC_INVALID_FORMAT);
+			return;
+		}
+
+		for (uint8_t i = 0; i < count; i++) {
+			const uint16_t pid = (request.payload[1 + i * 2] << 8) + request.payload[2 + i * 2];
+			const uint8_t length = getEcuAddressLength(pid);
+			if (length == 0) {
+				setNegativeResponse(response, SID_RDBI, NRC_REQUEST_OUT_OF_RANGE);
+				return;
+			}
+
+			if (response.payloadLength + 2 + length > KLINE_MAX_PAYLOAD_LENGTH) {
+				setNegativeResponse(response, SID_RDBI, NRC_INVALID_FORMAT);
+				return;
+			}
+
+			const uint16_t value = sample(pid, length);
+			uint8_t* data = &response.payload[response.payloadLength];
+			data[0] = pid >> 8;
+			data[1] = pid & 0xFF;
+			if (length == 1) {
+				data[2] = value & 0xFF;
+			}
+			else {
+				data[2] = value >> 8;
+				data[3] = value & 0xFF;
+			}
+			response.payloadLength += 2 + length;
+		}
+	}
+
+	// The number of codes, then code and status of each. Codes that don't fit follow in more frames, each starting with
+	// the SID again
+	void readDtcs(KLineFrame& response)
+	{
+		response.payload[1] = static_cast<uint8_t>(options_.dtcs.size());
+		response.payloadLength = 2;
+
+		KLineFrame* frame = &response;
+		for (const uint16_t code : options_.dtcs) {
+			if (frame->payloadLength + DTC_LENGTH > KLINE_MAX_PAYLOAD_LENGTH) {
+				KLineFrame& followUp = followUpFrames_.emplace_back(response);
+				followUp.payloadLength = 1;
+				frame = &followUp;
+			}
+
+			uint8_t* data = &frame->payload[frame->payloadLength];
+			data[0] = code >> 8;
+			data[1] = code & 0xFF;
+			data[2] = DTC_STATUS_STORED;
+			frame->payloadLength += DTC_LENGTH;
+		}
+	}
+
+	uint16_t sample(const uint16_t pid, const uint8_t length) const
+	{
+		const double max = length == 1 ? 0xFF : 0xFFFF;
+
+		Waveform wave;
+		if (options_.waves.contains(pid)) {
+			wave = options_.waves.at(pid);
+		}
+		else if (pid == ADDR_SWITCHES_1701 || pid == ADDR_SWITCHES_1702 || pid == ADDR_SWITCHES_1711 ||
+		         pid == ADDR_SWITCHES_1718) {
+			wave.type = WAVE_SQUARE;
+			wave.periodS = 2.0;
+		}
+		else {
+			// Different periods, so the values don't move in lockstep
+			wave.periodS = 2.0 + pid % 8;
+		}
+
+		const double phase = std::fmod(static_cast<double>(nowUs()) / 1000000.0, wave.periodS) / wave.periodS;
+		switch (wave.type) {
+			case WAVE_RAMP:
+				return static_cast<uint16_t>(phase * max);
+			case WAVE_SQUARE:
+				return phase < 0.5 ? 0 : static_cast<uint16_t>(max);
+			case WAVE_CONST:
+				return wave.value;
+			case WAVE_SINE:
+			default:
+				return static_cast<uint16_t>((std::sin(phase * 2.0 * M_PI) + 1.0) / 2.0 * max);
+		}
+	}
+
+	void setNegativeResponse(KLineFrame& response, const uint8_t sid, const uint8_t code)
+	{
+		response.payload[0] = SID_NEGATIVE_RESPONSE;
+		response.payload[1] = sid;
+		response.payload[2] = code;
+		response.payloadLength = 3;
+		negativeResponses_++;
+	}
+
+	bool chance(const double probability)
+	{
+		return probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(random_) < probability;
+	}
+
+	const ServeOptions& options_;
+
+	std::mt19937 random_;
+
+	KLineFrameAssembler assembler_;
+	int64_t lastByteUs_ = 0;
+
+	// Remaining frames of a multi-frame response
+	std::vector<KLineFrame> followUpFrames_;
+
+	bool sessionActive_ = false;
+	int64_t lastRequestUs_ = 0;
+
+	unsigned long requests_ = 0;
+	unsigned long responses_ = 0;
+	unsigned long ignored_ = 0;
+	unsigned long injectedDrops_ = 0;
+	unsigned long injectedChecksumErrors_ = 0;
+	unsigned long negativeResponses_ = 0;
+	unsigned long droppedFrames_ = 0;
+	unsigned long wakeUps_ = 0;
+};
+
+static int serve(const ServeOptions& options)
+{
+	int fd = -1;
+	int slaveFd = -1;
+
+	if (!options.device.empty()) {
+		fd = open(options.device.c_str(), O_RDWR | O_NOCTTY);
+		if (fd < 0 || !configureTty(fd, options.baudRate)) {
+			perror(options.device.c_str());
+			return EXIT_FAILURE;
+		}
+		fprintf(stderr, "Emulating the ECU on %s\n", options.device.c_str());
+	}
+	else {
+		fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+			perror("posix_openpt");
+			return EXIT_FAILURE;
+		}
+
+		// Keeping the slave open avoids errors while no client is connected, it also sets the raw mode for clients
+		slaveFd = open(ptsname(fd), O_RDWR | O_NOCTTY);
+		if (slaveFd < 0 || !configureTty(slaveFd, options.baudRate)) {
+			perror(ptsname(fd));
+			return EXIT_FAILURE;
+		}
+		printf("%s\n", ptsname(fd));
+		fflush(stdout);
+	}
+
+	Ecu ecu(options);
+	uint8_t buffer[64];
+
+	while (running) {
+		pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+		if (poll(&pfd, 1, 100) <= 0) {
+			continue;
+		}
+
+		const ssize_t bytesRead = read(fd, buffer, sizeof(buffer));
+		if (bytesRead > 0) {
+			ecu.receive(fd, buffer, bytesRead);
+		}
+	}
+
+	ecu.printStats();
+
+	if (slaveFd >= 0) {
+		close(slaveFd);
+	}
+	close(fd);
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ *	Argument Parsing
+ */
+static bool parseWave(const char* text, ServeOptions& options)
+{
+	const std::string arg(text);
+	const size_t equals = arg.find('=');
+	uint32_t pid = 0;
+	if (equals == std::string::npos || !parseUnsigned(arg.substr(0, equals).c_str(), pid)) {
+		return false;
+	}
+
+	std::string type = arg.substr(equals + 1);
+	std::string parameter;
+	const size_t colon = type.find(':');
+	if (colon != std::string::npos) {
+		parameter = type.substr(colon + 1);
+		type = type.substr(0, colon);
+	}
+
+	Waveform wave;
+	if (type == "sine") {
+		wave.type = WAVE_SINE;
+	}
+	else if (type == "ramp") {
+		wave.type = WAVE_RAMP;
+	}
+	else if (type == "square") {
+		wave.type = WAVE_SQUARE;
+	}
+	else if (type == "const") {
+		wave.type = WAVE_CONST;
+	}
+	else {
+		return false;
+	}
+
+	if (!parameter.empty()) {
+		double value = 0.0;
+		if (!parseDouble(parameter.c_str(), value) || value <= 0.0) {
+			return false;
+		}
+
+		if (wave.type == WAVE_CONST) {
+			wave.value = static_cast<uint16_t>(value);
+		}
+		else {
+			wave.periodS = value;
+		}
+	}
+
+	options.waves[pid] = wave;
+	return true;
+}
+
+// Codes like P0130, the letter selects the upper 2 bits
+static bool parseDtcs(const char* text, ServeOptions& options)
+{
+	constexpr char SYSTEMS[] = "PCBU";
+
+	options.dtcs.clear();
+	const std::string list(text);
+	if (list == "none") {
+		return true;
+	}
+
+	size_t start = 0;
+	while (start <= list.size()) {
+		const size_t end = std::min(list.find(',', start), list.size());
+		const std::string code = list.substr(start, end - start);
+		const char* system = code.empty() ? nullptr : strchr(SYSTEMS, code[0]);
+
+		uint32_t number = 0;
+		if (system == nullptr || *system == '\0' || code.size() != 5 ||
+		    !parseUnsigned(("0x" + code.substr(1)).c_str(), number) || number > 0x3FFF) {
+			return false;
+		}
+
+		options.dtcs.push_back(static_cast<uint16_t>(((system - SYSTEMS) << 14) | number));
+		start = end + 1;
+	}
+
+	return true;
+}
+
+static bool parseServeOptions(const int argc, char** argv, ServeOptions& options)
+{
+	for (int i = 2; i < argc; i++) {
+		const std::string arg(argv[i]);
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (arg == "--no-multi") {
+			options.multiPidReads = false;
+			continue;
+		}
+		if (arg == "--require-init") {
+			options.requireInit = true;
+			continue;
+		}
+		if (arg == "--no-init") {
+			options.answerInit = false;
+			continue;
+		}
+		if (arg == "--echo") {
+			options.echo = true;
+			continue;
+		}
+
+		// Everything else has a value
+		if (value == nullptr) {
+			return false;
+		}
+		i++;
+
+		bool valid = true;
+		if (arg == "--device") {
+			options.device = value;
+		}
+		else if (arg == "--baud") {
+			valid = parseUnsigned(value, options.baudRate);
+		}
+		else if (arg == "--latency-ms") {
+			valid = parseDouble(value, options.latencyMs);
+		}
+		else if (arg == "--jitter-ms") {
+			valid = parseDouble(value, options.jitterMs);
+		}
+		else if (arg == "--p1-ms") {
+			valid = parseDouble(value, options.p1Ms);
+		}
+		else if (arg == "--drop-rate") {
+			valid = parseDouble(value, options.dropRate);
+		}
+		else if (arg == "--checksum-rate") {
+			valid = parseDouble(value, options.checksumRate);
+		}
+		else if (arg == "--negative-rate") {
+			valid = parseDouble(value, options.negativeRate);
+		}
+		else if (arg == "--ecu-id") {
+			options.ecuId = value;
+		}
+		else if (arg == "--wave") {
+			valid = parseWave(value, options);
+		}
+		else if (arg == "--dtcs") {
+			valid = parseDtcs(value, options);
+		}
+		else if (arg == "--seed") {
+			valid = parseUnsigned(value, options.seed);
+		}
+		else {
+			valid = false;
+		}
+
+		if (!valid) {
+			fprintf(stderr, "Invalid option %s %s\n", arg.c_str(), value);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(const int argc, char** argv)
+{
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	const std::string mode = argc >= 2 ? argv[1] : "";
+
+	if (mode == "serve") {
+		ServeOptions options;
+		if (parseServeOptions(argc, argv, options)) {
+			return serve(options);
+		}
+	}
+
+	fprintf(stderr, "Usage: %s serve [options], see the head of EcuEmulator.cpp\n", argv[0]);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+Packs the web interface into the archive flashed to the webassets partition, see include/WebInterface/AssetArchive.hpp.
+
+Every file is stored gzip compressed, unless that doesn't make it smaller, together with an ETag hashed from the
+stored content. Local references of the HTML files get the ETag of their target appended as "?v=<etag>", so the
+browser may cache the versioned URLs forever and only revalidates the pages.
+
+Usage: pack_web_assets.py <web dir> <archive> [partition size]
+"""
+
+import gzip
+import hashlib
+import re
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = 0x31534157  # "WAS1"
+HEADER = struct.Struct("<IIII")
+ENTRY = struct.Struct("<IHHII16s")
+
+FLAG_GZIP = 0x0001
+
+# Characters of the SHA-256 used as the ETag
+ETAG_LENGTH = 16
+
+# The contents are aligned for the reads from the mapped flash
+ALIGNMENT = 4
+
+REFERENCE = re.compile(r'(src|href)="([^"?#:]+)"')
+
+
+def compress(content: bytes) -> bytes:
+    # mtime 0 keeps the output and so the ETag reproducible
+    return gzip.compress(content, compresslevel=9, mtime=0)
+
+
+def align(data: bytearray) -> None:
+    data.extend(b"\0" * (-len(data) % ALIGNMENT))
+
+
+def version_references(html: str, page: Path, etags: dict) -> str:
+    def replace(match):
+        target = (page.parent / match.group(2)).as_posix()
+        if target not in etags:
+            return match.group(0)
+
+        return f'{match.group(1)}="{match.group(2)}?v={etags[target]}"'
+
+    return REFERENCE.sub(replace, html)
+
+
+def main() -> int:
+    if len(sys.argv) not in (3, 4):
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        return 1
+
+    web_dir = Path(sys.argv[1])
+    archive_path = Path(sys.argv[2])
+    max_size = int(sys.argv[3], 0) if len(sys.argv) == 4 else None
+
+    sources = sorted(path.relative_to(web_dir) for path in web_dir.rglob("*") if path.is_file())
+
+    # Pages last, so the ETags of the assets they reference are known
+    sources.sort(key=lambda path: path.suffix == ".html")
+
+    etags = {}
+    assets = []
+    raw_size = 0
+
+    for relative in sources:
+        content = (web_dir / relative).read_bytes()
+        if relative.suffix == ".html":
+            content = version_references(content.decode("utf-8"), relative, etags).encode("utf-8")
+
+        compressed = compress(content)
+        gzipped = len(compressed) < len(content)
+        stored = compressed if gzipped else content
+
+        etag = hashlib.sha256(stored).hexdigest()[:ETAG_LENGTH]
+        etags[relative.as_posix()] = etag
+        assets.append((relative.as_posix().encode("utf-8"), FLAG_GZIP if gzipped else 0, etag, stored))
+
+        raw_size += len(content)
+
+    # The firmware looks the paths up with a binary search over the raw bytes
+    assets.sort(key=lambda asset: asset[0])
+
+    names = bytearray()
+    names_offset = HEADER.size + ENTRY.size * len(assets)
+    for name, _, _, _ in assets:
+        names.extend(name)
+    align(names)
+
+    data = bytearray()
+    data_offset = names_offset + len(names)
+    index = bytearray()
+    name_offset = names_offset
+    for name, flags, etag, stored in assets:
+        index.extend(ENTRY.pack(name_offset, len(name), flags, data_offset + len(data), len(stored), etag.encode()))
+        name_offset += len(name)
+
+        data.extend(stored)
+        align(data)
+
+    archive = HEADER.pack(MAGIC, len(assets), names_offset, data_offset) + index + names + data
+    if max_size is not None and len(archive) > max_size:
+        print(f"Web assets need {len(archive)} bytes, the partition only has {max_size}", file=sys.stderr)
+        return 1
+
+    archive_path.parent.mkdir(parents=True, exist_ok=True)
+    archive_path.write_bytes(archive)
+
+    print(f"Packed {len(assets)} web assets: {raw_size} -> {len(archive)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())